@@ -0,0 +1,87 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "yasl.h"
+
+/*
+ * Counts the calls to malloc made while running a few allocation-heavy scripts, along with the time each one takes.
+ * Built with the linker wrapping malloc, calloc, realloc and free, so that every allocation made by the interpreter
+ * goes through the counters below. Prints, for each script, the number of allocations and frees and the run time in
+ * milliseconds.
+ */
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t num, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void __real_free(void *ptr);
+
+static size_t allocs = 0;
+static size_t frees = 0;
+
+void *__wrap_malloc(size_t size) {
+	allocs++;
+	return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t num, size_t size) {
+	allocs++;
+	return __real_calloc(num, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+	if (!ptr) allocs++;
+	return __real_realloc(ptr, size);
+}
+
+void __wrap_free(void *ptr) {
+	if (ptr) frees++;
+	__real_free(ptr);
+}
+
+static const char *const scripts[][2] = {
+	{ "strings",
+	  "s := ''\n"
+	  "for i := 0; i < 20000; i += 1 {\n"
+	  "    s = 'item' ~ i->tostr() ~ ','\n"
+	  "    t := s->toupper()->replace('ITEM', 'x')\n"
+	  "}\n" },
+	{ "substrings",
+	  "s := 'the quick brown fox jumps over the lazy dog'\n"
+	  "for i := 0; i < 2000; i += 1 {\n"
+	  "    for c <- s { d := c ~ c; }\n"
+	  "}\n" },
+	{ "lists",
+	  "for i := 0; i < 20000; i += 1 {\n"
+	  "    ls := [i, i + 1, 'a' ~ i->tostr()]\n"
+	  "}\n" },
+	{ "tables",
+	  "for i := 0; i < 20000; i += 1 {\n"
+	  "    t := {'k': i, i->tostr(): 'v'}\n"
+	  "}\n" },
+};
+
+int main(void) {
+	printf("script\tallocs\tfrees\tms\n");
+	for (size_t i = 0; i < sizeof(scripts) / sizeof(scripts[0]); i++) {
+		const char *const source = scripts[i][1];
+		char *buffer = malloc(strlen(source) + 1);
+		strcpy(buffer, source);
+		struct YASL_State *S = YASL_newstate_bb(buffer, (int) strlen(buffer));
+
+		const size_t allocs_before = allocs;
+		const size_t frees_before = frees;
+		clock_t start = clock();
+		int status = YASL_execute(S);
+		double ms = (double) (clock() - start) * 1e3 / CLOCKS_PER_SEC;
+		printf("%s\t%zu\t%zu\t%.1f\n", scripts[i][0], allocs - allocs_before, frees - frees_before, ms);
+		if (status) {
+			fprintf(stderr, "%s exited with status %d\n", scripts[i][0], status);
+		}
+
+		YASL_delstate(S);
+		free(buffer);
+	}
+	return 0;
+}
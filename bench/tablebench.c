@@ -0,0 +1,110 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "hashtable/hashtable.h"
+#include "interpreter/YASL_string.h"
+
+/*
+ * Microbenchmark for the table engine. Built once per engine (tablebench_swiss and tablebench_prime), so that both can
+ * be run on the same machine and compared. Prints the average time per operation, in nanoseconds, for tables of 1e3
+ * to 1e7 entries. An optional argument lowers the largest size.
+ */
+
+#if YASL_SWISS_TABLE
+#define ENGINE "swiss"
+#else
+#define ENGINE "prime"
+#endif
+
+static double elapsed_ns(clock_t start, size_t ops) {
+	return (double) (clock() - start) * 1e9 / CLOCKS_PER_SEC / ops;
+}
+
+static String_t *make_key(size_t i) {
+	char buffer[32];
+	int len = sprintf(buffer, "key%zu", i);
+	return str_new_sized_heap(0, len, copy_char_buffer(len, buffer));
+}
+
+static void bench_ints(size_t n) {
+	struct Table *table = table_new();
+	clock_t start = clock();
+	for (size_t i = 0; i < n; i++) {
+		table_insert(table, YASL_INT((yasl_int) (i * 7919)), YASL_INT((yasl_int) i));
+	}
+	printf("%s\t%zu\tint\tinsert\t%.1f\n", ENGINE, n, elapsed_ns(start, n));
+
+	start = clock();
+	yasl_int sum = 0;
+	for (size_t i = 0; i < n; i++) {
+		sum += YASL_GETINT(table_search(table, YASL_INT((yasl_int) (i * 7919))));
+	}
+	printf("%s\t%zu\tint\thit\t%.1f\n", ENGINE, n, elapsed_ns(start, n));
+
+	start = clock();
+	for (size_t i = 0; i < n; i++) {
+		sum += YASL_GETTYPE(table_search(table, YASL_INT((yasl_int) (i * 7919 + 1))));
+	}
+	printf("%s\t%zu\tint\tmiss\t%.1f\n", ENGINE, n, elapsed_ns(start, n));
+
+	start = clock();
+	for (size_t i = 0; i < n; i++) {
+		table_rm(table, YASL_INT((yasl_int) (i * 7919)));
+	}
+	printf("%s\t%zu\tint\tremove\t%.1f\n", ENGINE, n, elapsed_ns(start, n));
+
+	if (sum == 42) puts("");    // keeps the searches from being optimized away.
+	table_del(table);
+}
+
+static void bench_strings(size_t n) {
+	String_t **keys = malloc(n * sizeof(String_t *));
+	String_t **lookups = malloc(n * sizeof(String_t *));
+	for (size_t i = 0; i < n; i++) {
+		keys[i] = make_key(i);
+		lookups[i] = make_key(i);    // a different object with the same contents, as with keys built at runtime.
+	}
+
+	struct Table *table = table_new();
+	clock_t start = clock();
+	for (size_t i = 0; i < n; i++) {
+		table_insert(table, YASL_STR(keys[i]), YASL_INT((yasl_int) i));
+	}
+	printf("%s\t%zu\tstr\tinsert\t%.1f\n", ENGINE, n, elapsed_ns(start, n));
+
+	start = clock();
+	yasl_int sum = 0;
+	for (size_t i = 0; i < n; i++) {
+		sum += YASL_GETINT(table_search(table, YASL_STR(lookups[i])));
+	}
+	printf("%s\t%zu\tstr\thit\t%.1f\n", ENGINE, n, elapsed_ns(start, n));
+
+	for (size_t i = 0; i < n; i++) {
+		str_del(lookups[i]);
+		lookups[i] = make_key(i + n);
+	}
+	start = clock();
+	for (size_t i = 0; i < n; i++) {
+		sum += YASL_GETTYPE(table_search(table, YASL_STR(lookups[i])));
+	}
+	printf("%s\t%zu\tstr\tmiss\t%.1f\n", ENGINE, n, elapsed_ns(start, n));
+
+	if (sum == 42) puts("");
+	for (size_t i = 0; i < n; i++) {
+		str_del(lookups[i]);
+	}
+	table_del(table);
+	free(keys);
+	free(lookups);
+}
+
+int main(int argc, char **argv) {
+	size_t max = argc > 1 ? (size_t) strtoll(argv[1], NULL, 10) : 10000000;
+	printf("engine\tentries\tkeys\top\tns/op\n");
+	for (size_t n = 1000; n <= max; n *= 10) {
+		bench_ints(n);
+		bench_strings(n);
+	}
+	return 0;
+}
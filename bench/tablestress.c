@@ -0,0 +1,66 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "hashtable/hashtable.h"
+
+/*
+ * Delete-heavy stress benchmark for the table engine. Keys move through a sliding window: every step inserts a new
+ * key, removes the oldest one and searches the window. The average search time of each epoch is printed, and should
+ * stay flat as long as removed items don't pile up in the table. Built once per engine, like tablebench.
+ */
+
+#if YASL_SWISS_TABLE
+#define ENGINE "swiss"
+#define TOMBSTONES(table) 0
+#else
+#define ENGINE "prime"
+#define TOMBSTONES(table) ((table)->tombstones)
+#endif
+
+#define SEARCHES_PER_STEP 4
+#define EPOCHS 20
+
+static size_t next_random(size_t *state) {
+	*state = *state * 6364136223846793005ULL + 1442695040888963407ULL;
+	return *state >> 33;
+}
+
+int main(int argc, char **argv) {
+	const size_t window = argc > 1 ? (size_t) strtoll(argv[1], NULL, 10) : 100000;
+	const size_t steps = window;    // steps per epoch
+	size_t state = 42;
+	struct Table *table = table_new();
+
+	for (size_t i = 0; i < window; i++) {
+		table_insert(table, YASL_INT((yasl_int) i), YASL_INT((yasl_int) i));
+	}
+
+	printf("engine\tepoch\tentries\tsize\ttombstones\tsearch ns/op\n");
+	size_t next = window;
+	yasl_int found = 0;
+	for (int epoch = 0; epoch < EPOCHS; epoch++) {
+		clock_t searching = 0;
+		for (size_t step = 0; step < steps; step++, next++) {
+			table_insert(table, YASL_INT((yasl_int) next), YASL_INT((yasl_int) next));
+			table_rm(table, YASL_INT((yasl_int) (next - window)));
+
+			clock_t start = clock();
+			for (int i = 0; i < SEARCHES_PER_STEP; i++) {
+				const yasl_int key = (yasl_int) (next - next_random(&state) % window);
+				found += YASL_GETTYPE(table_search(table, YASL_INT(key))) == Y_INT;
+			}
+			found += YASL_GETTYPE(table_search(table, YASL_INT((yasl_int) (next - window)))) == Y_INT;    // just removed
+			searching += clock() - start;
+		}
+		printf("%s\t%d\t%zu\t%zu\t%zu\t%.1f\n", ENGINE, epoch, table->count, table->size, (size_t) TOMBSTONES(table),
+		       (double) searching * 1e9 / CLOCKS_PER_SEC / (steps * (SEARCHES_PER_STEP + 1)));
+	}
+
+	if (found != (yasl_int) (EPOCHS * steps * SEARCHES_PER_STEP)) {
+		printf("wrong number of hits: %" PRId64 "\n", found);
+		return 1;
+	}
+	table_del(table);
+	return 0;
+}
@@ -39,6 +39,28 @@ void bb_intbytes8(ByteBuffer *const bb, const yasl_int value) {
 	bb->count += sizeof(yasl_int);
 }
 
+/*
+ * Adds value as a signed integer of width bytes (1, 2, 4 or 8), in native endianness. value has to fit in that width.
+ */
+void bb_intbytes(ByteBuffer *const bb, const yasl_int value, const size_t width) {
+	int8_t i8 = (int8_t) value;
+	int16_t i16 = (int16_t) value;
+	int32_t i32 = (int32_t) value;
+	switch (width) {
+	case 1:
+		bb_append(bb, (unsigned char *) &i8, 1);
+		break;
+	case 2:
+		bb_append(bb, (unsigned char *) &i16, 2);
+		break;
+	case 4:
+		bb_append(bb, (unsigned char *) &i32, 4);
+		break;
+	default:
+		bb_intbytes8(bb, value);
+		break;
+	}
+}
 
 void bb_rewrite_intbytes8(ByteBuffer *const bb, const size_t index, const yasl_int value) {
 	if (bb->size < index + sizeof(yasl_int)) {
@@ -19,4 +19,5 @@ void bb_add_byte(ByteBuffer *const bb, const unsigned char byte);
 void bb_append(ByteBuffer *const bb, const unsigned char *const bytes, const size_t bytes_len);
 void bb_floatbytes8(ByteBuffer *const bb, const yasl_float value);
 void bb_intbytes8(ByteBuffer *const bb, const yasl_int value);
+void bb_intbytes(ByteBuffer *const bb, const yasl_int value, const size_t width);
 void bb_rewrite_intbytes8(ByteBuffer *const bb, const size_t index, const yasl_int value);
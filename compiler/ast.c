@@ -21,6 +21,11 @@ struct Node *node_clone(const struct Node *const node) {
 	case N_FLOAT: clone->value.ival = node->value.ival;
 		break;
 	default: clone->value.sval.str_len = node->value.sval.str_len;
+		// operators have no name, and folding them into literals relies on that.
+		if (node->value.sval.str == NULL) {
+			clone->value.sval.str = NULL;
+			break;
+		}
 		clone->value.sval.str = malloc(node->value.sval.str_len);
 		memcpy(clone->value.sval.str, node->value.sval.str, clone->value.sval.str_len);
 	}
@@ -0,0 +1,241 @@
+#include "bytecode.h"
+
+/*
+ * Returns the smallest number of bytes (1, 2, 4 or 8) that value fits in as a signed integer.
+ */
+size_t int_width(const yasl_int value) {
+	if (value >= INT8_MIN && value <= INT8_MAX) return 1;
+	if (value >= INT16_MIN && value <= INT16_MAX) return 2;
+	if (value >= INT32_MIN && value <= INT32_MAX) return 4;
+	return 8;
+}
+
+/*
+ * Returns the length in bytes of the instruction starting at code, operands and inline caches included.
+ */
+size_t instruction_length(const unsigned char *const code) {
+	switch ((enum Opcode) code[0]) {
+	case ICONST_B1:
+	case NEWSPECIALSTR:
+	case NEWSTR_1:
+	case BR_1:
+	case BRF_1:
+	case BRT_1:
+	case BRN_1:
+	case GSTORE_1:
+	case LSTORE_1:
+	case GLOAD_1:
+	case LLOAD_1:
+		return 2;
+	case ICONST_B2:
+	case NEWSTR_2:
+	case BR_2:
+	case BRF_2:
+	case BRT_2:
+	case BRN_2:
+	case R_MOV:
+	case R_MOVI:
+	case GSTORE_2:
+	case LSTORE_2:
+	case GLOAD_2:
+	case LLOAD_2:
+	case INCR_GLOBAL:
+	case INCR_LOCAL:
+	case DECR_GLOBAL:
+	case DECR_LOCAL:
+	case ADD_GLOBALS:
+	case ADD_LOCALS:
+		return 3;
+	case R_ADD:
+	case R_SUB:
+	case R_MUL:
+	case R_ADDI:
+	case R_SUBI:
+		return 4;
+	case ICONST_B4:
+	case BR_4:
+	case BRF_4:
+	case BRT_4:
+	case BRN_4:
+		return 5;
+	case ICONST:
+	case DCONST:
+	case FCONST:
+	case NEWSTR:
+	case NEWLIST_N:
+	case NEWTABLE_N:
+	case BR_8:
+	case BRF_8:
+	case BRT_8:
+	case BRN_8:
+	case LT_BRF:
+	case LE_BRF:
+	case GT_BRF:
+	case GE_BRF:
+		return 1 + sizeof(yasl_int);
+	case R_BRGE:
+	case R_BRGT:
+	case R_BRGEI:
+	case R_BRGTI:
+		return 3 + sizeof(yasl_int);
+	case INIT_MC_SPECIAL:
+		return 2 + MC_CACHE_SIZE;
+	case INIT_MC:
+		return 1 + sizeof(yasl_int) + MC_CACHE_SIZE;
+	default:
+		return 1;
+	}
+}
+
+enum BranchKind branch_kind(const unsigned char opcode) {
+	switch (opcode) {
+	case BR_8:
+	case BRF_8:
+	case BRT_8:
+	case BRN_8:
+		return BRANCH_STACK;
+	case R_BRGE:
+	case R_BRGT:
+	case R_BRGEI:
+	case R_BRGTI:
+	case LT_BRF:
+	case LE_BRF:
+	case GT_BRF:
+	case GE_BRF:
+		return BRANCH_LONG;
+	default:
+		return BRANCH_NONE;
+	}
+}
+
+// the form of BR_8, BRF_8, BRT_8 or BRN_8 with a jump length of width bytes.
+static unsigned char short_branch(const unsigned char opcode, const size_t width) {
+	switch (width) {
+	case 1:
+		return BR_1 + (opcode - BR_8);
+	case 2:
+		return BR_2 + (opcode - BR_8);
+	case 4:
+		return BR_4 + (opcode - BR_8);
+	default:
+		return opcode;
+	}
+}
+
+static size_t find_instruction(const struct Instruction *const instrs, const size_t count, const unsigned char *at) {
+	size_t lo = 0, hi = count;
+	while (lo < hi) {
+		const size_t mid = lo + (hi - lo) / 2;
+		if (instrs[mid].bytes < at) lo = mid + 1;
+		else hi = mid;
+	}
+	return lo;
+}
+
+/*
+ * Decodes the instructions in buffer from start on, which have to be in the form the compiler emits them in, with
+ * 8 byte branches. Jumps must stay inside buffer from start on, and land on the start of an instruction or on the end
+ * of buffer. Returns 0 if any don't, and the code can't be decoded.
+ */
+int code_decode(struct Code *const code, const ByteBuffer *const buffer, const size_t start) {
+	size_t count = 0;
+	for (size_t i = start; i < buffer->count; i += instruction_length(buffer->bytes + i)) count++;
+
+	// the end of the code is an extra, empty instruction, so that jumps to it are handled like any others.
+	struct Instruction *instrs = malloc(sizeof(struct Instruction) * (count + 1));
+	size_t k = 0;
+	for (size_t i = start; i < buffer->count; i += instrs[k++].length) {
+		instrs[k].bytes = buffer->bytes + i;
+		instrs[k].opcode = buffer->bytes[i];
+		instrs[k].branch = branch_kind(buffer->bytes[i]);
+		instrs[k].length = instruction_length(buffer->bytes + i);
+	}
+	instrs[count].bytes = buffer->bytes + buffer->count;
+	instrs[count].opcode = HALT;
+	instrs[count].branch = BRANCH_NONE;
+	instrs[count].length = 0;
+
+	for (k = 0; k < count; k++) {
+		if (instrs[k].branch == BRANCH_NONE) continue;
+		yasl_int offset;
+		memcpy(&offset, instrs[k].bytes + instrs[k].length - sizeof(yasl_int), sizeof(yasl_int));
+		const unsigned char *const target = instrs[k].bytes + instrs[k].length + offset;
+		const size_t t = target < buffer->bytes + start ? count + 1 : find_instruction(instrs, count + 1, target);
+		if (t > count || instrs[t].bytes != target) {
+			free(instrs);
+			return 0;
+		}
+		instrs[k].target = t;
+	}
+
+	code->instrs = instrs;
+	code->count = count;
+	return 1;
+}
+
+// jump length of the branch instrs[k], with the instructions at their new positions.
+static yasl_int branch_offset(const struct Instruction *const instrs, const size_t k) {
+	return (yasl_int) instrs[instrs[k].target].new_start - (yasl_int) (instrs[k].new_start + instrs[k].length);
+}
+
+/*
+ * Replaces everything in buffer from start on with code, leaving out deleted instructions. Each branch gets the
+ * shortest form its jump length fits in: since shortening one branch can bring others into range, every branch starts
+ * out at 1 byte, and branches that don't fit are widened until none need to be, which always terminates since widths
+ * only grow. Jumps to deleted instructions land on the next instruction that is kept.
+ */
+void code_encode(struct Code *const code, ByteBuffer *const buffer, const size_t start) {
+	struct Instruction *const instrs = code->instrs;
+	const size_t count = code->count;
+	for (size_t k = 0; k < count; k++) {
+		if (instrs[k].branch == BRANCH_STACK && instrs[k].length) instrs[k].length = 2;
+	}
+
+	int changed = 1;
+	while (changed) {
+		changed = 0;
+		size_t at = start;
+		for (size_t k = 0; k <= count; k++) {
+			instrs[k].new_start = at;
+			at += instrs[k].length;
+		}
+		for (size_t k = 0; k < count; k++) {
+			if (instrs[k].branch != BRANCH_STACK || !instrs[k].length) continue;
+			const size_t width = int_width(branch_offset(instrs, k));
+			if (width > instrs[k].length - 1) {
+				instrs[k].length = 1 + width;
+				changed = 1;
+			}
+		}
+	}
+
+	ByteBuffer *encoded = bb_new(instrs[count].new_start - start + 1);
+	for (size_t k = 0; k < count; k++) {
+		if (!instrs[k].length) continue;
+		switch (instrs[k].branch) {
+		case BRANCH_STACK:
+			bb_add_byte(encoded, short_branch(instrs[k].opcode, instrs[k].length - 1));
+			bb_intbytes(encoded, branch_offset(instrs, k), instrs[k].length - 1);
+			break;
+		case BRANCH_LONG:
+			bb_add_byte(encoded, instrs[k].opcode);
+			bb_append(encoded, instrs[k].bytes + 1, instrs[k].length - 1 - sizeof(yasl_int));
+			bb_intbytes8(encoded, branch_offset(instrs, k));
+			break;
+		default:
+			bb_add_byte(encoded, instrs[k].opcode);
+			bb_append(encoded, instrs[k].bytes + 1, instrs[k].length - 1);
+			break;
+		}
+	}
+
+	buffer->count = start;
+	bb_append(buffer, encoded->bytes, encoded->count);
+	bb_del(encoded);
+}
+
+void code_cleanup(struct Code *const code) {
+	free(code->instrs);
+	code->instrs = NULL;
+	code->count = 0;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "bytebuffer/bytebuffer.h"
+#include "opcode.h"
+
+/*
+ * Helpers for passes that work on emitted bytecode rather than on the AST. Code is decoded into a list of
+ * instructions, with jumps resolved to the instructions they land on, so that passes can rewrite and delete
+ * instructions without keeping track of offsets. Encoding it again picks the shortest form of each branch.
+ */
+
+enum BranchKind {
+	BRANCH_NONE,
+	BRANCH_STACK,                  // BR_8, BRF_8, BRT_8 and BRN_8
+	BRANCH_LONG,                   // register and compare branches, whose jump length is always their last 8 bytes
+};
+
+struct Instruction {
+	const unsigned char *bytes;    // the instruction as emitted; its opcode may since have been replaced by opcode
+	unsigned char opcode;
+	enum BranchKind branch;
+	size_t target;                 // for branches, index of the instruction jumped to, or count for the end of the code
+	size_t length;                 // 0 once deleted
+	size_t new_start;
+};
+
+struct Code {
+	struct Instruction *instrs;
+	size_t count;
+};
+
+size_t int_width(const yasl_int value);
+size_t instruction_length(const unsigned char *const code);
+enum BranchKind branch_kind(const unsigned char opcode);
+int code_decode(struct Code *const code, const ByteBuffer *const buffer, const size_t start);
+void code_encode(struct Code *const code, ByteBuffer *const buffer, const size_t start);
+void code_cleanup(struct Code *const code);
@@ -0,0 +1,360 @@
+#include "bytecode_file.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "bytecode.h"
+#include "compiler.h"
+#include "yasl_error.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define BYTECODE_FILE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define BYTECODE_FILE_MMAP 0
+#endif
+
+// FNV-1a, over the bytecode only.
+static uint64_t checksum(const unsigned char *bytes, size_t len) {
+	uint64_t hash = 0xcbf29ce484222325;
+	for (size_t i = 0; i < len; i++) {
+		hash ^= bytes[i];
+		hash *= 0x100000001b3;
+	}
+	return hash;
+}
+
+int bytecode_file_write(const char *filename, const unsigned char *code, size_t code_size, size_t num_globals) {
+	unsigned char header[BYTECODE_FILE_HEADER_SIZE];
+	const uint32_t version = BYTECODE_FILE_VERSION;
+	const int64_t globals = (int64_t) num_globals;
+	const int64_t size = (int64_t) code_size;
+	const uint64_t sum = checksum(code, code_size);
+	memcpy(header, BYTECODE_FILE_MAGIC, 4);
+	memcpy(header + 4, &version, sizeof(version));
+	memcpy(header + 8, &globals, sizeof(globals));
+	memcpy(header + 16, &size, sizeof(size));
+	memcpy(header + 24, &sum, sizeof(sum));
+
+	FILE *f = fopen(filename, "wb");
+	if (!f) return YASL_ERROR;
+	int ok = fwrite(header, 1, sizeof(header), f) == sizeof(header) && fwrite(code, 1, code_size, f) == code_size;
+	ok = !fclose(f) && ok;
+	return ok ? YASL_SUCCESS : YASL_ERROR;
+}
+
+/*
+ * Returns whether the file at filename starts like a bytecode file, without checking the rest of it.
+ */
+int bytecode_file_check(const char *filename) {
+	char magic[4];
+	FILE *f = fopen(filename, "rb");
+	if (!f) return 0;
+	const int is_bytecode = fread(magic, 1, sizeof(magic), f) == sizeof(magic) && !memcmp(magic, BYTECODE_FILE_MAGIC, 4);
+	fclose(f);
+	return is_bytecode;
+}
+
+static int map_file(struct BytecodeFile *file, const char *filename) {
+#if BYTECODE_FILE_MMAP
+	const int fd = open(filename, O_RDONLY);
+	if (fd < 0) return YASL_ERROR;
+	struct stat st;
+	if (fstat(fd, &st) || st.st_size < BYTECODE_FILE_HEADER_SIZE) {
+		close(fd);
+		return YASL_BYTECODE_ERROR;
+	}
+	// the VM writes into the code it runs (inline caches), so the mapping is private and writable. Only the pages
+	// it writes to are copied.
+	void *mapping = mmap(NULL, (size_t) st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (mapping == MAP_FAILED) return YASL_ERROR;
+	file->mapping = mapping;
+	file->mapping_size = (size_t) st.st_size;
+#else
+	FILE *f = fopen(filename, "rb");
+	if (!f) return YASL_ERROR;
+	fseek(f, 0, SEEK_END);
+	const long size = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	if (size < BYTECODE_FILE_HEADER_SIZE) {
+		fclose(f);
+		return YASL_BYTECODE_ERROR;
+	}
+	file->mapping = malloc((size_t) size);
+	file->mapping_size = (size_t) size;
+	const size_t read = fread(file->mapping, 1, file->mapping_size, f);
+	fclose(f);
+	if (read != file->mapping_size) {
+		free(file->mapping);
+		file->mapping = NULL;
+		return YASL_ERROR;
+	}
+#endif
+	return YASL_SUCCESS;
+}
+
+// reads the 8-byte int at offset in code, which must hold one.
+static int64_t read_int(const unsigned char *code, size_t offset) {
+	int64_t val;
+	memcpy(&val, code + offset, sizeof(val));
+	return val;
+}
+
+// what check_instructions has found each byte of the code to be.
+enum CodeByte {
+	CODE_UNSEEN,
+	CODE_START,                    // first byte of an instruction
+	CODE_OPERAND,                  // any other byte of an instruction, or of a function header
+	CODE_FN_HEADER                 // first byte of a function header
+};
+
+// width of the jump length at the end of the branch instruction opcode, or 0 if opcode isn't one.
+static size_t jump_width(const unsigned char opcode) {
+	switch (opcode) {
+	case BR_1:
+	case BRF_1:
+	case BRT_1:
+	case BRN_1:
+		return 1;
+	case BR_2:
+	case BRF_2:
+	case BRT_2:
+	case BRN_2:
+		return 2;
+	case BR_4:
+	case BRF_4:
+	case BRT_4:
+	case BRN_4:
+		return 4;
+	default:
+		return branch_kind(opcode) == BRANCH_NONE ? 0 : sizeof(yasl_int);
+	}
+}
+
+// reads the signed int of width bytes at bytes.
+static int64_t read_signed(const unsigned char *bytes, const size_t width) {
+	int8_t i8;
+	int16_t i16;
+	int32_t i32;
+	switch (width) {
+	case 1:
+		memcpy(&i8, bytes, width);
+		return i8;
+	case 2:
+		memcpy(&i16, bytes, width);
+		return i16;
+	case 4:
+		memcpy(&i32, bytes, width);
+		return i32;
+	default:
+		return read_int(bytes, 0);
+	}
+}
+
+static uint16_t read_u16(const unsigned char *bytes) {
+	uint16_t val;
+	memcpy(&val, bytes, sizeof(val));
+	return val;
+}
+
+/*
+ * Checks the operands of the instruction at pc that the VM indexes with: string constants have to be in the pool,
+ * special strings have to exist, and globals have to be below the number of globals. Register instructions work on
+ * globals in the main code, which runs without a frame, and on locals inside functions.
+ */
+static int check_operands(const unsigned char *code, const size_t pc, const int64_t count, const int64_t globals,
+			  const int in_main) {
+	const unsigned char *operands = code + pc + 1;
+	switch ((enum Opcode) code[pc]) {
+	case NEWSTR_1:
+		return operands[0] < count;
+	case NEWSTR_2:
+		return read_u16(operands) < count;
+	case NEWSTR:
+	case INIT_MC: {
+		const int64_t index = read_int(operands, 0);
+		return index >= 0 && index < count;
+	}
+	case NEWSPECIALSTR:
+	case INIT_MC_SPECIAL:
+		return operands[0] < NUM_SPECIAL_STRINGS;
+	case GSTORE_1:
+	case GLOAD_1:
+	case INCR_GLOBAL:
+	case DECR_GLOBAL:
+		return operands[0] < globals;
+	case GSTORE_2:
+	case GLOAD_2:
+		return read_u16(operands) < globals;
+	case ADD_GLOBALS:
+		return operands[0] < globals && operands[1] < globals;
+	case R_MOVI:
+	case R_BRGEI:
+	case R_BRGTI:
+		return !in_main || operands[0] < globals;
+	case R_MOV:
+	case R_ADDI:
+	case R_SUBI:
+	case R_BRGE:
+	case R_BRGT:
+		return !in_main || (operands[0] < globals && operands[1] < globals);
+	case R_ADD:
+	case R_SUB:
+	case R_MUL:
+		return !in_main || (operands[0] < globals && operands[1] < globals && operands[2] < globals);
+	case RET:
+		// there is no frame to return from in the main code.
+		return !in_main;
+	default:
+		return 1;
+	}
+}
+
+// marks the len bytes at from as kind, if none of them have been seen yet.
+static int claim_bytes(unsigned char *seen, const size_t from, const size_t len, const unsigned char kind) {
+	for (size_t i = from; i < from + len; i++) {
+		if (seen[i] != CODE_UNSEEN) return 0;
+	}
+	memset(seen + from, kind, len);
+	return 1;
+}
+
+/*
+ * Checks every instruction that can run, by following the code from the entry point, and from the start of every
+ * function pushed by FCONST, on to each next instruction and to wherever it jumps, as the JIT does to find the
+ * instructions of a function. Functions come before entry and the main code after it: jumps and instructions have to
+ * stay on the side they start on, no byte can belong to two instructions, or to an instruction and a function header,
+ * and each instruction's operands are checked by check_operands. Bytes that can't be reached are never run, so they
+ * aren't checked.
+ */
+static int check_instructions(const unsigned char *code, const size_t entry, const size_t pool, const int64_t count,
+			      const int64_t globals) {
+	const size_t first_fn = 3 * sizeof(int64_t);
+	unsigned char *seen = calloc(pool, 1);
+	size_t work_size = 16, work_count = 0;
+	size_t *work = malloc(work_size * sizeof(size_t));
+	work[work_count++] = entry;
+	int ok = 1;
+	while (ok && work_count) {
+		const size_t pc = work[--work_count];
+		if (seen[pc] == CODE_START) continue;
+
+		const int in_main = pc >= entry;
+		const size_t start = in_main ? entry : first_fn;
+		const size_t end = in_main ? pool : entry;
+		const unsigned char opcode = code[pc];
+		const size_t length = instruction_length(code + pc);
+		if (length > end - pc || !claim_bytes(seen, pc, length, CODE_OPERAND) ||
+		    !check_operands(code, pc, count, globals, in_main)) {
+			ok = 0;
+			break;
+		}
+		seen[pc] = CODE_START;
+
+		if (work_count + 2 > work_size) {
+			work_size *= 2;
+			work = realloc(work, work_size * sizeof(size_t));
+		}
+		const size_t width = jump_width(opcode);
+		if (width) {
+			// compared against the bounds as jump lengths, so that no length can overflow.
+			const int64_t from = (int64_t) (pc + length);
+			const int64_t jump = read_signed(code + pc + length - width, width);
+			ok = jump >= (int64_t) start - from && jump < (int64_t) end - from;
+			work[work_count++] = (size_t) (from + jump);
+		}
+		if (ok && opcode == FCONST) {
+			const int64_t fn = read_int(code, pc + 1);
+			ok = fn >= (int64_t) first_fn && fn < (int64_t) (entry - FN_HEADER_SIZE) &&
+			     (seen[fn] == CODE_FN_HEADER || claim_bytes(seen, (size_t) fn, FN_HEADER_SIZE, CODE_OPERAND));
+			if (ok) {
+				seen[fn] = CODE_FN_HEADER;
+				work[work_count++] = (size_t) fn + FN_HEADER_SIZE;
+			}
+		}
+		if (ok && opcode != HALT && opcode != RET && opcode != BR_1 && opcode != BR_2 && opcode != BR_4 &&
+		    opcode != BR_8) {
+			// running on past the end of the functions or of the main code isn't allowed either.
+			ok = length < end - pc;
+			work[work_count++] = pc + length;
+		}
+	}
+	free(work);
+	free(seen);
+	return ok;
+}
+
+/*
+ * Checks that the offsets and counts in the bytecode itself stay within its size, since the VM trusts them: the header
+ * ([entry point][num globals][address of string pool]), then every string in the pool ([count][len][bytes]...), which
+ * has to end exactly where the code does. The number of globals has to match the file header, and be at most
+ * MAX_VARS. The instructions are then checked by check_instructions.
+ */
+static int check_code(const unsigned char *code, size_t size, int64_t globals) {
+	const size_t word = sizeof(int64_t);
+	if (size < 3 * word) return 0;
+	const int64_t entry = read_int(code, 0);
+	const int64_t pool = read_int(code, 2 * word);
+	if (read_int(code, word) != globals || globals > MAX_VARS) return 0;
+	if (pool < (int64_t) (3 * word) || (size_t) pool > size - word) return 0;
+	if (entry < (int64_t) (3 * word) || entry >= pool) return 0;
+
+	size_t offset = (size_t) pool;
+	const int64_t count = read_int(code, offset);
+	offset += word;
+	if (count < 0 || (size_t) count > (size - offset) / word) return 0;
+	for (int64_t i = 0; i < count; i++) {
+		if (size - offset < word) return 0;
+		const int64_t len = read_int(code, offset);
+		offset += word;
+		if (len < 0 || (size_t) len > size - offset) return 0;
+		offset += (size_t) len;
+	}
+	return offset == size && check_instructions(code, (size_t) entry, (size_t) pool, count, globals);
+}
+
+/*
+ * Maps the bytecode file at filename into memory, and checks its header, checksum and contents. On success, the code
+ * can be run in place, until bytecode_file_close is called.
+ */
+int bytecode_file_load(struct BytecodeFile *file, const char *filename) {
+	file->mapping = NULL;
+	const int status = map_file(file, filename);
+	if (status) return status;
+
+	const unsigned char *header = file->mapping;
+	uint32_t version;
+	int64_t globals, size;
+	uint64_t sum;
+	memcpy(&version, header + 4, sizeof(version));
+	memcpy(&globals, header + 8, sizeof(globals));
+	memcpy(&size, header + 16, sizeof(size));
+	memcpy(&sum, header + 24, sizeof(sum));
+
+	file->code = (unsigned char *) file->mapping + BYTECODE_FILE_HEADER_SIZE;
+	file->code_size = (size_t) size;
+	file->num_globals = (size_t) globals;
+
+	if (memcmp(header, BYTECODE_FILE_MAGIC, 4) || version != BYTECODE_FILE_VERSION || globals < 0 || size < 0 ||
+	    (size_t) size != file->mapping_size - BYTECODE_FILE_HEADER_SIZE || checksum(file->code, file->code_size) != sum ||
+	    !check_code(file->code, file->code_size, globals)) {
+		bytecode_file_close(file);
+		return YASL_BYTECODE_ERROR;
+	}
+	return YASL_SUCCESS;
+}
+
+void bytecode_file_close(struct BytecodeFile *file) {
+	if (!file->mapping) return;
+#if BYTECODE_FILE_MMAP
+	munmap(file->mapping, file->mapping_size);
+#else
+	free(file->mapping);
+#endif
+	file->mapping = NULL;
+	file->code = NULL;
+}
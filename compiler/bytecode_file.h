@@ -0,0 +1,39 @@
+#pragma once
+
+#include <stdlib.h>
+
+#include "yasl_conf.h"
+
+/*
+ * Bytecode files hold compiled code, so that it can be run without being compiled again. A file is a header of
+ * BYTECODE_FILE_HEADER_SIZE bytes, followed by the bytecode exactly as returned by compile(), string pool included:
+ *
+ *   [magic 4][format version 4][num globals 8][length of bytecode 8][checksum of bytecode 8][bytecode]
+ *
+ * Numbers are stored in the byte order of the machine that wrote the file. The format version has to be bumped
+ * whenever the bytecode changes in an incompatible way, such as when opcodes are added or renumbered.
+ *
+ * The checksum only catches files that were damaged by accident. Before a file is run, its offsets and counts are
+ * checked, as is every instruction that can be reached: each has to lie within the code, jumps have to land on the
+ * start of an instruction, and string constants, special strings and globals have to exist. What isn't checked is how
+ * the code uses the stack: a file that pops more than it pushed, or builds a list out of more values than are on the
+ * stack, can still read and write outside of it. Bytecode files should only be run if they come from a trusted source,
+ * the same as source files.
+ */
+
+#define BYTECODE_FILE_MAGIC "\x1bYSL"
+#define BYTECODE_FILE_VERSION 8
+#define BYTECODE_FILE_HEADER_SIZE 32
+
+struct BytecodeFile {
+	unsigned char *code;           // the bytecode, at BYTECODE_FILE_HEADER_SIZE bytes into the mapping
+	size_t code_size;
+	size_t num_globals;
+	void *mapping;                 // the whole file, mapped copy-on-write, or read into memory without mmap
+	size_t mapping_size;
+};
+
+int bytecode_file_write(const char *filename, const unsigned char *code, size_t code_size, size_t num_globals);
+int bytecode_file_check(const char *filename);
+int bytecode_file_load(struct BytecodeFile *file, const char *filename);
+void bytecode_file_close(struct BytecodeFile *file);
@@ -3,12 +3,15 @@
 #include "compiler.h"
 
 #include "middleend.h"
+#include "bytecode.h"
+#include "peephole.h"
 #include "interpreter/YASL_string.h"
 #include "bytebuffer/bytebuffer.h"
 #include "parser.h"
 #include "yasl_error.h"
 #include "yasl_include.h"
 #include "lexinput.h"
+#include "slab/slab.h"
 #include <math.h>
 
 #define break_checkpoint(compiler)    ((compiler)->checkpoints[(compiler)->checkpoints_count-1])
@@ -41,6 +44,7 @@ static enum SpecialStrings get_special_string(const struct Node *const node) {
 	else if (STR_EQ(node, "search")) return S_SEARCH;
 	else if (STR_EQ(node, "slice")) return S_SLICE;
 	else if (STR_EQ(node, "split")) return S_SPLIT;
+	else if (STR_EQ(node, "stablesort")) return S_STABLESORT;
 	else if (STR_EQ(node, "startswith")) return S_STARTSWITH;
 	else if (STR_EQ(node, "tobool")) return S_TOBOOL;
 	else if (STR_EQ(node, "tofloat")) return S_TOFLOAT;
@@ -56,6 +60,7 @@ static enum SpecialStrings get_special_string(const struct Node *const node) {
 
 struct Compiler *compiler_new(FILE *fp) {
 	struct Compiler *compiler = malloc(sizeof(struct Compiler));
+	slab_retain();
 
 	compiler->globals = env_new(NULL);
 	compiler->params = NULL;
@@ -64,19 +69,24 @@ struct Compiler *compiler_new(FILE *fp) {
 	compiler->strings = table_new();
 	compiler->parser = NEW_PARSER(lp);
 	compiler->buffer = bb_new(16);
-	compiler->header = bb_new(16);
-	compiler->header->count = 16;
+	compiler->header = bb_new(HEADER_SIZE);
+	compiler->header->count = HEADER_SIZE;
+	compiler->string_pool = bb_new(16);
 	compiler->status = YASL_SUCCESS;
 	compiler->checkpoints_size = 4;
 	compiler->checkpoints = malloc(sizeof(size_t) * compiler->checkpoints_size);
 	compiler->checkpoints_count = 0;
 	compiler->code = bb_new(16);
+	compiler->options = YASL_OPT_DEFAULT;
+	compiler->num_globals = 0;
+	compiler->num_locals = 0;
 	return compiler;
 }
 
 
 struct Compiler *compiler_new_bb(char *buf, int len) {
 	struct Compiler *compiler = malloc(sizeof(struct Compiler));
+	slab_retain();
 
 	compiler->globals = env_new(NULL);
 	compiler->params = NULL;
@@ -85,13 +95,17 @@ struct Compiler *compiler_new_bb(char *buf, int len) {
 	compiler->strings = table_new();
 	compiler->parser = NEW_PARSER(lp);
 	compiler->buffer = bb_new(16);
-	compiler->header = bb_new(16);
-	compiler->header->count = 16;
+	compiler->header = bb_new(HEADER_SIZE);
+	compiler->header->count = HEADER_SIZE;
+	compiler->string_pool = bb_new(16);
 	compiler->status = YASL_SUCCESS;
 	compiler->checkpoints_size = 4;
 	compiler->checkpoints = malloc(sizeof(size_t) * compiler->checkpoints_size);
 	compiler->checkpoints_count = 0;
 	compiler->code = bb_new(16);
+	compiler->options = YASL_OPT_DEFAULT;
+	compiler->num_globals = 0;
+	compiler->num_locals = 0;
 	return compiler;
 }
 
@@ -104,6 +118,7 @@ void compiler_tables_del(struct Compiler *compiler) {
 static void compiler_buffers_del(const struct Compiler *const compiler) {
 	bb_del(compiler->buffer);
 	bb_del(compiler->header);
+	bb_del(compiler->string_pool);
 	bb_del(compiler->code);
 }
 
@@ -114,6 +129,7 @@ void compiler_cleanup(struct Compiler *compiler) {
 	parser_cleanup(&compiler->parser);
 	compiler_buffers_del(compiler);
 	free(compiler->checkpoints);
+	slab_release();
 }
 
 static void handle_error(struct Compiler *const compiler) {
@@ -176,15 +192,28 @@ static inline int64_t get_index(int64_t value) {
 	return is_const(value) ? ~value : value;
 }
 
+/*
+ * Emits a load or store of the variable at index, using the 1 byte form of opcode if index fits in it, and the 2 byte
+ * form wide otherwise.
+ */
+static void add_var_op(struct Compiler *const compiler, enum Opcode opcode, enum Opcode wide, int64_t index) {
+	if (index <= UINT8_MAX) {
+		bb_add_byte(compiler->buffer, opcode);
+		bb_add_byte(compiler->buffer, (unsigned char) index);
+	} else {
+		const uint16_t index16 = (uint16_t) index;
+		bb_add_byte(compiler->buffer, wide);
+		bb_append(compiler->buffer, (unsigned char *) &index16, sizeof(index16));
+	}
+}
+
 static void load_var(struct Compiler *const compiler, char *name, size_t name_len, size_t line) {
 	if (env_contains(compiler->params, name, name_len)) {
 		int64_t index = get_index(env_get(compiler->params, name, name_len));
-		bb_add_byte(compiler->buffer, LLOAD_1);
-		bb_add_byte(compiler->buffer, (unsigned char)index);
+		add_var_op(compiler, LLOAD_1, LLOAD_2, index);
 	} else if (env_contains(compiler->globals, name, name_len)) {
 		int64_t index = get_index(env_get(compiler->globals, name, name_len));
-		bb_add_byte(compiler->buffer, GLOAD_1);
-		bb_add_byte(compiler->buffer, (unsigned char) index);
+		add_var_op(compiler, GLOAD_1, GLOAD_2, index);
 	} else {
 		YASL_PRINT_ERROR_UNDECLARED_VAR(name, line);
 		handle_error(compiler);
@@ -200,8 +229,7 @@ static void store_var(struct Compiler *const compiler, char *name, size_t name_l
 			handle_error(compiler);
 			return;
 		}
-		bb_add_byte(compiler->buffer, LSTORE_1);
-		bb_add_byte(compiler->buffer, (unsigned char) index);
+		add_var_op(compiler, LSTORE_1, LSTORE_2, index);
 	} else if (env_contains(compiler->globals, name, name_len)) {
 		int64_t index = env_get(compiler->globals, name, name_len);
 		if (is_const(index)) {
@@ -209,8 +237,7 @@ static void store_var(struct Compiler *const compiler, char *name, size_t name_l
 			handle_error(compiler);
 			return;
 		}
-		bb_add_byte(compiler->buffer, GSTORE_1);
-		bb_add_byte(compiler->buffer, (unsigned char) index);
+		add_var_op(compiler, GSTORE_1, GSTORE_2, index);
 	} else {
 		YASL_PRINT_ERROR_UNDECLARED_VAR(name, line);
 		handle_error(compiler);
@@ -232,16 +259,18 @@ static int contains_var(const struct Compiler *const compiler, char *name, size_
 static void decl_var(struct Compiler *const compiler, char *name, size_t name_len, size_t line) {
 	if (NULL != compiler->params) {
 		int64_t index = env_decl_var(compiler->params, name, name_len);
-		if (index > 255) {
+		if (index > MAX_VARS) {
 			YASL_PRINT_ERROR_TOO_MANY_VAR(line);
 			handle_error(compiler);
 		}
+		if ((size_t) index > compiler->num_locals) compiler->num_locals = (size_t) index;
 	} else {
 		int64_t index = env_decl_var(compiler->globals, name, name_len);
-		if (index > 255) {
+		if (index > MAX_VARS) {
 			YASL_PRINT_ERROR_TOO_MANY_VAR(line);
 			handle_error(compiler);
 		}
+		if ((size_t) index > compiler->num_globals) compiler->num_globals = (size_t) index;
 	}
 }
 
@@ -250,11 +279,425 @@ static void make_const(struct Compiler * const compiler, char *name, size_t name
 	else env_make_const(compiler->globals, name, name_len);
 }
 
+/*
+ * Register mode (YASL_OPT_REGISTERS). Assignments and loop conditions whose operands are all variables of the current
+ * frame (globals at the top level, locals inside a function) or small int literals are compiled to instructions that
+ * read and write frame slots directly. Anything else falls back to stack code.
+ */
+static int reg_slot(const struct Compiler *const compiler, char *name, size_t name_len, int store, unsigned char *slot) {
+	Env_t *env = compiler->params != NULL ? compiler->params : compiler->globals;
+	if (!env_contains(env, name, name_len)) return 0;
+	int64_t index = env_get(env, name, name_len);
+	if (store && is_const(index)) return 0;
+	index = get_index(index);
+	if (index > 255) return 0;
+	*slot = (unsigned char) index;
+	return 1;
+}
+
+static int reg_operand(const struct Compiler *const compiler, const struct Node *const node, unsigned char *slot) {
+	return node->nodetype == N_VAR && reg_slot(compiler, node->value.sval.str, node->value.sval.str_len, 0, slot);
+}
+
+static int reg_imm(const struct Node *const node, signed char *imm) {
+	if (node->nodetype != N_INT || node->value.ival < -128 || node->value.ival > 127) return 0;
+	*imm = (signed char) node->value.ival;
+	return 1;
+}
+
+/*
+ * Checks whether node can be computed into slot dst using only register instructions, and emits them if emit is set.
+ */
+static int reg_expr(struct Compiler *const compiler, const struct Node *const node, unsigned char dst, int emit) {
+	unsigned char a, b;
+	signed char imm;
+	if (reg_operand(compiler, node, &a)) {
+		if (emit && a != dst) {
+			bb_add_byte(compiler->buffer, R_MOV);
+			bb_add_byte(compiler->buffer, dst);
+			bb_add_byte(compiler->buffer, a);
+		}
+		return 1;
+	}
+	if (reg_imm(node, &imm)) {
+		if (emit) {
+			bb_add_byte(compiler->buffer, R_MOVI);
+			bb_add_byte(compiler->buffer, dst);
+			bb_add_byte(compiler->buffer, (unsigned char) imm);
+		}
+		return 1;
+	}
+	if (node->nodetype != N_BINOP) return 0;
+
+	unsigned char opcode, opcode_imm;
+	switch (node->type) {
+	case T_PLUS:
+		opcode = R_ADD;
+		opcode_imm = R_ADDI;
+		break;
+	case T_MINUS:
+		opcode = R_SUB;
+		opcode_imm = R_SUBI;
+		break;
+	case T_STAR:
+		opcode = R_MUL;
+		opcode_imm = HALT;
+		break;
+	default:
+		return 0;
+	}
+
+	if (reg_operand(compiler, node->children[1], &b)) {
+		imm = 0;
+	} else if (opcode_imm != HALT && reg_imm(node->children[1], &imm)) {
+		opcode = opcode_imm;
+		b = (unsigned char) imm;
+	} else {
+		return 0;
+	}
+
+	if (!reg_operand(compiler, node->children[0], &a)) {
+		// left operand is computed into dst first, so the right one must not read dst.
+		if (opcode != opcode_imm && b == dst) return 0;
+		if (!reg_expr(compiler, node->children[0], dst, emit)) return 0;
+		a = dst;
+	}
+
+	if (emit) {
+		bb_add_byte(compiler->buffer, opcode);
+		bb_add_byte(compiler->buffer, dst);
+		bb_add_byte(compiler->buffer, a);
+		bb_add_byte(compiler->buffer, b);
+	}
+	return 1;
+}
+
+static int reg_assign(struct Compiler *const compiler, char *name, size_t name_len, const struct Node *const expr) {
+	unsigned char dst;
+	if (!(compiler->options & YASL_OPT_REGISTERS) ||
+	    !reg_slot(compiler, name, name_len, 1, &dst) ||
+	    !reg_expr(compiler, expr, dst, 0)) {
+		return 0;
+	}
+	reg_expr(compiler, expr, dst, 1);
+	return 1;
+}
+
+/*
+ * Emits a register branch taken when cond is false, for conditions of the form `a < b` and `a <= b`.
+ */
+static int reg_conditional_false(struct Compiler *const compiler, const struct Node *const cond, int64_t *index) {
+	unsigned char a, b;
+	signed char imm;
+	unsigned char opcode;
+	if (!(compiler->options & YASL_OPT_REGISTERS) || cond->nodetype != N_BINOP) return 0;
+	switch (cond->type) {
+	case T_LT:
+		opcode = R_BRGE;
+		break;
+	case T_LTEQ:
+		opcode = R_BRGT;
+		break;
+	default:
+		return 0;
+	}
+
+	if (!reg_operand(compiler, cond->children[0], &a)) return 0;
+	if (reg_operand(compiler, cond->children[1], &b)) {
+		bb_add_byte(compiler->buffer, opcode);
+		bb_add_byte(compiler->buffer, a);
+		bb_add_byte(compiler->buffer, b);
+	} else if (reg_imm(cond->children[1], &imm)) {
+		bb_add_byte(compiler->buffer, opcode == R_BRGE ? R_BRGEI : R_BRGTI);
+		bb_add_byte(compiler->buffer, a);
+		bb_add_byte(compiler->buffer, (unsigned char) imm);
+	} else {
+		return 0;
+	}
+	*index = compiler->buffer->count;
+	bb_intbytes8(compiler->buffer, 0);
+	return 1;
+}
+
+/*
+ * Superinstructions (YASL_OPT_SUPERINSTRUCTIONS). Increments of a variable by a small int, sums of two variables and
+ * comparisons used as conditions are compiled to single instructions doing the work of the usual stack sequence.
+ */
+static int fused_var(const struct Compiler *const compiler, const struct Node *const node, int store, int *local,
+		     unsigned char *index) {
+	if (node->nodetype != N_VAR) return 0;
+	int64_t value;
+	if (env_contains(compiler->params, node->value.sval.str, node->value.sval.str_len)) {
+		value = env_get(compiler->params, node->value.sval.str, node->value.sval.str_len);
+		*local = 1;
+	} else if (env_contains(compiler->globals, node->value.sval.str, node->value.sval.str_len)) {
+		value = env_get(compiler->globals, node->value.sval.str, node->value.sval.str_len);
+		*local = 0;
+	} else {
+		return 0;
+	}
+	if (store && is_const(value)) return 0;
+	value = get_index(value);
+	if (value > UINT8_MAX) return 0;
+	*index = (unsigned char) value;
+	return 1;
+}
+
+// emits INCR_* or DECR_* for assignments of the form `x = x + 1` or `x -= 1`.
+static int fused_incr(struct Compiler *const compiler, const struct Node *const node) {
+	const struct Node *const expr = Assign_get_expr(node);
+	signed char imm;
+	int local;
+	unsigned char index;
+	if (!(compiler->options & YASL_OPT_SUPERINSTRUCTIONS) || expr->nodetype != N_BINOP ||
+	    (expr->type != T_PLUS && expr->type != T_MINUS) ||
+	    expr->children[0]->nodetype != N_VAR ||
+	    expr->children[0]->value.sval.str_len != node->value.sval.str_len ||
+	    memcmp(expr->children[0]->value.sval.str, node->value.sval.str, node->value.sval.str_len) ||
+	    !reg_imm(expr->children[1], &imm) ||
+	    !fused_var(compiler, expr->children[0], 1, &local, &index)) {
+		return 0;
+	}
+	if (expr->type == T_PLUS) bb_add_byte(compiler->buffer, local ? INCR_LOCAL : INCR_GLOBAL);
+	else bb_add_byte(compiler->buffer, local ? DECR_LOCAL : DECR_GLOBAL);
+	bb_add_byte(compiler->buffer, index);
+	bb_add_byte(compiler->buffer, (unsigned char) imm);
+	return 1;
+}
+
+// emits ADD_LOCALS or ADD_GLOBALS for `a + b`, where a and b are both locals or both globals.
+static int fused_add(struct Compiler *const compiler, const struct Node *const node) {
+	int local_a, local_b;
+	unsigned char a, b;
+	if (!(compiler->options & YASL_OPT_SUPERINSTRUCTIONS) || node->type != T_PLUS ||
+	    !fused_var(compiler, node->children[0], 0, &local_a, &a) ||
+	    !fused_var(compiler, node->children[1], 0, &local_b, &b) ||
+	    local_a != local_b) {
+		return 0;
+	}
+	bb_add_byte(compiler->buffer, local_a ? ADD_LOCALS : ADD_GLOBALS);
+	bb_add_byte(compiler->buffer, a);
+	bb_add_byte(compiler->buffer, b);
+	return 1;
+}
+
+/*
+ * Emits a compare branch taken when cond is false, for conditions that are comparisons.
+ */
+static int fused_conditional_false(struct Compiler *const compiler, const struct Node *const cond, int64_t *index) {
+	unsigned char opcode;
+	if (!(compiler->options & YASL_OPT_SUPERINSTRUCTIONS) || cond->nodetype != N_BINOP) return 0;
+	switch (cond->type) {
+	case T_LT:
+		opcode = LT_BRF;
+		break;
+	case T_LTEQ:
+		opcode = LE_BRF;
+		break;
+	case T_GT:
+		opcode = GT_BRF;
+		break;
+	case T_GTEQ:
+		opcode = GE_BRF;
+		break;
+	default:
+		return 0;
+	}
+
+	visit(compiler, cond->children[0]);
+	visit(compiler, cond->children[1]);
+	bb_add_byte(compiler->buffer, opcode);
+	*index = compiler->buffer->count;
+	bb_intbytes8(compiler->buffer, 0);
+	return 1;
+}
+
+/*
+ * Constant propagation (YASL_OPT_CONSTANTS). Constants bound to a literal have their value recorded in the scope that
+ * declares them, and expressions are rewritten to use that value before they are compiled, and then folded again.
+ * Branches whose condition this makes constant are only kept if they are taken.
+ */
+static const struct Node *const_value(const struct Compiler *const compiler, char *name, size_t name_len) {
+	if (env_contains(compiler->params, name, name_len)) return env_get_const_value(compiler->params, name, name_len);
+	return env_get_const_value(compiler->globals, name, name_len);
+}
+
+// replaces the variables in node that have a constant value with that value. Returns whether any were replaced.
+static int propagate(const struct Compiler *const compiler, struct Node *const node) {
+	switch (node->nodetype) {
+	case N_VAR: {
+		const struct Node *value = const_value(compiler, node->value.sval.str, node->value.sval.str_len);
+		if (value == NULL || !is_literal(value)) return 0;
+		struct Node *copy = node_clone(value);
+		copy->line = node->line;
+		free(node->value.sval.str);
+		memcpy(node, copy, sizeof(struct Node));
+		free(copy);
+		return 1;
+	}
+	// these declare names of their own, which may shadow constants.
+	case N_FNDECL:
+	case N_LISTCOMP:
+	case N_TABLECOMP:
+		return 0;
+	default: {
+		int replaced = 0;
+		FOR_CHILDREN(i, child, node) {
+			replaced |= propagate(compiler, child);
+		}
+		return replaced;
+	}
+	}
+}
+
+static void propagate_constants(const struct Compiler *const compiler, const struct Node *const expr) {
+	if (!(compiler->options & YASL_OPT_CONSTANTS) || expr == NULL) return;
+	// the tree is the compiler's to rewrite, since it is deleted once compiled.
+	if (propagate(compiler, (struct Node *) expr)) fold((struct Node *) expr);
+}
+
+static int is_constant_condition(const struct Compiler *const compiler, const struct Node *const cond) {
+	return (compiler->options & YASL_OPT_CONSTANTS) && is_literal(cond);
+}
+
+// compiles node in a scope of its own, and drops the code unless keep is set. Its errors are still reported.
+static void visit_branch(struct Compiler *const compiler, const struct Node *const node, int keep) {
+	const size_t start = compiler->buffer->count;
+	enter_scope(compiler);
+	visit(compiler, node);
+	exit_scope(compiler);
+	if (!keep) compiler->buffer->count = start;
+}
+
+/*
+ * Inlining (YASL_OPT_INLINE). A constant function whose body only returns a small expression of its parameters has its
+ * declaration recorded like the value of a constant, and calls to it are compiled to the expression, with the arguments
+ * stored in a scope of their own. Since the expression can't name anything but the parameters, such a function can't
+ * be recursive, and the arguments still only get evaluated once, in order.
+ */
+static int inlinable_expr(const struct Node *const params, const struct Node *const node, size_t *size) {
+	if (++*size > MAX_INLINE_NODES) return 0;
+	switch (node->nodetype) {
+	case N_VAR: {
+		FOR_CHILDREN(i, param, params) {
+			if (param->value.sval.str_len == node->value.sval.str_len &&
+			    !memcmp(param->value.sval.str, node->value.sval.str, node->value.sval.str_len)) {
+				return 1;
+			}
+		}
+		return 0;
+	}
+	case N_ASSIGN:
+	case N_FNDECL:
+	case N_LISTCOMP:
+	case N_TABLECOMP:
+		return 0;
+	default: {
+		FOR_CHILDREN(i, child, node) {
+			if (!inlinable_expr(params, child, size)) return 0;
+		}
+		return 1;
+	}
+	}
+}
+
+static int is_inlinable(const struct Node *const fn) {
+	const struct Node *const body = FnDecl_get_body(fn);
+	if (body->children_len != 1 || body->children[0]->nodetype != N_RET) return 0;
+	size_t size = 0;
+	return inlinable_expr(FnDecl_get_params(fn), Return_get_expr(body->children[0]), &size);
+}
+
+// compiles a call to an inlinable function in place. Returns 0 if the callee isn't one.
+static int inline_call(struct Compiler *const compiler, const struct Node *const node) {
+	const struct Node *const callee = node->children[1];
+	if (!(compiler->options & YASL_OPT_INLINE) || callee->nodetype != N_VAR) return 0;
+	const struct Node *const fn = const_value(compiler, callee->value.sval.str, callee->value.sval.str_len);
+	if (fn == NULL || fn->nodetype != N_FNDECL) return 0;
+
+	const struct Node *const params = FnDecl_get_params(fn);
+	const struct Node *const args = Call_get_params(node);
+	const int use_literals = compiler->options & YASL_OPT_CONSTANTS;
+
+	// literal arguments are used as the values of their parameters, and extra arguments are only evaluated.
+	FOR_CHILDREN(i, arg, args) {
+		if (i < params->children_len && use_literals && is_literal(arg)) continue;
+		visit(compiler, arg);
+		if (i >= params->children_len) bb_add_byte(compiler->buffer, POP);
+	}
+
+	enter_scope(compiler);
+	Env_t *const env = compiler->params != NULL ? compiler->params : compiler->globals;
+	for (size_t i = 0; i < params->children_len; i++) {
+		decl_var(compiler, params->children[i]->value.sval.str, params->children[i]->value.sval.str_len,
+			 params->children[i]->line);
+	}
+	for (size_t i = params->children_len; i-- > 0;) {
+		const struct Node *const param = params->children[i];
+		const struct Node *const arg = i < args->children_len ? args->children[i] : NULL;
+		if (use_literals && (arg == NULL || is_literal(arg))) {
+			env_set_const_value(env, param->value.sval.str, param->value.sval.str_len,
+					    arg != NULL ? node_clone(arg) : new_Undef(param->line));
+			continue;
+		}
+		if (arg == NULL) bb_add_byte(compiler->buffer, NCONST);
+		store_var(compiler, param->value.sval.str, param->value.sval.str_len, param->line);
+	}
+	FOR_CHILDREN(i, param, params) {
+		if (param->nodetype == N_CONST) make_const(compiler, param->value.sval.str, param->value.sval.str_len);
+	}
+
+	struct Node *const expr = node_clone(Return_get_expr(FnDecl_get_body(fn)->children[0]));
+	propagate_constants(compiler, expr);
+	visit(compiler, expr);
+	node_del(expr);
+	exit_scope(compiler);
+	return 1;
+}
+
+static int contains_break(const struct Node *const node) {
+	if (node->nodetype == N_BREAK) return 1;
+	FOR_CHILDREN(i, child, node) {
+		if (contains_break(child)) return 1;
+	}
+	return 0;
+}
+
+size_t bytecode_size(const struct Compiler *const compiler) {
+	return compiler->header->count + compiler->code->count + 1 + sizeof(yasl_int) + compiler->string_pool->count;
+}
+
+/*
+ * Returns the number of global slots needed by the code compiled so far, including globals declared through the API.
+ */
+size_t compiler_num_globals(const struct Compiler *const compiler) {
+	const size_t declared = env_len(compiler->globals);
+	return declared > compiler->num_globals ? declared : compiler->num_globals;
+}
+
+/*
+ * Returns the index of the given string in the string pool, adding it if it isn't there yet.
+ */
+static yasl_int add_string_constant(struct Compiler *const compiler, char *str, const size_t len) {
+	struct YASL_Object value = table_search_string_int(compiler->strings, str, len);
+	if (!YASL_ISEND(value)) {
+		return YASL_GETINT(value);
+	}
+	YASL_COMPILE_DEBUG_LOG("%s\n", "caching string");
+	const yasl_int index = compiler->strings->count;
+	table_insert_string_int(compiler->strings, str, len, index);
+	bb_intbytes8(compiler->string_pool, len);
+	bb_append(compiler->string_pool, (unsigned char *) str, len);
+	return index;
+}
+
 static unsigned char *return_bytes(struct Compiler *const compiler) {
 	if (compiler->status) return NULL;
 
+	const size_t pool = compiler->header->count + compiler->code->count + 1;
 	bb_rewrite_intbytes8(compiler->header, 0, compiler->header->count);
-	bb_rewrite_intbytes8(compiler->header, 8, 0x00);   // TODO: put num globals here eventually.
+	bb_rewrite_intbytes8(compiler->header, 8, compiler_num_globals(compiler));
+	bb_rewrite_intbytes8(compiler->header, 16, pool);
 
 	YASL_BYTECODE_DEBUG_LOG("%s\n", "header");
 	for (size_t i = 0; i < compiler->header->count; i++) {
@@ -271,15 +714,38 @@ static unsigned char *return_bytes(struct Compiler *const compiler) {
 			YASL_BYTECODE_DEBUG_LOG("%02x ", compiler->code->bytes[i]);
 	}
 	YASL_BYTECODE_DEBUG_LOG("%02x\n", HALT);
+	YASL_BYTECODE_DEBUG_LOG("%s\n", "string pool");
+	for (size_t i = 0; i < compiler->string_pool->count; i++) {
+		if (i % 16 == 15)
+			YASL_BYTECODE_DEBUG_LOG("%02x\n", compiler->string_pool->bytes[i]);
+		else
+			YASL_BYTECODE_DEBUG_LOG("%02x ", compiler->string_pool->bytes[i]);
+	}
+	YASL_BYTECODE_DEBUG_LOG("%s\n", "");
 
 	fflush(stdout);
-	unsigned char *bytecode = malloc(compiler->code->count + compiler->header->count + 1);    // NOT OWN
+	const yasl_int num_strings = compiler->strings->count;
+	unsigned char *bytecode = malloc(bytecode_size(compiler));    // NOT OWN
 	memcpy(bytecode, compiler->header->bytes, compiler->header->count);
 	memcpy(bytecode + compiler->header->count, compiler->code->bytes, compiler->code->count);
-	bytecode[compiler->code->count + compiler->header->count] = HALT;
+	bytecode[pool - 1] = HALT;
+	memcpy(bytecode + pool, &num_strings, sizeof(yasl_int));
+	memcpy(bytecode + pool + sizeof(yasl_int), compiler->string_pool->bytes, compiler->string_pool->count);
 	return bytecode;
 }
 
+/*
+ * Runs the peephole optimizer, if it is enabled, over the code in the buffer from start on, and gives every branch in
+ * it the shortest form it fits in.
+ */
+static void finish_code(struct Compiler *const compiler, const size_t start) {
+	struct Code code;
+	if (!code_decode(&code, compiler->buffer, start)) return;
+	if (compiler->options & YASL_OPT_PEEPHOLE) peephole(&code);
+	code_encode(&code, compiler->buffer, start);
+	code_cleanup(&code);
+}
+
 unsigned char *compile(struct Compiler *const compiler) {
 	struct Node *node;
 	gettok(&compiler->parser.lex);
@@ -290,6 +756,7 @@ unsigned char *compile(struct Compiler *const compiler) {
 		compiler->status |= compiler->parser.status;
 		if (!compiler->parser.status) {
 			visit(compiler, node);
+			finish_code(compiler, 0);
 			bb_append(compiler->code, compiler->buffer->bytes, compiler->buffer->count);
 			compiler->buffer->count = 0;
 		}
@@ -313,6 +780,7 @@ unsigned char *compile_REPL(struct Compiler *const compiler) {
 				node->nodetype = N_PRINT;
 			}
 			visit(compiler, node);
+			finish_code(compiler, 0);
 			bb_append(compiler->code, compiler->buffer->bytes, compiler->buffer->count);
 			compiler->buffer->count = 0;
 		}
@@ -323,8 +791,22 @@ unsigned char *compile_REPL(struct Compiler *const compiler) {
 	return return_bytes(compiler);
 }
 
+// stores the value of an assignment, without leaving it on the stack. Returns 0 if the variable doesn't exist.
+static int assign_var(struct Compiler *const compiler, const struct Node *const node) {
+	if (!contains_var(compiler, node->value.sval.str, node->value.sval.str_len)) {
+		YASL_PRINT_ERROR_UNDECLARED_VAR(node->value.sval.str, node->line);
+		handle_error(compiler);
+		return 0;
+	}
+	if (fused_incr(compiler, node)) return 1;
+	visit(compiler, Assign_get_expr(node));
+	store_var(compiler, node->value.sval.str, node->value.sval.str_len, node->line);
+	return 1;
+}
+
 static void visit_ExprStmt(struct Compiler *const compiler, const struct Node *const node) {
 	const struct Node *const expr = ExprStmt_get_expr(node);
+	propagate_constants(compiler, expr);
 	switch (expr->nodetype) {
 	case N_STR:
 	case N_INT:
@@ -333,13 +815,14 @@ static void visit_ExprStmt(struct Compiler *const compiler, const struct Node *c
 	case N_UNDEF:
 	case N_VAR:
 		return;
+	case N_ASSIGN:
+		if (!reg_assign(compiler, expr->value.sval.str, expr->value.sval.str_len, Assign_get_expr(expr))) {
+			assign_var(compiler, expr);
+		}
+		return;
 	default:
 		visit(compiler, expr);
-		if (expr->nodetype == N_ASSIGN) {
-			compiler->buffer->count -= 2;
-		} else {
-			bb_add_byte(compiler->buffer, POP);
-		}
+		bb_add_byte(compiler->buffer, POP);
 	}
 }
 
@@ -353,7 +836,9 @@ static void visit_FunctionDecl(struct Compiler *const compiler, const struct Nod
 
 	// start logic for function, now that we are sure it's legal to do so, and have set up.
 
+	const size_t start = compiler->buffer->count;
 	compiler->params = env_new(compiler->params);
+	compiler->num_locals = 0;
 
 	enter_scope(compiler);
 
@@ -366,17 +851,23 @@ static void visit_FunctionDecl(struct Compiler *const compiler, const struct Nod
 		}
 	}
 
-	bb_add_byte(compiler->buffer, FnDecl_get_params(node)->children_len);
-	bb_add_byte(compiler->buffer, compiler->params->vars->count);
+	// the number of locals is only known once the body is compiled, so it is filled in after.
+	const size_t num_params = FnDecl_get_params(node)->children_len;
+	bb_add_byte(compiler->buffer, (unsigned char) num_params);
+	bb_add_byte(compiler->buffer, 0);
+	bb_add_byte(compiler->buffer, 0);
 	visit_Body(compiler, FnDecl_get_body(node));
+	const uint16_t num_locals = (uint16_t) (compiler->num_locals - num_params);
+	memcpy(compiler->buffer->bytes + start + 1, &num_locals, sizeof(num_locals));
+	bb_add_byte(compiler->buffer, NCONST);
+	bb_add_byte(compiler->buffer, RET);
+	finish_code(compiler, start + FN_HEADER_SIZE);
 
 	int64_t fn_val = compiler->header->count;
-	bb_append(compiler->header, compiler->buffer->bytes, compiler->buffer->count);
-	bb_add_byte(compiler->header, NCONST);
-	bb_add_byte(compiler->header, RET);
+	bb_append(compiler->header, compiler->buffer->bytes + start, compiler->buffer->count - start);
 
-	// zero buffer length
-	compiler->buffer->count = 0;
+	// drop the function from the buffer, leaving whatever came before it.
+	compiler->buffer->count = start;
 
 	exit_scope(compiler);
 	Env_t *tmp = compiler->params->parent;
@@ -389,12 +880,20 @@ static void visit_FunctionDecl(struct Compiler *const compiler, const struct Nod
 
 static void visit_Call(struct Compiler *const compiler, const struct Node *const node) {
 	YASL_COMPILE_DEBUG_LOG("Visit Call: %s\n", node->value.sval.str);
+	if (inline_call(compiler, node)) return;
 	visit(compiler, node->children[1]);
 	bb_add_byte(compiler->buffer, INIT_CALL);
 	visit_Body(compiler, Call_get_params(node));
 	bb_add_byte(compiler->buffer, CALL);
 }
 
+// the cache starts out empty, and is filled in by the VM.
+static void add_mc_cache(struct Compiler *const compiler) {
+	for (int i = 0; i < MC_CACHE_SIZE; i++) {
+		bb_add_byte(compiler->buffer, 0x00);
+	}
+}
+
 static void visit_MethodCall(struct Compiler *const compiler, const struct Node *const node) {
 	YASL_COMPILE_DEBUG_LOG("Visit MethodCall: %s\n", node->value.sval.str);
 	visit(compiler, node->children[1]);
@@ -402,19 +901,11 @@ static void visit_MethodCall(struct Compiler *const compiler, const struct Node
 	if (index != S_UNKNOWN_STR) {
 		bb_add_byte(compiler->buffer, INIT_MC_SPECIAL);
 		bb_add_byte(compiler->buffer, index);
+		add_mc_cache(compiler);
 	} else {
-		struct YASL_Object value = table_search_string_int(compiler->strings, node->value.sval.str, node->value.sval.str_len);
-		if (value.type == Y_END) {
-			YASL_COMPILE_DEBUG_LOG("%s\n", "caching string");
-			table_insert_string_int(compiler->strings, node->value.sval.str, node->value.sval.str_len, compiler->header->count);
-			bb_intbytes8(compiler->header, node->value.sval.str_len);
-			bb_append(compiler->header, (unsigned char *) node->value.sval.str, node->value.sval.str_len);
-		}
-
-		value = table_search_string_int(compiler->strings, node->value.sval.str, node->value.sval.str_len);
-
 		bb_add_byte(compiler->buffer, INIT_MC);
-		bb_intbytes8(compiler->buffer, value.value.ival);
+		bb_intbytes8(compiler->buffer, add_string_constant(compiler, node->value.sval.str, node->value.sval.str_len));
+		add_mc_cache(compiler);
 	}
 
 	visit_Body(compiler, Call_get_params(node));
@@ -423,6 +914,7 @@ static void visit_MethodCall(struct Compiler *const compiler, const struct Node
 
 static void visit_Return(struct Compiler *const compiler, const struct Node *const node) {
 	YASL_COMPILE_DEBUG_LOG("Visit Return: %s\n", node->value.sval.str);
+	propagate_constants(compiler, Return_get_expr(node));
 	visit(compiler, Return_get_expr(node));
 	bb_add_byte(compiler->buffer, RET);
 }
@@ -544,6 +1036,7 @@ static void visit_TableComp(struct Compiler *const compiler, const struct Node *
 }
 
 static void visit_ForIter(struct Compiler *const compiler, const struct Node *const node) {
+	propagate_constants(compiler, node->children[0]->children[1]);
 	enter_scope(compiler);
 
 	visit(compiler, node->children[0]->children[1]);
@@ -579,6 +1072,7 @@ static void visit_ForIter(struct Compiler *const compiler, const struct Node *co
 }
 
 static void visit_While(struct Compiler *const compiler, const struct Node *const node) {
+	const size_t start = compiler->buffer->count;
 	int64_t index_start = compiler->buffer->count;
 
 	if (node->children[2] != NULL) {
@@ -592,12 +1086,21 @@ static void visit_While(struct Compiler *const compiler, const struct Node *cons
 
 	add_checkpoint(compiler, index_start);
 
-	visit(compiler, While_get_cond(node));
-
-	add_checkpoint(compiler, compiler->buffer->count);
+	propagate_constants(compiler, While_get_cond(node));
 
+	// `break` jumps back to the conditional branch with false on the stack, so it needs the stack form.
 	int64_t index_second;
-	enter_conditional_false(compiler, &index_second);
+	if (!contains_break(While_get_body(node)) &&
+	    (reg_conditional_false(compiler, While_get_cond(node), &index_second) ||
+	     fused_conditional_false(compiler, While_get_cond(node), &index_second))) {
+		add_checkpoint(compiler, index_second);
+	} else {
+		visit(compiler, While_get_cond(node));
+
+		add_checkpoint(compiler, compiler->buffer->count);
+
+		enter_conditional_false(compiler, &index_second);
+	}
 	enter_scope(compiler);
 
 	visit(compiler, While_get_body(node));
@@ -609,6 +1112,11 @@ static void visit_While(struct Compiler *const compiler, const struct Node *cons
 
 	rm_checkpoint(compiler);
 	rm_checkpoint(compiler);
+
+	// a loop that never runs is still compiled, for its errors, but then dropped.
+	if (is_constant_condition(compiler, While_get_cond(node)) && is_falsey_literal(While_get_cond(node))) {
+		compiler->buffer->count = start;
+	}
 }
 
 static void visit_Break(struct Compiler *const compiler, const struct Node *const node) {
@@ -631,10 +1139,20 @@ static void visit_Continue(struct Compiler *const compiler, const struct Node *c
 }
 
 static void visit_If(struct Compiler *const compiler, const struct Node *const node) {
-	visit(compiler, node->children[0]);
+	propagate_constants(compiler, node->children[0]);
+	if (is_constant_condition(compiler, node->children[0])) {
+		const int taken = !is_falsey_literal(node->children[0]);
+		visit_branch(compiler, node->children[1], taken);
+		if (node->children[2] != NULL) visit_branch(compiler, node->children[2], !taken);
+		return;
+	}
 
 	int64_t index_then;
-	enter_conditional_false(compiler, &index_then);
+	if (!reg_conditional_false(compiler, node->children[0], &index_then) &&
+	    !fused_conditional_false(compiler, node->children[0], &index_then)) {
+		visit(compiler, node->children[0]);
+		enter_conditional_false(compiler, &index_then);
+	}
 	enter_scope(compiler);
 
 	visit(compiler, node->children[1]);
@@ -659,6 +1177,7 @@ static void visit_If(struct Compiler *const compiler, const struct Node *const n
 }
 
 static void visit_Print(struct Compiler *const compiler, const struct Node *const node) {
+	propagate_constants(compiler, Print_get_expr(node));
 	visit(compiler, Print_get_expr(node));
 	bb_add_byte(compiler->buffer, PRINT);
 }
@@ -671,6 +1190,12 @@ static void declare_with_let_or_const(struct Compiler *const compiler, const str
 	}
 
 	decl_var(compiler, node->value.sval.str, node->value.sval.str_len, node->line);
+	propagate_constants(compiler, Let_get_expr(node));
+
+	if (Let_get_expr(node) != NULL &&
+	    reg_assign(compiler, node->value.sval.str, node->value.sval.str_len, Let_get_expr(node))) {
+		return;
+	}
 
 	if (Let_get_expr(node) != NULL) visit(compiler, Let_get_expr(node));
 	else bb_add_byte(compiler->buffer, NCONST);
@@ -685,6 +1210,16 @@ static void visit_Let(struct Compiler *const compiler, const struct Node *const
 static void visit_Const(struct Compiler *const compiler, const struct Node *const node) {
 	declare_with_let_or_const(compiler, node);
 	make_const(compiler, node->value.sval.str, node->value.sval.str_len);
+
+	const struct Node *const expr = Const_get_expr(node);
+	if (compiler->status != YASL_SUCCESS) return;
+	Env_t *env = compiler->params != NULL ? compiler->params : compiler->globals;
+	if ((compiler->options & YASL_OPT_CONSTANTS) && (expr == NULL || is_literal(expr))) {
+		env_set_const_value(env, node->value.sval.str, node->value.sval.str_len,
+				    expr != NULL ? node_clone(expr) : new_Undef(node->line));
+	} else if ((compiler->options & YASL_OPT_INLINE) && expr != NULL && expr->nodetype == N_FNDECL && is_inlinable(expr)) {
+		env_set_const_value(env, node->value.sval.str, node->value.sval.str_len, node_clone(expr));
+	}
 }
 
 static void visit_TriOp(struct Compiler *const compiler, const struct Node *const node) {
@@ -739,6 +1274,7 @@ static void visit_BinOp(struct Compiler *const compiler, const struct Node *cons
 		exit_conditional_false(compiler, &index);
 		return;
 	}
+	if (fused_add(compiler, node)) return;
 	// all other operators follow the same pattern of visiting one child then the other.
 	visit(compiler, node->children[0]);
 	visit(compiler, node->children[1]);
@@ -844,13 +1380,7 @@ static void visit_UnOp(struct Compiler *const compiler, const struct Node *const
 }
 
 static void visit_Assign(struct Compiler *const compiler, const struct Node *const node) {
-	if (!contains_var(compiler, node->value.sval.str, node->value.sval.str_len)) {
-		YASL_PRINT_ERROR_UNDECLARED_VAR(node->value.sval.str, node->line);
-		handle_error(compiler);
-		return;
-	}
-	visit(compiler, Assign_get_expr(node));
-	store_var(compiler, node->value.sval.str, node->value.sval.str_len, node->line);
+	if (!assign_var(compiler, node)) return;
 	load_var(compiler, node->value.sval.str, node->value.sval.str_len, node->line);
 }
 
@@ -905,11 +1435,13 @@ static void visit_Integer(struct Compiler *const compiler, const struct Node *co
 	case 5:
 		bb_add_byte(compiler->buffer, ICONST_5);
 		break;
-	default:
-		bb_add_byte(compiler->buffer, ICONST);
-		bb_intbytes8(compiler->buffer, val);
+	default: {
+		const size_t width = int_width(val);
+		bb_add_byte(compiler->buffer, width == 1 ? ICONST_B1 : width == 2 ? ICONST_B2 : width == 4 ? ICONST_B4 : ICONST);
+		bb_intbytes(compiler->buffer, val, width);
 		break;
 	}
+	}
 }
 
 static void visit_Boolean(struct Compiler *const compiler, const struct Node *const node) {
@@ -917,38 +1449,44 @@ static void visit_Boolean(struct Compiler *const compiler, const struct Node *co
 }
 
 static void visit_String(struct Compiler *const compiler, const struct Node *const node) {
-	struct YASL_Object value = table_search_string_int(compiler->strings, node->value.sval.str, node->value.sval.str_len);
-	if (value.type == Y_END) {
-		YASL_COMPILE_DEBUG_LOG("%s\n", "caching string");
-		table_insert_string_int(compiler->strings, node->value.sval.str, node->value.sval.str_len, compiler->header->count);
-		bb_intbytes8(compiler->header, node->value.sval.str_len);
-		bb_append(compiler->header, (unsigned char *) node->value.sval.str, node->value.sval.str_len);
-	}
-
-	value = table_search_string_int(compiler->strings, node->value.sval.str, node->value.sval.str_len);
-
 	enum SpecialStrings index = get_special_string(node);
 	if (index != S_UNKNOWN_STR) {
 		bb_add_byte(compiler->buffer, NEWSPECIALSTR);
 		bb_add_byte(compiler->buffer, index);
 	} else {
-		bb_add_byte(compiler->buffer, NEWSTR);
-		bb_intbytes8(compiler->buffer, value.value.ival);
+		const yasl_int addr = add_string_constant(compiler, node->value.sval.str, node->value.sval.str_len);
+		if (addr <= UINT8_MAX) {
+			bb_add_byte(compiler->buffer, NEWSTR_1);
+			bb_add_byte(compiler->buffer, (unsigned char) addr);
+		} else if (addr <= UINT16_MAX) {
+			const uint16_t addr16 = (uint16_t) addr;
+			bb_add_byte(compiler->buffer, NEWSTR_2);
+			bb_append(compiler->buffer, (unsigned char *) &addr16, sizeof(addr16));
+		} else {
+			bb_add_byte(compiler->buffer, NEWSTR);
+			bb_intbytes8(compiler->buffer, addr);
+		}
 	}
 }
 
-static void make_new_collection(struct Compiler *const compiler, const struct Node *const node, enum Opcode type) {
-	bb_add_byte(compiler->buffer, END);
-	visit_Body(compiler, node);
-	bb_add_byte(compiler->buffer, type);
+// pushes the values of a list or table literal, then opcode and the number of items, each of which is width values.
+static void make_new_collection(struct Compiler *const compiler, const struct Node *const node, enum Opcode opcode,
+				const yasl_int width) {
+	yasl_int count = 0;
+	FOR_CHILDREN(i, child, node) {
+		visit(compiler, child);
+		count++;
+	}
+	bb_add_byte(compiler->buffer, opcode);
+	bb_intbytes8(compiler->buffer, count / width);
 }
 
 static void visit_List(struct Compiler *const compiler, const struct Node *const node) {
-	make_new_collection(compiler, List_get_values(node), NEWLIST);
+	make_new_collection(compiler, List_get_values(node), NEWLIST_N, 1);
 }
 
 static void visit_Table(struct Compiler *const compiler, const struct Node *const node) {
-	make_new_collection(compiler, Table_get_values(node), NEWTABLE);
+	make_new_collection(compiler, Table_get_values(node), NEWTABLE_N, 2);
 }
 
 // NOTE: _MUST_ keep this synced with the enum in ast.h, and the jumptable in middleend.c
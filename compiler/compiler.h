@@ -7,6 +7,11 @@
 #include "opcode.h"
 #include "env.h"
 #include "debug.h"
+#include "yasl_options.h"
+
+#define HEADER_SIZE 24             // [entry point][num globals][address of string pool]
+#define MAX_VARS 65536             // most globals, or locals in one function, that wide loads and stores can address
+#define MAX_INLINE_NODES 16        // largest returned expression, in AST nodes, of a function that calls can be inlined
 
 #define NEW_COMPILER(fp)\
 ((struct Compiler) {\
@@ -15,12 +20,16 @@
 	.params = NULL,\
 	.strings = table_new(),\
 	.buffer = bb_new(16),\
-	.header = bb_new(16),\
+	.header = bb_new(HEADER_SIZE),\
+	.string_pool = bb_new(16),\
 	.status = YASL_SUCCESS,\
 	.checkpoints_size = 4,\
 	.checkpoints = malloc(sizeof(size_t) * 4),\
 	.checkpoints_count = 0,\
-	.code = bb_new(16)\
+	.code = bb_new(16),\
+	.options = YASL_OPT_DEFAULT,\
+	.num_globals = 0,\
+	.num_locals = 0\
 })
 
 struct Compiler {
@@ -30,15 +39,21 @@ struct Compiler {
     struct Table *strings;
     ByteBuffer *buffer;
     ByteBuffer *header;
+    ByteBuffer *string_pool;       // [len][bytes] of each string constant, in the order of their indices
     ByteBuffer *code;
     size_t *checkpoints;
     size_t checkpoints_count;
     size_t checkpoints_size;
     int status;
+    int options;                   // YASL_Option flags
+    size_t num_globals;            // most globals in scope at once, which is how many slots the code needs
+    size_t num_locals;             // same, for locals of the function being compiled, params included
 };
 
 struct Compiler *compiler_new(FILE *fp);
 struct Compiler *compiler_new_bb(char *buf, int len);
 void compiler_cleanup(struct Compiler *compiler);
+size_t bytecode_size(const struct Compiler *const compiler);
+size_t compiler_num_globals(const struct Compiler *const compiler);
 unsigned char *compile(struct Compiler *const compiler);
 unsigned char *compile_REPL(struct Compiler *const compiler);
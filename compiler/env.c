@@ -7,6 +7,7 @@ Env_t *env_new(Env_t *parent) {
 	Env_t *env = malloc(sizeof(Env_t));
 	env->parent = parent;
 	env->vars = table_new();
+	env->consts = NULL;
 	return env;
 }
 
@@ -18,15 +19,13 @@ void env_del(Env_t *env) {
 }
 
 void env_del_current_only(Env_t *env) {
-	for (size_t i = 0; i < env->vars->size; i++) {
-		Item_t *item = &env->vars->items[i];
-		if (item->key.type != Y_END && item->key.type != Y_UNDEF) {
-			str_del(item->key.value.sval);
-			// free(item);
+	if (env->consts != NULL) {
+		FOR_TABLE(i, item, env->consts) {
+			node_del(YASL_GETUSERPTR(item->value));
 		}
+		table_del(env->consts);
 	}
-	free(env->vars->items);
-	free(env->vars);
+	table_del(env->vars);
 	free(env);
 }
 
@@ -40,8 +39,8 @@ int env_contains_cur_scope(Env_t *env, char *name, size_t name_len) {
 	struct YASL_Object key = YASL_STR(string); // (struct YASL_Object) { .value.sval = string, .type = Y_STR };
 
 	struct YASL_Object value = table_search(env->vars, key);
-	str_del(key.value.sval);
-	if (value.type == Y_END) {
+	str_del(YASL_GETSTR(key));
+	if (YASL_GETTYPE(value) == Y_END) {
 		return 0;
 	}
 	return 1;
@@ -53,11 +52,11 @@ int env_contains(Env_t *env, char *name, size_t name_len) {
 	struct YASL_Object key = YASL_STR(string);
 
 	struct YASL_Object value = table_search(env->vars, key);
-	str_del(key.value.sval);
-	if (value.type == Y_END && env->parent == NULL) {
+	str_del(YASL_GETSTR(key));
+	if (YASL_GETTYPE(value) == Y_END && env->parent == NULL) {
 		return 0;
 	}
-	if (value.type == Y_END) return env_contains(env->parent, name, name_len);
+	if (YASL_GETTYPE(value) == Y_END) return env_contains(env->parent, name, name_len);
 	return 1;
 }
 
@@ -66,14 +65,14 @@ int64_t env_get(Env_t *env, char *name, size_t name_len) {
 	struct YASL_Object key = YASL_STR(string);
 
 	struct YASL_Object value = table_search(env->vars, key);
-	str_del(key.value.sval);
-	if (value.type == Y_END && env->parent == NULL) {
+	str_del(YASL_GETSTR(key));
+	if (YASL_GETTYPE(value) == Y_END && env->parent == NULL) {
 		printf("error in env_get with key: ");
 		print(key);
 		exit(EXIT_FAILURE);
 	}
-	if (value.type == Y_END) return env_get(env->parent, name, name_len);
-	return value.value.ival;
+	if (YASL_GETTYPE(value) == Y_END) return env_get(env->parent, name, name_len);
+	return YASL_GETINT(value);
 }
 
 int64_t env_decl_var(Env_t *env, char *name, size_t name_len) {
@@ -86,10 +85,33 @@ int64_t env_decl_var(Env_t *env, char *name, size_t name_len) {
 
 static struct Table *get_closest_scope_with_var(Env_t *env, char *name, size_t name_len) {
 	struct YASL_Object key = table_search_string_int(env->vars, name, name_len);
-	return key.type != Y_END ? env->vars : get_closest_scope_with_var(env->parent, name, name_len);
+	return YASL_GETTYPE(key) != Y_END ? env->vars : get_closest_scope_with_var(env->parent, name, name_len);
 }
 
 void env_make_const(Env_t *env, char *name, size_t name_len) {
 	struct Table *ht = get_closest_scope_with_var(env, name, name_len);
-	table_insert_string_int(ht, name, name_len, ~table_search_string_int(ht, name, name_len).value.ival);
+	table_insert_string_int(ht, name, name_len, ~YASL_GETINT(table_search_string_int(ht, name, name_len)));
+}
+
+/*
+ * Records the literal value of the constant name (taking ownership of value), in the closest scope that declares it.
+ */
+void env_set_const_value(Env_t *env, char *name, size_t name_len, struct Node *value /* OWN */) {
+	while (YASL_ISEND(table_search_string_int(env->vars, name, name_len))) env = env->parent;
+	if (env->consts == NULL) env->consts = table_new();
+	String_t *string = str_new_sized_heap(0, name_len, copy_char_buffer(name_len, name));
+	table_insert(env->consts, YASL_STR(string), YASL_USERPTR(value));
+}
+
+/*
+ * Returns the literal value of name, if the closest scope that declares it has one for it, or NULL otherwise.
+ */
+const struct Node *env_get_const_value(Env_t *env, char *name, size_t name_len) {
+	for (; env != NULL; env = env->parent) {
+		if (YASL_ISEND(table_search_string_int(env->vars, name, name_len))) continue;
+		if (env->consts == NULL) return NULL;
+		struct YASL_Object value = table_search_string_int(env->consts, name, name_len);
+		return YASL_ISUSERPTR(value) ? YASL_GETUSERPTR(value) : NULL;
+	}
+	return NULL;
 }
@@ -3,11 +3,13 @@
 //
 #include "hashtable/hashtable.h"
 #include "interpreter/YASL_string.h"
+#include "compiler/ast.h"
 #include <string.h>
 
 struct Env_s {
     struct Env_s *parent;
     struct Table *vars;
+    struct Table *consts;          // literal values of constants declared in this scope, as nodes it owns, or NULL
 };
 
 typedef struct Env_s Env_t;
@@ -22,3 +24,5 @@ int env_contains(Env_t *env, char *name, size_t name_len);
 int64_t env_get(Env_t *env, char *name, size_t name_len);
 int64_t env_decl_var(Env_t *env, char *name, size_t name_len);
 void env_make_const(Env_t *env, char *name, size_t name_len);
+void env_set_const_value(Env_t *env, char *name, size_t name_len, struct Node *value);
+const struct Node *env_get_const_value(Env_t *env, char *name, size_t name_len);
@@ -52,10 +52,58 @@ void fold_TableComp(struct Node *const node) {
 	}
 }
 
+int is_literal(const struct Node *const node) {
+	switch (node->nodetype) {
+	case N_UNDEF:
+	case N_FLOAT:
+	case N_INT:
+	case N_BOOL:
+	case N_STR:
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+// whether the literal node is falsey, as isfalsey in interpreter/YASL_Object.c.
+int is_falsey_literal(const struct Node *const node) {
+	switch (node->nodetype) {
+	case N_UNDEF:
+		return 1;
+	case N_BOOL:
+		return !node->value.ival;
+	case N_STR:
+		return node->value.sval.str_len == 0;
+	case N_FLOAT:
+		return node->value.dval != node->value.dval;
+	default:
+		return 0;
+	}
+}
+
+/*
+ * Replaces node by its ith child, and deletes the others. Nodes are allocated for the number of children they have,
+ * so this leaves node as it is, and returns 0, if the child has more children than node does.
+ */
+static int replace_with_child(struct Node *const node, const size_t i) {
+	struct Node *const kept = node->children[i];
+	if (kept->children_len > node->children_len) return 0;
+	node->children[i] = NULL;
+	FOR_CHILDREN(j, child, node) {
+		node_del(child);
+	}
+	memcpy(node, kept, sizeof(struct Node) + kept->children_len * sizeof(struct Node *));
+	free(kept);
+	return 1;
+}
+
 void fold_TriOp(struct Node *const node) {
 	FOR_CHILDREN(i, child, node) {
 		fold(child);
 	}
+	if (is_literal(node->children[0])) {
+		replace_with_child(node, is_falsey_literal(node->children[0]) ? 2 : 1);
+	}
 }
 
 void make_float(struct Node *const node, double val) {
@@ -64,6 +112,13 @@ void make_float(struct Node *const node, double val) {
 	node->children_len = 0;
 }
 
+void make_str(struct Node *const node, char *str /* OWN */, size_t len) {
+	node->nodetype = N_STR;
+	node->value.sval.str = str;
+	node->value.sval.str_len = len;
+	node->children_len = 0;
+}
+
 void make_int(struct Node *const node, yasl_int val) {
 	node->nodetype = N_INT;
 	node->value.ival = val;
@@ -76,12 +131,41 @@ void make_bool(struct Node *const node, int val) {
 	node->children_len = 0;
 }
 
+// ??, || and &&, whose left operand decides which operand they evaluate to.
+static void fold_short_circuit(struct Node *const node) {
+	const struct Node *left = node->children[0];
+	if (!is_literal(left)) return;
+	int keep_left;
+	switch (node->type) {
+	case T_DQMARK:
+		keep_left = left->nodetype != N_UNDEF;
+		break;
+	case T_DBAR:
+		keep_left = !is_falsey_literal(left);
+		break;
+	default:
+		keep_left = is_falsey_literal(left);
+		break;
+	}
+	replace_with_child(node, keep_left ? 0 : 1);
+}
+
 void fold_BinOp(struct Node *const node) {
 	fold(node->children[0]);
 	fold(node->children[1]);
 	struct Node *left = node->children[0];
 	struct Node *right = node->children[1];
-	if (left->nodetype == N_INT && right->nodetype == N_INT) {
+	if (node->type == T_DQMARK || node->type == T_DBAR || node->type == T_DAMP) {
+		fold_short_circuit(node);
+	} else if (node->type == T_TILDE && left->nodetype == N_STR && right->nodetype == N_STR) {
+		const size_t len = left->value.sval.str_len + right->value.sval.str_len;
+		char *str = malloc(len);
+		memcpy(str, left->value.sval.str, left->value.sval.str_len);
+		memcpy(str + left->value.sval.str_len, right->value.sval.str, right->value.sval.str_len);
+		make_str(node, str, len);
+		node_del(left);
+		node_del(right);
+	} else if (left->nodetype == N_INT && right->nodetype == N_INT) {
 		switch (node->type) {
 		case T_BAR:
 			make_int(node, left->value.ival | right->value.ival);
@@ -402,6 +486,14 @@ void fold_BinOp(struct Node *const node) {
 	}
 }
 
+// whether the list node has only literals in it, so that evaluating it has no effect.
+static int is_literal_list(const struct Node *const node) {
+	FOR_CHILDREN(i, child, List_get_values(node)) {
+		if (!is_literal(child)) return 0;
+	}
+	return 1;
+}
+
 void fold_UnOp(struct Node *const node) {
 	fold(UnOp_get_expr(node));
 	struct Node *expr = UnOp_get_expr(node);
@@ -449,13 +541,39 @@ void fold_UnOp(struct Node *const node) {
 			node_del(expr);
 			break;
 		case T_BANG:
-			make_bool(node, 0);
+			make_bool(node, expr->value.dval != expr->value.dval);
 			node_del(expr);
 			break;
 		default:
 			break;
 		}
 		break;
+	case N_STR:
+		switch (node->type) {
+		case T_BANG:
+			make_bool(node, expr->value.sval.str_len == 0);
+			node_del(expr);
+			break;
+		case T_LEN:
+			make_int(node, (yasl_int) expr->value.sval.str_len);
+			node_del(expr);
+			break;
+		default:
+			break;
+		}
+		break;
+	case N_UNDEF:
+		if (node->type == T_BANG) {
+			make_bool(node, 1);
+			node_del(expr);
+		}
+		break;
+	case N_LIST:
+		if (node->type == T_LEN && is_literal_list(expr)) {
+			make_int(node, (yasl_int) List_get_values(expr)->children_len);
+			node_del(expr);
+		}
+		break;
 	default:
 		break;
 	}
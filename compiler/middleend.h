@@ -1,3 +1,5 @@
 #include "compiler/ast.h"
 
 void fold(struct Node *const node);
+int is_literal(const struct Node *const node);
+int is_falsey_literal(const struct Node *const node);
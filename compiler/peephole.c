@@ -0,0 +1,263 @@
+#include "peephole.h"
+
+#include <string.h>
+
+/*
+ * Peephole optimizer (YASL_OPT_PEEPHOLE), run over the code of each top level statement and each function once it has
+ * been compiled. It rewrites short sequences of instructions that the compiler emits for common constructs, such as
+ * the `false` pushed by break, or the `true` tested by `while true`, into fewer instructions, and then removes whatever
+ * can no longer be reached. The rewrites are repeated until none apply, since each can expose others.
+ *
+ * Instructions that are jumped to start a new sequence: a rewrite may only remove or change an instruction other than
+ * the first of the sequence if nothing jumps to it.
+ */
+
+// index of the first instruction from k on that hasn't been deleted, or code->count if there is none.
+static size_t next_live(const struct Code *const code, size_t k) {
+	while (k < code->count && !code->instrs[k].length) k++;
+	return k;
+}
+
+static void delete(struct Instruction *const instr) {
+	instr->length = 0;
+	instr->branch = BRANCH_NONE;
+}
+
+// deletes the instruction at k, in the middle of a rewrite: jumps to it now land on the next instruction.
+static void delete_at(const struct Code *const code, unsigned char *const is_target, const size_t k) {
+	delete(code->instrs + k);
+	if (is_target[k]) is_target[next_live(code, k + 1)] = 1;
+}
+
+static void make_branch(struct Instruction *const instr, const unsigned char opcode, const size_t target) {
+	instr->opcode = opcode;
+	instr->branch = BRANCH_STACK;
+	instr->target = target;
+	instr->length = 1 + sizeof(yasl_int);
+}
+
+static int is_store(const unsigned char opcode) {
+	switch (opcode) {
+	case GSTORE_1:
+	case GSTORE_2:
+	case LSTORE_1:
+	case LSTORE_2:
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+// whether the instruction pushes one value and has no other effect, so that it can be dropped along with a POP after it.
+static int is_pure_push(const unsigned char opcode) {
+	switch (opcode) {
+	case NCONST:
+	case BCONST_F:
+	case BCONST_T:
+	case FCONST:
+	case ICONST_B1:
+	case ICONST_B2:
+	case ICONST_B4:
+	case ICONST:
+	case ICONST_M1:
+	case ICONST_0:
+	case ICONST_1:
+	case ICONST_2:
+	case ICONST_3:
+	case ICONST_4:
+	case ICONST_5:
+	case DCONST:
+	case DCONST_0:
+	case DCONST_1:
+	case DCONST_2:
+	case DCONST_N:
+	case DCONST_I:
+	case NEWSTR_1:
+	case NEWSTR_2:
+	case NEWSPECIALSTR:
+	case NEWSTR:
+	case DUP:
+	case GLOAD_1:
+	case GLOAD_2:
+	case LLOAD_1:
+	case LLOAD_2:
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+/*
+ * Where the conditional branch at k sends a value whose truthiness is known: to its target if it is taken, and to the
+ * next instruction otherwise. Returns code->count + 1 if it can't tell.
+ */
+static size_t branch_destination(const struct Code *const code, const size_t k, const int truthy, const int undef) {
+	const struct Instruction *const instr = code->instrs + k;
+	int taken;
+	switch (instr->opcode) {
+	case BRF_8:
+		taken = !truthy;
+		break;
+	case BRT_8:
+		taken = truthy;
+		break;
+	case BRN_8:
+		taken = !undef;
+		break;
+	default:
+		return code->count + 1;
+	}
+	return taken ? instr->target : next_live(code, k + 1);
+}
+
+// jumps to a branch are sent on to where it goes, and jumps to deleted instructions to the next one that isn't.
+static int thread_jumps(struct Code *const code) {
+	int changed = 0;
+	for (size_t k = 0; k < code->count; k++) {
+		struct Instruction *const instr = code->instrs + k;
+		if (instr->branch == BRANCH_NONE) continue;
+		size_t target = next_live(code, instr->target);
+		size_t hops = 0;
+		while (target < code->count && code->instrs[target].branch == BRANCH_STACK &&
+		       code->instrs[target].opcode == BR_8 && hops++ < code->count) {
+			target = next_live(code, code->instrs[target].target);
+		}
+		// branches that only lead to each other, as in `while true {}`, are left alone.
+		if (hops > code->count) continue;
+		if (target != instr->target) {
+			instr->target = target;
+			changed = 1;
+		}
+	}
+	return changed;
+}
+
+/*
+ * Removes the instructions that can't be reached from the first one. Only RET and BR_8 don't go on to the next
+ * instruction.
+ */
+static int remove_dead_code(struct Code *const code) {
+	unsigned char *reached = calloc(code->count + 1, 1);
+	size_t *stack = malloc(sizeof(size_t) * (2 * code->count + 1));
+	size_t top = 0;
+	stack[top++] = next_live(code, 0);
+	while (top) {
+		const size_t k = stack[--top];
+		if (k >= code->count || reached[k]) continue;
+		reached[k] = 1;
+		const struct Instruction *const instr = code->instrs + k;
+		if (instr->branch != BRANCH_NONE) stack[top++] = instr->target;
+		if (instr->opcode == RET || (instr->branch == BRANCH_STACK && instr->opcode == BR_8)) continue;
+		stack[top++] = next_live(code, k + 1);
+	}
+
+	int changed = 0;
+	for (size_t k = 0; k < code->count; k++) {
+		if (code->instrs[k].length && !reached[k]) {
+			delete(code->instrs + k);
+			changed = 1;
+		}
+	}
+	free(reached);
+	free(stack);
+	return changed;
+}
+
+static int rewrite(struct Code *const code, unsigned char *const is_target) {
+	struct Instruction *const instrs = code->instrs;
+	const size_t count = code->count;
+	int changed = 0;
+	for (size_t k = next_live(code, 0); k < count; k = next_live(code, k + 1)) {
+		struct Instruction *const instr = instrs + k;
+		const size_t next = next_live(code, k + 1);
+
+		// branches to the next instruction.
+		if (instr->branch == BRANCH_STACK && next_live(code, instr->target) == next) {
+			if (instr->opcode == BR_8) {
+				delete_at(code, is_target, k);
+			} else {
+				instr->opcode = POP;
+				instr->branch = BRANCH_NONE;
+				instr->length = 1;
+			}
+			changed = 1;
+			continue;
+		}
+
+		if (next >= count) break;
+		const size_t after = next_live(code, next + 1);
+
+		// a constant that is only tested, as in `while true`, or in the false that break jumps back to the loop
+		// condition with, becomes a jump to wherever the test sends it.
+		if ((instr->opcode == BCONST_F || instr->opcode == BCONST_T || instr->opcode == NCONST) && !is_target[next]) {
+			size_t test = next;
+			if (instrs[test].branch == BRANCH_STACK && instrs[test].opcode == BR_8) test = next_live(code, instrs[test].target);
+			const size_t dest = test < count ?
+				branch_destination(code, test, instr->opcode == BCONST_T, instr->opcode == NCONST) : count + 1;
+			if (dest <= count) {
+				make_branch(instr, BR_8, dest);
+				is_target[dest] = 1;
+				changed = 1;
+				continue;
+			}
+		}
+
+		// NOT; BRF becomes BRT, and NOT; BRT becomes BRF, since branches test the truthiness of any value.
+		if (instr->opcode == NOT && !is_target[next] && instrs[next].branch == BRANCH_STACK &&
+		    (instrs[next].opcode == BRF_8 || instrs[next].opcode == BRT_8)) {
+			instrs[next].opcode = instrs[next].opcode == BRF_8 ? BRT_8 : BRF_8;
+			delete_at(code, is_target, k);
+			changed = 1;
+			continue;
+		}
+
+		if (instr->opcode == DUP && after < count && !is_target[next] && !is_target[after] && instrs[after].opcode == POP) {
+			// DUP; store; POP is just the store.
+			if (is_store(instrs[next].opcode)) {
+				delete_at(code, is_target, k);
+				delete_at(code, is_target, after);
+				changed = 1;
+				continue;
+			}
+			// DUP; BRF L; POP, as emitted for `a && b`, where L tests the same value again, as it does when `a && b`
+			// is itself a condition, becomes a single branch to wherever the test at L sends the value. The same goes
+			// for `a || b` and BRT.
+			if (instrs[next].branch == BRANCH_STACK && (instrs[next].opcode == BRF_8 || instrs[next].opcode == BRT_8)) {
+				const size_t test = next_live(code, instrs[next].target);
+				const size_t dest = test < count ? branch_destination(code, test, instrs[next].opcode == BRT_8, 0) : count + 1;
+				if (dest <= count) {
+					instrs[next].target = dest;
+					is_target[dest] = 1;
+					delete_at(code, is_target, k);
+					delete_at(code, is_target, after);
+					changed = 1;
+					continue;
+				}
+			}
+		}
+
+		// a value that is pushed only to be popped.
+		if (is_pure_push(instr->opcode) && !is_target[next] && instrs[next].opcode == POP) {
+			delete_at(code, is_target, k);
+			delete_at(code, is_target, next);
+			changed = 1;
+			continue;
+		}
+	}
+	return changed;
+}
+
+void peephole(struct Code *const code) {
+	unsigned char *is_target = malloc(code->count + 1);
+	int changed = 1;
+	while (changed) {
+		changed = thread_jumps(code);
+		memset(is_target, 0, code->count + 1);
+		for (size_t k = 0; k < code->count; k++) {
+			if (code->instrs[k].branch != BRANCH_NONE) is_target[code->instrs[k].target] = 1;
+		}
+		changed |= rewrite(code, is_target);
+		changed |= remove_dead_code(code);
+	}
+	free(is_target);
+}
@@ -0,0 +1,5 @@
+#pragma once
+
+#include "bytecode.h"
+
+void peephole(struct Code *const code);
@@ -10,23 +10,90 @@
 //#include "YASL_Object.h"
 //#include "YASL_string.h"
 #include "interpreter/refcount.h"
+#include "interpreter/collector.h"
+#include "slab/slab.h"
 
-#define HT_BASESIZE 30
+/*
+ * Interned strings are shared, so the same pointer means the same key. Otherwise, strings with different cached
+ * hashes can't be equal, and only strings that collide on the hash need their contents compared.
+ */
+int keys_equal(const struct YASL_Object a, const struct YASL_Object b) {
+	if (YASL_ISSTR(a) && YASL_ISSTR(b)) {
+		if (YASL_GETSTR(a) == YASL_GETSTR(b)) return 1;
+		if (str_hash(YASL_GETSTR(a)) != str_hash(YASL_GETSTR(b))) return 0;
+	}
+	return !isfalsey(isequal(a, b));
+}
+
+void del_item(Item_t *item) {
+	dec_ref(&item->key);
+	dec_ref(&item->value);
+}
+
+struct Table *table_new(void) {
+	return table_new_sized(HT_BASESIZE);
+}
+
+struct RC_UserData *rcht_new_sized(struct Collector *gc, const int base_size) {
+        struct RC_UserData *ht = slab_alloc(sizeof(struct RC_UserData));
+        ht->data = table_new_sized(base_size);
+        ht->rc = NEW_RC();
+        ht->color = GC_BLACK;
+        ht->buffered = 0;
+        ht->gc = gc;
+        ht->tag = T_TABLE;
+        ht->destructor = rcht_del_data;
+        return ht;
+}
+
+struct RC_UserData *rcht_new(struct Collector *gc) {
+	return rcht_new_sized(gc, HT_BASESIZE);
+}
+
+void rcht_del(struct RC_UserData *hashtable) {
+	table_del(hashtable->data);
+	slab_free(hashtable, sizeof(struct RC_UserData));
+}
+
+void rcht_del_data(void *hashtable) {
+        table_del(hashtable);
+}
+
+void rcht_del_rc(struct RC_UserData *hashtable) {
+	slab_free(hashtable, sizeof(struct RC_UserData));
+}
+
+void table_del_string_int(struct Table *table) {
+	table_del(table);
+}
+
+void table_insert_string_int(struct Table *table, char *key, int64_t key_len, int64_t val) {
+	String_t *string = str_new_sized_heap(0, key_len, copy_char_buffer(key_len, key));
+	table_insert(table,
+		     YASL_STR(string),
+		     YASL_INT(val));
+}
+
+struct YASL_Object table_search_string_int(const struct Table *const table, char *key, int64_t key_len) {
+	String_t *string = str_new_sized_heap(0, key_len, copy_char_buffer(key_len, key));
+	struct YASL_Object object = YASL_STR(string);
+
+	struct YASL_Object result = table_search(table, object);
+	str_del(string);
+	return result;
+}
+
+#if !YASL_SWISS_TABLE
 
 static int hash_function(const struct YASL_Object s, const int a, const int m) {
-	long hash = 0;
 	if (YASL_ISSTR(s)) {
-		const int64_t len_s = yasl_string_len(s.value.sval);
-		for (int i = 0; i < len_s; i++) {
-			hash = (hash * a) ^ (s.value.sval->str + s.value.sval->start)[i];
-			hash %= m;
-		}
-		return (int) hash;
+		const size_t hash = str_hash(YASL_GETSTR(s));
+		return (int) ((hash ^ (hash >> 32) * (size_t) a) % (size_t) m);
 	} else {
-		long ll = s.value.ival & 0xFFFF;
-		long lu = (s.value.ival & 0xFFFF0000) >> 16;
-		long ul = (s.value.ival & 0xFFFF00000000) >> 32;
-		long uu = (s.value.ival & 0xFFFF000000000000) >> 48;
+		long ll = YASL_GETINT(s) & 0xFFFF;
+		long lu = (YASL_GETINT(s) & 0xFFFF0000) >> 16;
+		long ul = (YASL_GETINT(s) & 0xFFFF00000000) >> 32;
+		long uu = (YASL_GETINT(s) & 0xFFFF000000000000) >> 48;
 		return (int) (((long) a * ll * ll * ll * ll ^ a * a * lu * lu * lu ^ a * a * a * ul * ul ^
 			       a * a * a * a * uu) % m);
 	}
@@ -48,82 +115,44 @@ static Item_t new_item(const struct YASL_Object k, const struct YASL_Object v) {
 	return item;
 }
 
-void del_item(Item_t *item) {
-	dec_ref(&item->key);
-	dec_ref(&item->value);
-}
-
 struct Table *table_new_sized(const int base_size) {
-	struct Table *table = malloc(sizeof(struct Table));
+	struct Table *table = slab_alloc(sizeof(struct Table));
 	table->base_size = base_size;
 	table->size = next_prime(table->base_size);
 	table->count = 0;
+	table->tombstones = 0;
 	table->items = calloc((size_t) table->size, sizeof(Item_t));
 	return table;
 }
 
-struct Table *table_new(void) {
-	return table_new_sized(HT_BASESIZE);
-}
-
 void table_del(struct Table *table) {
 	FOR_TABLE(i, item, table) {
 		del_item(item);
 	}
 	free(table->items);
-	free(table);
-}
-
-struct RC_UserData *rcht_new_sized(const int base_size) {
-        struct RC_UserData *ht = malloc(sizeof(struct RC_UserData));
-        ht->data = table_new_sized(base_size);
-        ht->rc = rc_new();
-        ht->tag = T_TABLE;
-        ht->destructor = rcht_del_data;
-        return ht;
-}
-
-struct RC_UserData *rcht_new() {
-	return rcht_new_sized(HT_BASESIZE);
-}
-
-void rcht_del(struct RC_UserData *hashtable) {
-	table_del(hashtable->data);
-	rc_del(hashtable->rc);
-	free(hashtable);
-}
-
-void rcht_del_data(void *hashtable) {
-        table_del(hashtable);
-}
-
-void rcht_del_rc(struct RC_UserData *hashtable) {
-	rc_del(hashtable->rc);
-	free(hashtable);
-}
-
-void table_del_string_int(struct Table *table) {
-	table_del(table);
+	slab_free(table, sizeof(struct Table));
 }
 
 static void table_resize(struct Table *table, const int base_size) {
 	if (base_size < HT_BASESIZE) return;
-	struct Table *new_table = table_new_sized(base_size);
-	FOR_TABLE(i, item, table) {
-		table_insert(new_table, item->key, item->value);
+	Item_t *old_items = table->items;
+	const size_t old_size = table->size;
+	table->base_size = base_size;
+	table->size = next_prime(table->base_size);
+	table->tombstones = 0;
+	table->items = calloc((size_t) table->size, sizeof(Item_t));
+	for (size_t i = 0; i < old_size; i++) {
+		if (YASL_ISEND(old_items[i].key) || YASL_ISUNDEF(old_items[i].key)) continue;
+		// items are moved, so their reference counts stay as they are. The new table has no tombstones, and none of
+		// its keys are equal, so each item goes in the first empty slot of its probe sequence.
+		int attempt = 0;
+		unsigned int index;
+		do {
+			index = get_hash(old_items[i].key, table->size, attempt++);
+		} while (!YASL_ISUNDEF(table->items[index].key));
+		table->items[index] = old_items[i];
 	}
-	table->base_size = new_table->base_size;
-	table->count = new_table->count;
-
-	const size_t tmp_size = table->size;
-	table->size = new_table->size;
-	new_table->size = tmp_size;
-
-	Item_t *tmp_items = table->items;
-	table->items = new_table->items;
-	new_table->items = tmp_items;
-
-	table_del(new_table);
+	free(old_items);
 }
 
 static void table_resize_up(struct Table *table) {
@@ -136,73 +165,97 @@ static void table_resize_down(struct Table *table) {
 	table_resize(table, new_size);
 }
 
+// rebuilds the table at its current size, which clears out its tombstones.
+static void table_rehash(struct Table *table) {
+	table_resize(table, table->base_size);
+}
+
+void table_reserve(struct Table *table, const size_t count) {
+	// keeps the load at or under 70% with count items, as table_insert does.
+	const size_t base_size = (count * 10 + 6) / 7;
+	if (base_size > table->base_size) table_resize(table, (int) base_size);
+}
+
 void table_insert(struct Table *table, const struct YASL_Object key, const struct YASL_Object value) {
-	const int load = table->count * 100 / table->size;
-	if (load > 70) table_resize_up(table);
+	// tombstones count towards the load, since only empty slots end a probe sequence.
+	const int load = (table->count + table->tombstones) * 100 / table->size;
+	if (load > 70) {
+		if (table->tombstones > table->count) table_rehash(table);
+		else table_resize_up(table);
+	}
 	Item_t item = new_item(key, value);
 	int index = get_hash(item.key, table->size, 0);
+	int free_index = -1;
 	Item_t curr_item = table->items[index];
 	int i = 1;
 	while (!YASL_ISUNDEF(curr_item.key)) {
-		if (curr_item.key.type != Y_END) {
-			if (!isfalsey(isequal(curr_item.key, item.key))) {
+		if (!YASL_ISEND(curr_item.key)) {
+			if (keys_equal(curr_item.key, item.key)) {
 				del_item(&curr_item);
 				table->items[index] = item;
 				return;
 			}
+		} else if (free_index < 0) {
+			free_index = index;
 		}
 		index = get_hash(item.key, table->size, i++);
 		curr_item = table->items[index];
 	}
+	if (free_index >= 0) {
+		index = free_index;
+		table->tombstones--;
+	}
 	table->items[index] = item;
 	table->count++;
 }
 
-void table_insert_string_int(struct Table *table, char *key, int64_t key_len, int64_t val) {
-	String_t *string = str_new_sized_heap(0, key_len, copy_char_buffer(key_len, key));
-	table_insert(table,
-		     (struct YASL_Object) {.type = Y_STR, .value.sval = string},
-		     (struct YASL_Object) {.type = Y_INT, .value.ival = val});
-}
-
 struct YASL_Object table_search(const struct Table *const table, const struct YASL_Object key) {
 	size_t index = get_hash(key, table->size, 0);
 	Item_t item = table->items[index];
 	int i = 1;
 	while (!YASL_ISUNDEF(item.key)) {
-		if (!isfalsey(isequal(item.key, key))) {
+		if (!YASL_ISEND(item.key) && keys_equal(item.key, key)) {
 			return item.value;
 		}
 		index = get_hash(key, table->size, i++);
 		item = table->items[index];
 	}
-	return (struct YASL_Object) {Y_END, {0}};
-}
-
-struct YASL_Object table_search_string_int(const struct Table *const table, char *key, int64_t key_len) {
-	String_t *string = str_new_sized_heap(0, key_len, copy_char_buffer(key_len, key));
-	struct YASL_Object object = (struct YASL_Object) {.value.sval = string, .type = Y_STR};
-
-	struct YASL_Object result = table_search(table, object);
-	str_del(string);
-	return result;
+	return YASL_END();
 }
 
 void table_rm(struct Table *table, struct YASL_Object key) {
-	const int load = table->count * 100 / table->size;
-	if (load < 10) table_resize_down(table);
 	int index = get_hash(key, table->size, 0);
 	Item_t item = table->items[index];
 	int i = 1;
 	while (!YASL_ISUNDEF(item.key)) {
-		if (item.key.type != Y_END) {
-			if (!isfalsey(isequal(item.key, key))) {
-				del_item(&item);
-				table->items[index] = TOMBSTONE;
-			}
+		if (!YASL_ISEND(item.key) && keys_equal(item.key, key)) {
+			del_item(&item);
+			table->items[index].key = YASL_END();
+			table->items[index].value = YASL_END();
+			table->count--;
+			table->tombstones++;
+
+			const int load = table->count * 100 / table->size;
+			const int deleted = table->tombstones * 100 / table->size;
+			if (load < 10 && table->base_size / 2 >= HT_BASESIZE) table_resize_down(table);
+			else if (deleted > 20) table_rehash(table);
+			return;
 		}
 		index = get_hash(key, table->size, i++);
 		item = table->items[index];
 	}
-	table->count--;
 }
+
+void table_rm_all(struct Table *table) {
+	FOR_TABLE(i, item, table) {
+		del_item(item);
+	}
+	table->count = 0;
+	table->tombstones = 0;
+	table->base_size = HT_BASESIZE;
+	table->size = next_prime(table->base_size);
+	free(table->items);
+	table->items = calloc((size_t) table->size, sizeof(Item_t));
+}
+
+#endif
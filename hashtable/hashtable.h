@@ -2,6 +2,7 @@
 
 #include <inttypes.h>
 
+#include "yasl_conf.h"
 #include "prime/prime.h"
 #include "interpreter/YASL_Object.h"
 #include "interpreter/list.h"
@@ -11,34 +12,62 @@
 #define HT_BASESIZE 30
 
 #define FOR_TABLE(i, item, table) Item_t *item; for (size_t i = 0; i < (table)->size; i++) \
-                                                  if (item = &table->items[i], item->key.type != Y_END && !YASL_ISUNDEF(item->key))
+                                                  if (TABLE_SLOT_USED(table, i) && (item = &(table)->items[i], 1))
 
 typedef struct {
     struct YASL_Object key;
     struct YASL_Object value;
 } Item_t;
 
+#if YASL_SWISS_TABLE
+
+#define TABLE_GROUP_WIDTH 16
+#define CTRL_EMPTY ((signed char) -128)
+
+// whether slot i holds an item. Control bytes are either CTRL_EMPTY or the low 7 bits of the hash of the key.
+#define TABLE_SLOT_USED(table, i) ((table)->ctrl[i] >= 0)
+
+struct Table {
+    size_t size;                   // always a power of two
+    size_t base_size;
+    size_t count;
+    Item_t *items;
+    signed char *ctrl;             // size + TABLE_GROUP_WIDTH bytes; the last group mirrors the first one
+};
+
+#else
+
+#define TABLE_SLOT_USED(table, i) (!YASL_ISEND((table)->items[i].key) && !YASL_ISUNDEF((table)->items[i].key))
+
 struct Table {
     size_t size;
     size_t base_size;
     size_t count;
+    size_t tombstones;             // removed items, which lookups still have to probe past
     Item_t *items;
 };
 
-static Item_t TOMBSTONE = { { Y_END, { Y_END } }, { Y_END, { Y_END } } }; //(struct YASL_Object) {Y_END, Y_END};
+
+#endif
 
 void del_item(Item_t* item);
+int keys_equal(const struct YASL_Object a, const struct YASL_Object b);
 
 struct Table *table_new(void);
+struct Table *table_new_sized(const int base_size);
+// grows table so that it holds count items without having to resize.
+void table_reserve(struct Table *table, const size_t count);
 void table_insert(struct Table *table, const struct YASL_Object key, const struct YASL_Object value);
 void table_insert_string_int(struct Table *table, char *key, int64_t key_len, int64_t val);
 void table_insert_literalcstring_cfunction(struct Table *ht, char *key, int (*addr)(struct YASL_State *), int num_args);
 struct YASL_Object table_search(const struct Table *const table, const struct YASL_Object key);
 struct YASL_Object table_search_string_int(const struct Table *const table, char *key, int64_t key_len);
+void table_rm(struct Table *table, struct YASL_Object key);
+void table_rm_all(struct Table *table);
 void table_del(struct Table *table);
 void table_del_string_int(struct Table *table);
 
-struct RC_UserData* rcht_new(void);
-struct RC_UserData* rcht_new_sized(const int base_size);
+struct RC_UserData* rcht_new(struct Collector *gc);
+struct RC_UserData* rcht_new_sized(struct Collector *gc, const int base_size);
 void rcht_del_data(void *hashtable);
 void rcht_del_cstring_cfn(struct RC_UserData *hashtable);
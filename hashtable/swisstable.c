@@ -0,0 +1,253 @@
+#include "hashtable/hashtable.h"
+
+#if YASL_SWISS_TABLE
+
+#include <stdlib.h>
+#include <string.h>
+#include <interpreter/YASL_Object.h>
+#include <interpreter/YASL_string.h>
+
+#include "interpreter/refcount.h"
+#include "slab/slab.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/*
+ * Open-addressing table with a power-of-two capacity. Besides the items, each table keeps one control byte per slot:
+ * CTRL_EMPTY for a free slot, or the low 7 bits of the hash of the key (H2) for a used one. Lookups start at the slot
+ * given by the rest of the hash (H1) and probe linearly, comparing a whole group of TABLE_GROUP_WIDTH control bytes
+ * against H2 at once. Only slots whose control byte matches need their keys compared. Probing stops at the first group
+ * that contains an empty slot.
+ *
+ * Since probing is linear, deletion shifts later items of the same run back instead of leaving tombstones, so lookups
+ * never have to skip over deleted slots.
+ */
+
+#define MAX_LOAD_NUM 7
+#define MAX_LOAD_DEN 8
+
+static size_t hash_key(const struct YASL_Object key) {
+	if (YASL_ISSTR(key)) {
+		return str_hash(YASL_GETSTR(key));
+	}
+	uint64_t hash = (uint64_t) YASL_GETINT(key);
+	hash ^= hash >> 30;
+	hash *= 0xbf58476d1ce4e5b9;
+	hash ^= hash >> 27;
+	hash *= 0x94d049bb133111eb;
+	hash ^= hash >> 31;
+	return (size_t) hash;
+}
+
+#define H1(hash) ((hash) >> 7)
+#define H2(hash) ((signed char) ((hash) & 0x7F))
+
+static unsigned int group_match(const signed char *const ctrl, const signed char byte) {
+#if defined(__SSE2__)
+	const __m128i group = _mm_loadu_si128((const __m128i *) ctrl);
+	return (unsigned int) _mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(byte)));
+#else
+	unsigned int mask = 0;
+	for (int i = 0; i < TABLE_GROUP_WIDTH; i++) {
+		mask |= (unsigned int) (ctrl[i] == byte) << i;
+	}
+	return mask;
+#endif
+}
+
+static unsigned int group_match_empty(const signed char *const ctrl) {
+#if defined(__SSE2__)
+	// CTRL_EMPTY is the only control byte with the sign bit set.
+	return (unsigned int) _mm_movemask_epi8(_mm_loadu_si128((const __m128i *) ctrl));
+#else
+	return group_match(ctrl, CTRL_EMPTY);
+#endif
+}
+
+static int lowest_bit(unsigned int mask) {
+#if defined(__GNUC__)
+	return __builtin_ctz(mask);
+#else
+	int i = 0;
+	while (!(mask & 1)) {
+		mask >>= 1;
+		i++;
+	}
+	return i;
+#endif
+}
+
+static void set_ctrl(struct Table *const table, const size_t index, const signed char byte) {
+	table->ctrl[index] = byte;
+	if (index < TABLE_GROUP_WIDTH) {
+		table->ctrl[table->size + index] = byte;
+	}
+}
+
+static size_t capacity_for(const size_t base_size) {
+	size_t size = TABLE_GROUP_WIDTH;
+	while (size < base_size) size <<= 1;
+	return size;
+}
+
+static void table_alloc(struct Table *const table, const size_t size) {
+	table->size = size;
+	table->count = 0;
+	table->items = malloc(size * sizeof(Item_t));
+	table->ctrl = malloc(size + TABLE_GROUP_WIDTH);
+	memset(table->ctrl, CTRL_EMPTY, size + TABLE_GROUP_WIDTH);
+}
+
+/*
+ * Returns the slot holding key, or -1 if key is not in table.
+ */
+static int64_t find_slot(const struct Table *const table, const struct YASL_Object key, const size_t hash) {
+	const size_t mask = table->size - 1;
+	const signed char h2 = H2(hash);
+	size_t pos = H1(hash) & mask;
+	while (1) {
+		const signed char *group = table->ctrl + pos;
+		unsigned int matches = group_match(group, h2);
+		while (matches) {
+			const size_t index = (pos + lowest_bit(matches)) & mask;
+			if (keys_equal(table->items[index].key, key)) {
+				return (int64_t) index;
+			}
+			matches &= matches - 1;
+		}
+		if (group_match_empty(group)) {
+			return -1;
+		}
+		pos = (pos + TABLE_GROUP_WIDTH) & mask;
+	}
+}
+
+/*
+ * Returns the first empty slot in the probe sequence of hash. The table always has an empty slot, since it is never
+ * filled past its maximum load.
+ */
+static size_t find_empty(const struct Table *const table, const size_t hash) {
+	const size_t mask = table->size - 1;
+	size_t pos = H1(hash) & mask;
+	while (1) {
+		const unsigned int empty = group_match_empty(table->ctrl + pos);
+		if (empty) {
+			return (pos + lowest_bit(empty)) & mask;
+		}
+		pos = (pos + TABLE_GROUP_WIDTH) & mask;
+	}
+}
+
+static void table_resize(struct Table *const table, const size_t size) {
+	Item_t *old_items = table->items;
+	signed char *old_ctrl = table->ctrl;
+	const size_t old_size = table->size;
+	const size_t count = table->count;
+
+	table_alloc(table, size);
+	for (size_t i = 0; i < old_size; i++) {
+		if (old_ctrl[i] < 0) continue;
+		// items are moved, so their reference counts stay as they are.
+		const size_t hash = hash_key(old_items[i].key);
+		const size_t index = find_empty(table, hash);
+		set_ctrl(table, index, H2(hash));
+		table->items[index] = old_items[i];
+	}
+	table->count = count;
+
+	free(old_items);
+	free(old_ctrl);
+}
+
+struct Table *table_new_sized(const int base_size) {
+	struct Table *table = slab_alloc(sizeof(struct Table));
+	table->base_size = capacity_for(base_size);
+	table_alloc(table, table->base_size);
+	return table;
+}
+
+void table_del(struct Table *table) {
+	FOR_TABLE(i, item, table) {
+		del_item(item);
+	}
+	free(table->items);
+	free(table->ctrl);
+	slab_free(table, sizeof(struct Table));
+}
+
+void table_reserve(struct Table *table, const size_t count) {
+	size_t size = table->size;
+	while (count * MAX_LOAD_DEN > size * MAX_LOAD_NUM) size <<= 1;
+	if (size > table->size) table_resize(table, size);
+}
+
+void table_insert(struct Table *table, const struct YASL_Object key, const struct YASL_Object value) {
+	const size_t hash = hash_key(key);
+	Item_t item = { key, value };
+	inc_ref(&item.value);
+	inc_ref(&item.key);
+
+	const int64_t found = find_slot(table, key, hash);
+	if (found >= 0) {
+		del_item(&table->items[found]);
+		table->items[found] = item;
+		return;
+	}
+
+	if ((table->count + 1) * MAX_LOAD_DEN > table->size * MAX_LOAD_NUM) {
+		table_resize(table, table->size * 2);
+	}
+	const size_t index = find_empty(table, hash);
+	set_ctrl(table, index, H2(hash));
+	table->items[index] = item;
+	table->count++;
+}
+
+struct YASL_Object table_search(const struct Table *const table, const struct YASL_Object key) {
+	const int64_t index = find_slot(table, key, hash_key(key));
+	if (index < 0) {
+		return YASL_END();
+	}
+	return table->items[index].value;
+}
+
+void table_rm(struct Table *table, struct YASL_Object key) {
+	const size_t mask = table->size - 1;
+	const int64_t found = find_slot(table, key, hash_key(key));
+	if (found < 0) return;
+
+	del_item(&table->items[found]);
+	table->count--;
+
+	// backward-shift deletion: move each later item of the run into the hole, as long as that doesn't put it
+	// before its home slot.
+	size_t hole = (size_t) found;
+	size_t next = (hole + 1) & mask;
+	while (table->ctrl[next] != CTRL_EMPTY) {
+		const size_t home = H1(hash_key(table->items[next].key)) & mask;
+		if (((next - home) & mask) >= ((next - hole) & mask)) {
+			table->items[hole] = table->items[next];
+			set_ctrl(table, hole, table->ctrl[next]);
+			hole = next;
+		}
+		next = (next + 1) & mask;
+	}
+	set_ctrl(table, hole, CTRL_EMPTY);
+
+	if (table->size > table->base_size && table->count * MAX_LOAD_DEN < table->size) {
+		table_resize(table, table->size / 2);
+	}
+}
+
+void table_rm_all(struct Table *table) {
+	FOR_TABLE(i, item, table) {
+		del_item(item);
+	}
+	free(table->items);
+	free(table->ctrl);
+	table_alloc(table, table->base_size);
+}
+
+#endif
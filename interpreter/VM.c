@@ -9,6 +9,9 @@
 #include "YASL_string.h"
 #include "hashtable/hashtable.h"
 #include "interpreter/refcount.h"
+#include "interpreter/collector.h"
+#include "interpreter/jit.h"
+#include "slab/slab.h"
 
 #include "interpreter/table_methods.h"
 #include "interpreter/list_methods.h"
@@ -31,22 +34,44 @@ static struct Table **builtins_htable_new(struct VM *vm) {
     return ht;
 }
 
+/*
+ * Makes room for at least num_globals globals. New globals start out undef, and existing ones are kept. Room is at
+ * least doubled each time, since the REPL adds a few globals per line.
+ */
+void vm_grow_globals(struct VM *vm, size_t num_globals) {
+	if (num_globals <= vm->num_globals) return;
+	if (num_globals < 2 * vm->num_globals) num_globals = 2 * vm->num_globals;
+	vm->globals = realloc(vm->globals, num_globals * sizeof(struct YASL_Object));
+	for (size_t i = vm->num_globals; i < num_globals; i++) {
+		vm->globals[i] = YASL_UNDEF();
+	}
+	vm->num_globals = num_globals;
+}
+
 void vm_init(struct VM *vm,
 	     unsigned char *code,    // pointer to bytecode
            int pc0,             // address of instruction to be executed first -- entrypoint
            size_t datasize) {      // total params size required to perform a program operations
+	slab_retain();
+	vm->gc = NEW_COLLECTOR();
 	vm->code = code;
 	vm->pc = pc0;
 	vm->fp = -1;
 	vm->lp = -1;
 	vm->sp = -1;
-	vm->globals = calloc(sizeof(struct YASL_Object), datasize);
-
-	vm->num_globals = datasize;
+	vm->stop_fp = -1;
+	vm->globals = NULL;
+	vm->num_globals = 0;
+	vm_grow_globals(vm, datasize);
 
 	vm->stack = calloc(sizeof(struct YASL_Object), STACK_SIZE);
+	vm->jit = jit_new();
+
+	vm->strings = table_new();
+	vm->constants = NULL;
+	vm->num_constants = 0;
 
-#define DEF_SPECIAL_STR(enum_val, str) vm->special_strings[enum_val] = str_new_sized(strlen(str), str)
+#define DEF_SPECIAL_STR(enum_val, str) vm->special_strings[enum_val] = vm_intern(vm, str, strlen(str))
 
 	DEF_SPECIAL_STR(S___ADD, "__add");
 	DEF_SPECIAL_STR(S___GET, "__get");
@@ -73,6 +98,7 @@ void vm_init(struct VM *vm,
 	DEF_SPECIAL_STR(S_SEARCH, "search");
 	DEF_SPECIAL_STR(S_SLICE, "slice");
 	DEF_SPECIAL_STR(S_SPLIT, "split");
+	DEF_SPECIAL_STR(S_STABLESORT, "stablesort");
 	DEF_SPECIAL_STR(S_STARTSWITH, "startswith");
 	DEF_SPECIAL_STR(S_TOBOOL, "tobool");
 	DEF_SPECIAL_STR(S_TOFLOAT, "tofloat");
@@ -95,10 +121,18 @@ void vm_cleanup(struct VM *vm) {
 		dec_ref(&vm->globals[i]);
 	}
 
+	// frees the cycles that were only kept alive by the stack and globals.
+	gc_collect(&vm->gc);
+	gc_cleanup(&vm->gc);
+
 	free(vm->globals);
 	free(vm->stack);
 
 	free(vm->code);
+	jit_del(vm->jit);
+
+	table_del(vm->strings);
+	free(vm->constants);
 
 	table_del(vm->builtins_htable[Y_UNDEF]);
 	table_del(vm->builtins_htable[Y_FLOAT]);
@@ -108,6 +142,45 @@ void vm_cleanup(struct VM *vm) {
 	table_del(vm->builtins_htable[Y_LIST]);
 	table_del(vm->builtins_htable[Y_TABLE]);
 	free(vm->builtins_htable);
+	slab_release();
+}
+
+/*
+ * Returns the VM's copy of the given string, creating it the first time it is seen. Interned strings live until the
+ * VM is cleaned up, since the interning table holds a reference to each of them.
+ */
+String_t *vm_intern(struct VM *vm, const char *chars, const size_t len) {
+	String_t *tmp = str_new_sized(len, (char *) chars);
+	struct YASL_Object found = table_search(vm->strings, YASL_STR(tmp));
+	str_del(tmp);
+	if (!YASL_ISSTR(found)) {
+		String_t *string = str_new_sized_heap(0, len, copy_char_buffer(len, chars));
+		table_insert(vm->strings, YASL_STR(string), YASL_STR(string));
+		return string;
+	}
+	return YASL_GETSTR(found);
+}
+
+/*
+ * Interns every string in the constant pool of vm->code, so that NEWSTR and INIT_MC only need to index into
+ * vm->constants. The pool is found through the third word of the header, and is laid out as
+ * [count][len][bytes][len][bytes]...
+ */
+void vm_load_constants(struct VM *vm) {
+	yasl_int pool, count, len;
+	memcpy(&pool, vm->code + 2 * sizeof(yasl_int), sizeof(yasl_int));
+	memcpy(&count, vm->code + pool, sizeof(yasl_int));
+	pool += sizeof(yasl_int);
+
+	free(vm->constants);
+	vm->constants = malloc(sizeof(String_t *) * count);
+	vm->num_constants = (size_t) count;
+	for (yasl_int i = 0; i < count; i++) {
+		memcpy(&len, vm->code + pool, sizeof(yasl_int));
+		pool += sizeof(yasl_int);
+		vm->constants[i] = vm_intern(vm, (char *) vm->code + pool, (size_t) len);
+		pool += len;
+	}
 }
 
 void vm_push(struct VM *vm, struct YASL_Object val) {
@@ -117,6 +190,16 @@ void vm_push(struct VM *vm, struct YASL_Object val) {
     inc_ref(vm->stack + vm->sp);
 }
 
+/*
+ * Overwrites slot with val, which is a number. Numbers hold no references, apart from ints boxed on the heap in the
+ * NaN-boxed layout, so refcounts are only touched for those and for whatever non-number slot held.
+ */
+static inline void vm_setnum(struct YASL_Object *slot, const struct YASL_Object val) {
+	if (!YASL_ISNUM(*slot) || YASL_ISBIGINT(*slot)) dec_ref(slot);
+	*slot = val;
+	if (YASL_ISBIGINT(val)) inc_ref(slot);
+}
+
 struct YASL_Object vm_pop(struct VM *vm) {
     return vm->stack[vm->sp--];
 }
@@ -128,6 +211,33 @@ yasl_int vm_read_int(struct VM *vm) {
     return val;
 }
 
+// short operands, as chosen by the compiler for branches and integer constants.
+static inline yasl_int vm_read_int8(struct VM *vm) {
+	return (int8_t) vm->code[vm->pc++];
+}
+
+static inline yasl_int vm_read_int16(struct VM *vm) {
+	int16_t val;
+	memcpy(&val, vm->code + vm->pc, sizeof(val));
+	vm->pc += sizeof(val);
+	return val;
+}
+
+static inline yasl_int vm_read_int32(struct VM *vm) {
+	int32_t val;
+	memcpy(&val, vm->code + vm->pc, sizeof(val));
+	vm->pc += sizeof(val);
+	return val;
+}
+
+// addresses of globals and locals too wide for a single byte.
+static inline yasl_int vm_read_addr16(struct VM *vm) {
+	uint16_t val;
+	memcpy(&val, vm->code + vm->pc, sizeof(val));
+	vm->pc += sizeof(val);
+	return val;
+}
+
 yasl_float vm_read_float(struct VM *vm) {
     yasl_float val;
     memcpy(&val, vm->code + vm->pc, sizeof(yasl_float));
@@ -135,10 +245,6 @@ yasl_float vm_read_float(struct VM *vm) {
     return val;
 }
 
-int vm_GET(struct VM *vm);
-int vm_INIT_CALL(struct VM *vm);
-int vm_CALL(struct VM *vm);
-
 #define INT_BINOP(name, op) yasl_int name(yasl_int left, yasl_int right) { return left op right; }
 
 INT_BINOP(bor, |)
@@ -164,8 +270,8 @@ int vm_int_binop(struct VM *vm, yasl_int (*op)(yasl_int, yasl_int), char *opstr,
 		if (YASL_ISUNDEF(vm_peek(vm))) {
 			YASL_PRINT_ERROR_TYPE("%s not supported for operands of types %s and %s.\n",
 					      opstr,
-					      YASL_TYPE_NAMES[a.type],
-					      YASL_TYPE_NAMES[b.type]);
+					      YASL_TYPE_NAMES[YASL_GETTYPE(a)],
+					      YASL_TYPE_NAMES[YASL_GETTYPE(b)]);
 			return YASL_TYPE_ERROR;
 		} else {
 			vm_INIT_CALL(vm);
@@ -213,8 +319,8 @@ int vm_num_binop(
 		if (YASL_ISUNDEF(vm_peek(vm))) {
 			YASL_PRINT_ERROR_TYPE("%s not supported for operands of types %s and %s.\n",
 					      opstr,
-					      YASL_TYPE_NAMES[left.type],
-					      YASL_TYPE_NAMES[right.type]);
+					      YASL_TYPE_NAMES[YASL_GETTYPE(left)],
+					      YASL_TYPE_NAMES[YASL_GETTYPE(right)]);
 			dec_ref(&left);
 			dec_ref(&right);
 			return YASL_TYPE_ERROR;
@@ -249,8 +355,8 @@ int vm_fdiv(struct VM *vm) {
 		vm_GET(vm);
 		if (YASL_ISUNDEF(vm_peek(vm))) {
 			YASL_PRINT_ERROR_TYPE("/ not supported for operands of types %s and %s.\n",
-					      YASL_TYPE_NAMES[left.type],
-					      YASL_TYPE_NAMES[right.type]);
+					      YASL_TYPE_NAMES[YASL_GETTYPE(left)],
+					      YASL_TYPE_NAMES[YASL_GETTYPE(right)]);
 			return YASL_TYPE_ERROR;
 		} else {
 			vm_INIT_CALL(vm);
@@ -287,7 +393,7 @@ NUM_UNOP(pos, +)
 int vm_int_unop(struct VM *vm, yasl_int (*op)(yasl_int), char *opstr, char *overload_name) {
 	struct YASL_Object a = vm_peek(vm);
 	if (YASL_ISINT(a)) {
-		vm_peek(vm).value.ival = op(YASL_GETINT(a));
+		vm_setnum(&vm_peek(vm), YASL_INT(op(YASL_GETINT(a))));
 		return YASL_SUCCESS;
 	} else {
 		struct YASL_Object op_name = YASL_STR(str_new_sized(strlen(overload_name), overload_name));
@@ -297,7 +403,7 @@ int vm_int_unop(struct VM *vm, yasl_int (*op)(yasl_int), char *opstr, char *over
 		if (YASL_ISUNDEF(vm_peek(vm))) {
 			YASL_PRINT_ERROR_TYPE("%s not supported for operand of types %s.\n",
 					      opstr,
-					      YASL_TYPE_NAMES[a.type]);
+					      YASL_TYPE_NAMES[YASL_GETTYPE(a)]);
 			return YASL_TYPE_ERROR;
 		} else {
 			vm_INIT_CALL(vm);
@@ -322,7 +428,7 @@ int vm_num_unop(struct VM *vm, yasl_int (*int_op)(yasl_int), yasl_float (*float_
 		if (YASL_ISUNDEF(vm_peek(vm))) {
 			YASL_PRINT_ERROR_TYPE("%s not supported for operand of types %s.\n",
 					      opstr,
-					      YASL_TYPE_NAMES[expr.type]);
+					      YASL_TYPE_NAMES[YASL_GETTYPE(expr)]);
 			return YASL_TYPE_ERROR;
 		} else {
 			vm_INIT_CALL(vm);
@@ -334,11 +440,11 @@ int vm_num_unop(struct VM *vm, yasl_int (*int_op)(yasl_int), yasl_float (*float_
 }
 
 int vm_stringify_top(struct VM *vm) {
-	YASL_Types index = VM_PEEK(vm, vm->sp).type;
+	YASL_Types index = YASL_GETTYPE(VM_PEEK(vm, vm->sp));
 	if (YASL_ISFN(VM_PEEK(vm, vm->sp)) || YASL_ISCFN(VM_PEEK(vm, vm->sp))) {
 		int n;	  
-		char *buffer = malloc(n = snprintf(NULL, 0, "<fn: %d>", (int)vm_peek(vm).value.ival) + 1);
-		snprintf(buffer, n, "<fn: %d>", (int)vm_peek(vm).value.ival);
+		char *buffer = malloc(n = snprintf(NULL, 0, "<fn: %d>", (int)YASL_GETINT(vm_peek(vm))) + 1);
+		snprintf(buffer, n, "<fn: %d>", (int)YASL_GETINT(vm_peek(vm)));
 		vm_pushstr(vm, str_new_sized_heap(0, strlen(buffer), buffer));
 	} else {
 		struct YASL_Object key = YASL_STR(str_new_sized(strlen("tostr"), "tostr"));
@@ -352,8 +458,8 @@ int vm_stringify_top(struct VM *vm) {
 int vm_SLICE(struct VM *vm) {
 	if (!YASL_ISINT(VM_PEEK(vm, vm->sp)) || !YASL_ISINT(VM_PEEK(vm, vm->sp - 1))) {
 		YASL_PRINT_ERROR_TYPE("slicing expected range of type int:int, got type %s:%s",
-				      YASL_TYPE_NAMES[VM_PEEK(vm, vm->sp - 1).type],
-				      YASL_TYPE_NAMES[VM_PEEK(vm, vm->sp).type]
+				      YASL_TYPE_NAMES[YASL_GETTYPE(VM_PEEK(vm, vm->sp - 1))],
+				      YASL_TYPE_NAMES[YASL_GETTYPE(VM_PEEK(vm, vm->sp))]
 		);
 		return YASL_TYPE_ERROR;
 	}
@@ -376,7 +482,7 @@ int vm_SLICE(struct VM *vm) {
 		if (start < 0)
 			start = 0;
 
-		struct RC_UserData *new_ls = ls_new();
+		struct RC_UserData *new_ls = ls_new(&vm->gc);
 
 		for (yasl_int i = start; i <end; ++i) {
 			ls_append(new_ls->data, list->items[i]);
@@ -404,14 +510,14 @@ int vm_SLICE(struct VM *vm) {
 		return YASL_SUCCESS;
 	}
 
-	YASL_PRINT_ERROR_TYPE("slice is not defined for objects of type %s.", YASL_TYPE_NAMES[vm_pop(vm).type]);
+	YASL_PRINT_ERROR_TYPE("slice is not defined for objects of type %s.", YASL_TYPE_NAMES[YASL_GETTYPE(vm_pop(vm))]);
 	return YASL_TYPE_ERROR;
 
 }
 
 int vm_GET(struct VM *vm) {
 	vm->sp--;
-	int index = vm_peek(vm).type;
+	int index = YASL_GETTYPE(vm_peek(vm));
 	if (YASL_ISLIST(vm_peek(vm))) {
 		vm->sp++;
 		if (!list___get((struct YASL_State *) vm)) {
@@ -429,7 +535,7 @@ int vm_GET(struct VM *vm) {
 	struct YASL_Object key = vm_pop(vm);
 	struct YASL_Object result = table_search(vm->builtins_htable[index], key);
 	vm_pop(vm);
-	if (result.type == Y_END) {
+	if (YASL_GETTYPE(result) == Y_END) {
 		vm_pushundef(vm);
 	} else {
 		vm_push(vm, result);
@@ -451,20 +557,21 @@ int vm_NEWSPECIALSTR(struct VM *vm) {
 }
 
 int vm_NEWSTR(struct VM *vm) {
-	yasl_int addr = vm_read_int(vm);
-
-	yasl_int size;
-	memcpy(&size, vm->code + addr, sizeof(yasl_int));
+	vm_pushstr(vm, vm->constants[vm_read_int(vm)]);
+	return YASL_SUCCESS;
+}
 
-	addr += sizeof(yasl_int);
-	String_t *string = str_new_sized(size, ((char *) vm->code) + addr);
-	vm_pushstr(vm, string);
+int vm_NEWSTR_2(struct VM *vm) {
+	uint16_t addr;
+	memcpy(&addr, vm->code + vm->pc, sizeof(addr));
+	vm->pc += sizeof(addr);
+	vm_pushstr(vm, vm->constants[addr]);
 	return YASL_SUCCESS;
 }
 
 int vm_INIT_CALL(struct VM *vm) {
 	if (!YASL_ISFN(vm_peek(vm)) && !YASL_ISCFN(vm_peek(vm))) {
-		YASL_PRINT_ERROR_TYPE("%s is not callable.", YASL_TYPE_NAMES[vm_peek(vm).type]);
+		YASL_PRINT_ERROR_TYPE("%s is not callable.", YASL_TYPE_NAMES[YASL_GETTYPE(vm_peek(vm))]);
 		return YASL_TYPE_ERROR;
 	}
 
@@ -477,27 +584,87 @@ int vm_INIT_CALL(struct VM *vm) {
 	return YASL_SUCCESS;
 }
 
+/*
+ * Inline caches for method calls. The cache records the method found for one receiver type, so that later calls on
+ * the same type skip building the name and searching the builtins. Only types whose methods can only come from their
+ * builtins are cached: a table's own keys can shadow its builtins, so tables are never cached.
+ */
+static int vm_mc_cache_hit(struct VM *vm, unsigned char *cache) {
+	struct YASL_Object receiver = vm_peek(vm);
+	if (cache[0] != YASL_GETTYPE(receiver) + 1) return 0;
+
+	struct CFunction_s *method;
+	memcpy(&method, cache + 1, sizeof(method));
+	vm_peek(vm) = YASL_CFN_OBJ(method);
+	inc_ref(&vm_peek(vm));
+	vm_INIT_CALL(vm);
+	vm->sp++;
+	dec_ref(&vm_peek(vm));
+	vm_peek(vm) = receiver;    // the reference held by the receiver's old slot moves here.
+	return 1;
+}
+
+static void vm_mc_cache_fill(unsigned char *cache, YASL_Types type, struct YASL_Object method) {
+	if (!YASL_ISCFN(method)) return;
+	struct CFunction_s *cfn = YASL_GETCFN(method);
+	switch (type) {
+	case Y_UNDEF:
+	case Y_FLOAT:
+	case Y_INT:
+	case Y_BOOL:
+	case Y_STR:
+	case Y_LIST:
+		cache[0] = (unsigned char) (type + 1);
+		memcpy(cache + 1, &cfn, sizeof(cfn));
+		break;
+	default:
+		break;
+	}
+}
+
 int vm_INIT_MC(struct VM *vm) {
+	unsigned char *cache = vm->code + vm->pc + sizeof(yasl_int);
+	if (vm_mc_cache_hit(vm, cache)) {
+		vm->pc += sizeof(yasl_int) + MC_CACHE_SIZE;
+		return YASL_SUCCESS;
+	}
+
 	struct YASL_Object top = vm_peek(vm);
 	inc_ref(&top);
 	vm_NEWSTR(vm);
+	vm->pc += MC_CACHE_SIZE;
 	//vm_SWAP(vm);
 	//vm_push(vm, top);
 	vm_GET(vm);
-	vm_INIT_CALL(vm);
+	vm_mc_cache_fill(cache, YASL_GETTYPE(top), vm_peek(vm));
+	if (vm_INIT_CALL(vm)) {
+		dec_ref(&top);
+		return YASL_TYPE_ERROR;
+	}
 	vm_push(vm, top);
 	dec_ref(&top);
 	return YASL_SUCCESS;
 }
 
 int vm_INIT_MC_SPECIAL(struct VM *vm) {
+	unsigned char *cache = vm->code + vm->pc + 1;
+	if (vm_mc_cache_hit(vm, cache)) {
+		vm->pc += 1 + MC_CACHE_SIZE;
+		return YASL_SUCCESS;
+	}
+
 	struct YASL_Object top = vm_peek(vm);
 	inc_ref(&top);
 	vm_NEWSPECIALSTR(vm);
+	vm->pc += MC_CACHE_SIZE;
 	//vm_SWAP(vm);
 	//vm_push(vm, top);
 	vm_GET(vm);
-	vm_INIT_CALL(vm);
+	vm_mc_cache_fill(cache, YASL_GETTYPE(top), vm_peek(vm));
+	if (vm_INIT_CALL(vm)) {
+		dec_ref(&top);
+		return YASL_TYPE_ERROR;
+	}
 	vm_push(vm, top);
 	dec_ref(&top);
 	return YASL_SUCCESS;
@@ -506,7 +673,7 @@ int vm_INIT_MC_SPECIAL(struct VM *vm) {
 int vm_CALL(struct VM *vm) {
 	vm->fp = vm->next_fp;
 	if (YASL_ISFN(vm->stack[vm->fp])) {
-		vm->stack[vm->fp + 1].value.ival = vm->pc;
+		vm->stack[vm->fp + 1] = YASL_INT(vm->pc);
 
 		while (vm->sp - (vm->fp + 3) < vm->code[vm_peekint(vm, vm->fp)]) {
 			vm_pushundef(vm);
@@ -516,9 +683,13 @@ int vm_CALL(struct VM *vm) {
 			vm_pop(vm);
 		}
 
-		vm->sp += vm->code[vm_peekint(vm, vm->fp) + 1];
+		uint16_t num_locals;
+		memcpy(&num_locals, vm->code + vm_peekint(vm, vm->fp) + 1, sizeof(num_locals));
+		for (uint16_t i = 0; i < num_locals; i++) {
+			vm_pushundef(vm);
+		}
 
-		vm->pc = vm_peekint(vm, vm->fp) + 2;
+		vm->pc = vm_peekint(vm, vm->fp) + FN_HEADER_SIZE;
 		return YASL_SUCCESS;
 	} else if (YASL_ISCFN(vm->stack[vm->fp])) {
 		while (vm->sp - (vm->fp + 3) < vm_peekcfn(vm, vm->fp)->num_args) {
@@ -541,397 +712,1227 @@ int vm_CALL(struct VM *vm) {
 		vm_push(vm, v);
 		return YASL_SUCCESS;
 	} else {
-		printf("ERROR: %s is not callable", YASL_TYPE_NAMES[vm->stack[vm->sp].type]);
+		printf("ERROR: %s is not callable", YASL_TYPE_NAMES[YASL_GETTYPE(vm->stack[vm->sp])]);
+		return YASL_TYPE_ERROR;
+	}
+}
+
+int vm_GT(struct VM *vm) {
+	struct YASL_Object b = vm_pop(vm);
+	struct YASL_Object a = vm_pop(vm);
+	yasl_int c;
+	if (YASL_ISSTR(a) && YASL_ISSTR(b)) {
+		vm_pushbool(vm, yasl_string_cmp(YASL_GETSTR(a), YASL_GETSTR(b)) > 0);
+		return YASL_SUCCESS;
+	}
+	if (!YASL_ISNUM(a) || !YASL_ISNUM(b)) {
+		YASL_PRINT_ERROR_TYPE("< and > not supported for operand of types %s and %s.\n",
+		       YASL_TYPE_NAMES[YASL_GETTYPE(a)],
+		       YASL_TYPE_NAMES[YASL_GETTYPE(b)]);
 		return YASL_TYPE_ERROR;
 	}
+	COMP(vm, a, b, GT, ">");
+	return YASL_SUCCESS;
+}
+
+int vm_GE(struct VM *vm) {
+	struct YASL_Object b = vm_pop(vm);
+	struct YASL_Object a = vm_pop(vm);
+	yasl_int c;
+	if (YASL_ISSTR(a) && YASL_ISSTR(b)) {
+		vm_push(vm, YASL_BOOL(yasl_string_cmp(YASL_GETSTR(a), YASL_GETSTR(b)) >= 0));
+		return YASL_SUCCESS;
+	}
+	if (!YASL_ISNUM(a) || !YASL_ISNUM(b)) {
+		YASL_PRINT_ERROR_TYPE("<= and >= not supported for operand of types %s and %s.\n",
+		       YASL_TYPE_NAMES[YASL_GETTYPE(a)],
+		       YASL_TYPE_NAMES[YASL_GETTYPE(b)]);
+		return YASL_TYPE_ERROR;
+	}
+	COMP(vm, a, b, GE, ">=");
+	return YASL_SUCCESS;
+}
+
+/*
+ * Handlers of single instructions, for those that vm_run doesn't handle inline, and the generic paths of those it
+ * does. Each runs with vm->pc just past the opcode, so that native code from interpreter/jit.c can call them too.
+ */
+int vm_ADD(struct VM *vm) {
+	return vm_num_binop(vm, &int_add, &float_add, "+", OP_BIN_PLUS);
+}
+
+int vm_SUB(struct VM *vm) {
+	return vm_num_binop(vm, &int_sub, &float_sub, "-", OP_BIN_MINUS);
+}
+
+int vm_MUL(struct VM *vm) {
+	return vm_num_binop(vm, &int_mul, &float_mul, "*", OP_BIN_TIMES);
+}
+
+int vm_IDIV(struct VM *vm) {
+	if (YASL_ISINT(vm_peek(vm)) && YASL_GETINT(vm_peek(vm)) == 0) {
+		YASL_PRINT_ERROR_DIVIDE_BY_ZERO();
+		return YASL_DIVIDE_BY_ZERO_ERROR;
+	}
+	return vm_int_binop(vm, &idiv, "//", OP_BIN_IDIV);
+}
+
+int vm_MOD(struct VM *vm) {
+	// TODO: handle undefined C behaviour for negative numbers.
+	if (YASL_ISINT(vm_peek(vm)) && YASL_GETINT(vm_peek(vm)) == 0) {
+		YASL_PRINT_ERROR_DIVIDE_BY_ZERO();
+		return YASL_DIVIDE_BY_ZERO_ERROR;
+	}
+	return vm_int_binop(vm, &modulo, "%", OP_BIN_MOD);
+}
+
+int vm_BOR(struct VM *vm) {
+	return vm_int_binop(vm, &bor, "|", OP_BIN_BAR);
 }
 
+int vm_BXOR(struct VM *vm) {
+	return vm_int_binop(vm, &bxor, "^", OP_BIN_CARET);
+}
+
+int vm_BAND(struct VM *vm) {
+	return vm_int_binop(vm, &band, "&", OP_BIN_AMP);
+}
+
+int vm_BANDNOT(struct VM *vm) {
+	return vm_int_binop(vm, &bandnot, "&^", OP_BIN_AMPCARET);
+}
+
+int vm_BSL(struct VM *vm) {
+	return vm_int_binop(vm, &shift_left, "<<", OP_BIN_SHL);
+}
+
+int vm_BSR(struct VM *vm) {
+	return vm_int_binop(vm, &shift_right, ">>", OP_BIN_SHR);
+}
+
+int vm_BNOT(struct VM *vm) {
+	return vm_int_unop(vm, &bnot, "^", OP_UN_CARET);
+}
+
+int vm_NEG(struct VM *vm) {
+	return vm_num_unop(vm, &int_neg, &float_neg, "-", OP_UN_MINUS);
+}
+
+int vm_POS(struct VM *vm) {
+	return vm_num_unop(vm, &int_pos, &float_pos, "+", OP_UN_PLUS);
+}
+
+int vm_NOT(struct VM *vm) {
+	vm_pushbool(vm, isfalsey(vm_pop(vm)));
+	return YASL_SUCCESS;
+}
+
+int vm_LEN(struct VM *vm) {
+	struct YASL_Object v = vm_pop(vm);
+	if (YASL_ISSTR(v)) {
+		vm_pushint(vm, yasl_string_len(YASL_GETSTR(v)));
+	} else if (YASL_ISTABLE(v)) {
+		vm_pushint(vm, YASL_GETTABLE(v)->count);
+	} else if (YASL_ISLIST(v)) {
+		vm_pushint(vm, YASL_GETLIST(v)->count);
+	} else {
+		YASL_PRINT_ERROR_TYPE("len not supported for operand of type %s.\n",
+				      YASL_TYPE_NAMES[YASL_GETTYPE(v)]);
+		return YASL_TYPE_ERROR;
+	}
+	return YASL_SUCCESS;
+}
+
+int vm_CNCT(struct VM *vm) {
+	vm_stringify_top(vm);
+	String_t *b = vm_popstr(vm);
+	vm_stringify_top(vm);
+	String_t *a = vm_popstr(vm);
+
+	size_t size = yasl_string_len((a)) + yasl_string_len((b));
+	char *ptr = malloc(size);
+	memcpy(ptr, (a)->str + (a)->start,
+	       yasl_string_len((a)));
+	memcpy(ptr + yasl_string_len((a)),
+	       ((b))->str + (b)->start,
+	       yasl_string_len((b)));
+	vm_pushstr(vm, str_new_sized_heap(0, size, ptr));
+	return YASL_SUCCESS;
+}
+
+int vm_EQ(struct VM *vm) {
+	struct YASL_Object b = vm_pop(vm);
+	struct YASL_Object a = vm_pop(vm);
+	vm_push(vm, isequal(a, b));
+	return YASL_SUCCESS;
+}
+
+int vm_ID(struct VM *vm) { // TODO: clean-up
+	struct YASL_Object b = vm_pop(vm);
+	struct YASL_Object a = vm_pop(vm);
+	vm_push(vm, YASL_BOOL(YASL_ISIDENTICAL(a, b)));
+	return YASL_SUCCESS;
+}
+
+int vm_NEWSTR_1(struct VM *vm) {
+	vm_pushstr(vm, vm->constants[NCODE(vm)]);
+	return YASL_SUCCESS;
+}
+
+/*
+ * Pops count key-value pairs into a new table, which is sized up front to hold them all.
+ */
+static struct RC_UserData *vm_make_table(struct VM *vm, const int64_t count) {
+	// new lists and tables are where cycles come from, so this is where the collector runs on its own.
+	if (gc_should_collect(&vm->gc)) gc_collect(&vm->gc);
+	struct RC_UserData *ht = rcht_new(&vm->gc);
+	table_reserve(ht->data, (size_t) count);
+	for (int64_t i = 0; i < count; i++) {
+		struct YASL_Object value = vm_pop(vm);
+		struct YASL_Object key = vm_pop(vm);
+		table_insert(ht->data, key, value);
+	}
+	return ht;
+}
+
+int vm_NEWTABLE(struct VM *vm) {
+	int64_t count = 0;
+	while (YASL_GETTYPE(VM_PEEK(vm, vm->sp - count)) != Y_END) {
+		count++;
+	}
+	struct RC_UserData *ht = vm_make_table(vm, count / 2);
+	vm_pop(vm);
+	vm_push(vm, YASL_TABLE(ht));
+	return YASL_SUCCESS;
+}
+
+int vm_NEWTABLE_N(struct VM *vm) {
+	struct RC_UserData *ht = vm_make_table(vm, vm_read_int(vm));
+	vm_push(vm, YASL_TABLE(ht));
+	return YASL_SUCCESS;
+}
+
+/*
+ * Replaces the top count values of the stack with a list of them. The list is allocated at its final size, and the
+ * values are moved into it along with the references the stack held to them.
+ */
+static void vm_make_list(struct VM *vm, const int64_t count) {
+	if (gc_should_collect(&vm->gc)) gc_collect(&vm->gc);
+	// an empty literal is usually about to be appended to, so it still gets the default size.
+	struct RC_UserData *ls = ls_new_sized(&vm->gc, count ? (int) count : LS_BASESIZE);
+	struct List *list = (struct List *) ls->data;
+	struct YASL_Object *values = vm->stack + vm->sp - count + 1;
+	memcpy(list->items, values, sizeof(struct YASL_Object) * count);
+	list->count = count;
+	for (int64_t i = 0; i < count; i++) {
+		values[i] = YASL_UNDEF();
+	}
+	vm->sp -= count;
+	vm_push(vm, YASL_LIST(ls));
+}
+
+int vm_NEWLIST(struct VM *vm) {
+	int64_t count = 0;
+	while (YASL_GETTYPE(VM_PEEK(vm, vm->sp - count)) != Y_END) {
+		count++;
+	}
+	vm_make_list(vm, count);
+	// the list takes the place of END.
+	VM_PEEK(vm, vm->sp - 1) = VM_PEEK(vm, vm->sp);
+	VM_PEEK(vm, vm->sp) = YASL_UNDEF();
+	vm->sp--;
+	return YASL_SUCCESS;
+}
+
+int vm_NEWLIST_N(struct VM *vm) {
+	vm_make_list(vm, vm_read_int(vm));
+	return YASL_SUCCESS;
+}
+
+int vm_INITFOR(struct VM *vm) {
+	vm_pushint(vm, 0);
+	vm_pushint(vm, vm->lp);
+	vm->lp = vm->sp - 2;
+	return YASL_SUCCESS;
+}
+
+int vm_ENDCOMP(struct VM *vm) {
+	struct YASL_Object a = vm_pop(vm);
+	vm->lp = vm_popint(vm);
+	vm_pop(vm);
+	vm_pop(vm);
+	vm_push(vm, a);
+	return YASL_SUCCESS;
+}
+
+int vm_ENDFOR(struct VM *vm) {
+	vm->lp = vm_popint(vm);
+	vm_pop(vm);
+	vm_pop(vm);
+	return YASL_SUCCESS;
+}
+
+int vm_ITER_1(struct VM *vm) {
+	switch (YASL_GETTYPE(VM_PEEK(vm, vm->lp))) {
+	case Y_LIST:
+		if (vm_peeklist(vm, vm->lp)->count <= vm_peekint(vm, vm->lp + 1)) {
+			vm_pushbool(vm, 0);
+		} else {
+			const yasl_int i = vm_peekint(vm, vm->lp + 1);
+			VM_PEEK(vm, vm->lp + 1) = YASL_INT(i + 1);
+			vm_push(vm, vm_peeklist(vm, vm->lp)->items[i]);
+			vm_pushbool(vm, 1);
+		}
+		return YASL_SUCCESS;
+	case Y_TABLE: {
+		struct Table *table = vm_peektable(vm, vm->lp);
+		size_t i = (size_t) vm_peekint(vm, vm->lp + 1);
+		while (i < table->size && !TABLE_SLOT_USED(table, i)) {
+			i++;
+		}
+		if (table->size <= i) {
+			VM_PEEK(vm, vm->lp + 1) = YASL_INT(i);
+			vm_pushbool(vm, 0);
+			return YASL_SUCCESS;
+		}
+		VM_PEEK(vm, vm->lp + 1) = YASL_INT(i + 1);
+		vm_push(vm, table->items[i].key);
+		vm_pushbool(vm, 1);
+		return YASL_SUCCESS;
+	}
+	case Y_STR:
+		if (yasl_string_len(vm_peekstr(vm, vm->lp)) <= vm_peekint(vm, vm->lp + 1)) {
+			vm_push(vm, YASL_BOOL(0));
+		} else {
+			int64_t i = vm_peekint(vm, vm->lp + 1);
+			vm_push(vm, YASL_STR(str_new_substring(i, i+1, vm_peekstr(vm, vm->lp))));
+			VM_PEEK(vm, vm->lp + 1) = YASL_INT(i + 1);
+			vm_pushbool(vm, 1);
+		}
+		return YASL_SUCCESS;
+	default:
+		YASL_PRINT_ERROR_TYPE("object of type %s is not iterable.\n", YASL_TYPE_NAMES[YASL_GETTYPE(vm->stack[vm->lp])]);
+		return YASL_TYPE_ERROR;
+	}
+}
+
+int vm_SET(struct VM *vm) {
+	vm->sp -= 2;
+	if (YASL_ISLIST(vm_peek(vm))) {
+		vm->sp += 2;
+		list___set((struct YASL_State *) vm);
+	} else if (YASL_ISTABLE(vm_peek(vm))) {
+		vm->sp += 2;
+		table___set((struct YASL_State *) vm);
+	} else {
+		vm->sp += 2;
+		YASL_PRINT_ERROR_TYPE("object of type %s is immutable.", YASL_TYPE_NAMES[YASL_GETTYPE(vm_peek(vm))]);
+		return YASL_TYPE_ERROR;
+	}
+	return YASL_SUCCESS;
+}
+
+// pops the frame of the current function, leaving its result on top of the stack, and returns to its caller.
+int vm_RET(struct VM *vm) {
+	// TODO: handle multiple returns
+	struct YASL_Object v = vm_pop(vm);
+	vm->sp = vm->fp + 3;
+	vm->next_fp = YASL_GETINT(vm->stack[vm->fp + 3]);
+	vm_pop(vm);
+	vm->fp = vm_popint(vm);
+	vm->pc = vm_popint(vm);
+	vm_pop(vm);
+	vm_push(vm, v);
+	return YASL_SUCCESS;
+}
+
+int vm_PRINT(struct VM *vm) {
+	yasl_print(vm);
+	return YASL_SUCCESS;
+}
+
+/*
+ * If the last call entered a YASL function (rather than a C function, which has already returned), runs it until it
+ * returns, leaving its result on top of the stack. fp is the frame pointer from before the call.
+ */
+int vm_finish_call(struct VM *vm, int fp) {
+	if (vm->fp == fp) return YASL_SUCCESS;
+	int res = jit_run(vm);
+	if (res != JIT_UNAVAILABLE) return res;
+	int stop_fp = vm->stop_fp;
+	vm->stop_fp = vm->fp;
+	res = vm_run(vm);
+	vm->stop_fp = stop_fp;
+	return res;
+}
+
+/*
+ * Register instructions. Numbers are written with vm_setnum, which skips refcounting for them.
+ */
+static void vm_reg_set(struct YASL_Object *slot, struct YASL_Object val) {
+	inc_ref(&val);
+	dec_ref(slot);
+	*slot = val;
+}
+
+static inline int vm_reg_num_binop(struct VM *vm, unsigned char dst, struct YASL_Object left, struct YASL_Object right,
+				   yasl_int (*int_op)(yasl_int, yasl_int),
+				   yasl_float (*float_op)(yasl_float, yasl_float),
+				   const char *const opstr,
+				   char *overload_name) {
+	struct YASL_Object *slot = VM_FRAME(vm) + dst;
+	if (YASL_ISINT(left) && YASL_ISINT(right)) {
+		vm_setnum(slot, YASL_INT(int_op(YASL_GETINT(left), YASL_GETINT(right))));
+	} else if (YASL_ISFLOAT(left) && YASL_ISFLOAT(right)) {
+		vm_setnum(slot, YASL_FLOAT(float_op(YASL_GETFLOAT(left), YASL_GETFLOAT(right))));
+	} else if (YASL_ISFLOAT(left) && YASL_ISINT(right)) {
+		vm_setnum(slot, YASL_FLOAT(float_op(YASL_GETFLOAT(left), YASL_GETINT(right))));
+	} else if (YASL_ISINT(left) && YASL_ISFLOAT(right)) {
+		vm_setnum(slot, YASL_FLOAT(float_op(YASL_GETINT(left), YASL_GETFLOAT(right))));
+	} else {
+		// not numbers: go through the stack so that errors and overloading behave exactly as for the stack opcode.
+		int fp = vm->fp;
+		int res;
+		vm_push(vm, left);
+		vm_push(vm, right);
+		if ((res = vm_num_binop(vm, int_op, float_op, opstr, overload_name))) return res;
+		if ((res = vm_finish_call(vm, fp))) return res;
+		vm_reg_set(VM_FRAME(vm) + dst, vm_pop(vm));
+	}
+	return YASL_SUCCESS;
+}
+
+/*
+ * Computes left >= right (or left > right, if strict is set), with the same semantics as GE (or GT).
+ */
+static inline int vm_reg_cmp(struct VM *vm, struct YASL_Object left, struct YASL_Object right, int strict, int *result) {
+	if (YASL_ISINT(left) && YASL_ISINT(right)) {
+		*result = strict ? GT(YASL_GETINT(left), YASL_GETINT(right)) : GE(YASL_GETINT(left), YASL_GETINT(right));
+	} else if (YASL_ISNUM(left) && YASL_ISNUM(right)) {
+		yasl_float l = YASL_ISINT(left) ? (yasl_float) YASL_GETINT(left) : YASL_GETFLOAT(left);
+		yasl_float r = YASL_ISINT(right) ? (yasl_float) YASL_GETINT(right) : YASL_GETFLOAT(right);
+		*result = strict ? GT(l, r) : GE(l, r);
+	} else {
+		int res;
+		vm_push(vm, left);
+		vm_push(vm, right);
+		if ((res = strict ? vm_GT(vm) : vm_GE(vm))) return res;
+		*result = YASL_GETBOOL(vm_pop(vm));
+	}
+	return YASL_SUCCESS;
+}
+
+/*
+ * Fast paths for ADD, SUB, MUL, GT, GE and EQ on two ints (_II) or two floats (_FF). The result is written over the left
+ * operand in place with vm_setnum, without the refcounting vm_push does. Each returns 0, leaving
+ * the stack as it was, for any other operands, which go through the generic path (and overloading) instead.
+ */
+#define FAST_BINOP(name, is, get, box, op) \
+static inline int name(struct VM *vm) {\
+	struct YASL_Object *const slot = vm->stack + vm->sp - 1;\
+	if (!is(slot[0]) || !is(slot[1])) return 0;\
+	vm_setnum(slot, box(get(slot[0]) op get(slot[1])));\
+	vm->sp--;\
+	return 1;\
+}
+
+FAST_BINOP(vm_fast_ADD_II, YASL_ISINT, YASL_GETINT, YASL_INT, +)
+FAST_BINOP(vm_fast_SUB_II, YASL_ISINT, YASL_GETINT, YASL_INT, -)
+FAST_BINOP(vm_fast_MUL_II, YASL_ISINT, YASL_GETINT, YASL_INT, *)
+FAST_BINOP(vm_fast_GT_II, YASL_ISINT, YASL_GETINT, YASL_BOOL, >)
+FAST_BINOP(vm_fast_GE_II, YASL_ISINT, YASL_GETINT, YASL_BOOL, >=)
+FAST_BINOP(vm_fast_EQ_II, YASL_ISINT, YASL_GETINT, YASL_BOOL, ==)
+FAST_BINOP(vm_fast_ADD_FF, YASL_ISFLOAT, YASL_GETFLOAT, YASL_FLOAT, +)
+FAST_BINOP(vm_fast_SUB_FF, YASL_ISFLOAT, YASL_GETFLOAT, YASL_FLOAT, -)
+FAST_BINOP(vm_fast_MUL_FF, YASL_ISFLOAT, YASL_GETFLOAT, YASL_FLOAT, *)
+FAST_BINOP(vm_fast_GT_FF, YASL_ISFLOAT, YASL_GETFLOAT, YASL_BOOL, >)
+FAST_BINOP(vm_fast_GE_FF, YASL_ISFLOAT, YASL_GETFLOAT, YASL_BOOL, >=)
+FAST_BINOP(vm_fast_EQ_FF, YASL_ISFLOAT, YASL_GETFLOAT, YASL_BOOL, ==)
+
+/*
+ * Quickening. The first time ADD, SUB, MUL or GET runs, it rewrites itself in place in the code to a form specialised
+ * for the types of its operands, when there is one. A specialised instruction that sees other types rewrites itself
+ * back to the generic one, which specialises again for whatever it sees next. Only the opcode byte changes, so the
+ * code keeps its layout, and code loaded from a bytecode file can be rewritten since it is mapped copy-on-write.
+ */
+static inline void vm_quicken(struct VM *vm, const unsigned char opcode) {
+	vm->code[vm->pc - 1] = opcode;
+}
+
+// replaces the collection and key on top of the stack with result.
+static inline void vm_get_result(struct VM *vm, struct YASL_Object result) {
+	inc_ref(&result);
+	vm->sp--;
+	dec_ref(vm->stack + vm->sp);
+	vm->stack[vm->sp] = result;
+}
+
+static inline int vm_GET_TABLE_STR(struct VM *vm) {
+	const struct YASL_Object table = VM_PEEK(vm, vm->sp - 1);
+	const struct YASL_Object key = vm_peek(vm);
+	if (!YASL_ISTABLE(table) || !YASL_ISSTR(key)) return 0;
+	struct YASL_Object result = table_search(YASL_GETTABLE(table), key);
+	// keys that aren't in the table may still name a method.
+	if (YASL_GETTYPE(result) == Y_END) return 0;
+	vm_get_result(vm, result);
+	return 1;
+}
+
+static inline int vm_GET_LIST_INT(struct VM *vm) {
+	const struct YASL_Object list = VM_PEEK(vm, vm->sp - 1);
+	const struct YASL_Object index = vm_peek(vm);
+	if (!YASL_ISLIST(list) || !YASL_ISINT(index)) return 0;
+	const struct List *const ls = YASL_GETLIST(list);
+	yasl_int i = YASL_GETINT(index);
+	if (i < 0) i += ls->count;
+	if (i < 0 || i >= ls->count) return 0;
+	vm_get_result(vm, ls->items[i]);
+	return 1;
+}
+
+/*
+ * Superinstructions. Each behaves exactly like the sequence of stack instructions it replaces, but handles numbers
+ * without going through the stack, and falls back to that sequence for anything else.
+ */
+
+// adds (or subtracts, if sub is set) imm to the global or local at addr, as GLOAD/LLOAD, ICONST, ADD/SUB, GSTORE/LSTORE.
+static inline int vm_incr(struct VM *vm, int local, yasl_int addr, signed char imm, int sub) {
+	struct YASL_Object *slot = local ? vm->stack + vm->fp + 4 + addr : vm->globals + addr;
+	if (YASL_ISINT(*slot)) {
+		vm_setnum(slot, YASL_INT(sub ? YASL_GETINT(*slot) - imm : YASL_GETINT(*slot) + imm));
+	} else if (YASL_ISFLOAT(*slot)) {
+		*slot = YASL_FLOAT(sub ? YASL_GETFLOAT(*slot) - imm : YASL_GETFLOAT(*slot) + imm);
+	} else {
+		int fp = vm->fp;
+		int res;
+		vm_push(vm, *slot);
+		vm_pushint(vm, imm);
+		if (sub) res = vm_num_binop(vm, &int_sub, &float_sub, "-", OP_BIN_MINUS);
+		else res = vm_num_binop(vm, &int_add, &float_add, "+", OP_BIN_PLUS);
+		if (res || (res = vm_finish_call(vm, fp))) return res;
+		vm_reg_set(local ? vm->stack + vm->fp + 4 + addr : vm->globals + addr, vm_pop(vm));
+	}
+	return YASL_SUCCESS;
+}
+
+// pushes left + right, as two loads followed by ADD.
+static inline int vm_add_vars(struct VM *vm, struct YASL_Object left, struct YASL_Object right) {
+	if (YASL_ISINT(left) && YASL_ISINT(right)) {
+		vm_pushint(vm, YASL_GETINT(left) + YASL_GETINT(right));
+		return YASL_SUCCESS;
+	}
+	vm_push(vm, left);
+	vm_push(vm, right);
+	return vm_num_binop(vm, &int_add, &float_add, "+", OP_BIN_PLUS);
+}
+
+/*
+ * Pops the top two values of the stack, and sets result to whether the one below is >= the top one (or >, if strict
+ * is set), with the same semantics as GE (or GT).
+ */
+static inline int vm_cmp_top(struct VM *vm, int strict, int *result) {
+	struct YASL_Object left = VM_PEEK(vm, vm->sp - 1);
+	struct YASL_Object right = vm_peek(vm);
+	if (YASL_ISINT(left) && YASL_ISINT(right)) {
+		*result = strict ? GT(YASL_GETINT(left), YASL_GETINT(right)) : GE(YASL_GETINT(left), YASL_GETINT(right));
+		vm->sp -= 2;
+		return YASL_SUCCESS;
+	}
+	if (YASL_ISFLOAT(left) && YASL_ISFLOAT(right)) {
+		*result = strict ? GT(YASL_GETFLOAT(left), YASL_GETFLOAT(right)) : GE(YASL_GETFLOAT(left), YASL_GETFLOAT(right));
+		vm->sp -= 2;
+		return YASL_SUCCESS;
+	}
+	int res;
+	if ((res = strict ? vm_GT(vm) : vm_GE(vm))) return res;
+	*result = YASL_GETBOOL(vm_pop(vm));
+	return YASL_SUCCESS;
+}
+
+/*
+ * Opcode dispatch. With YASL_COMPUTED_GOTO, each handler jumps straight to the next one through a table of label
+ * addresses (a GNU extension supported by GCC and Clang). Otherwise, the portable switch inside vm_run is used.
+ * Handlers are written once using VM_CASE and end with VM_NEXT, so both engines run exactly the same code.
+ */
+#define VM_FETCH(vm) do {\
+		opcode = NCODE(vm);\
+		YASL_VM_DEBUG_LOG("----------------"\
+				  "opcode: %x\n"\
+				  "vm->sp, vm->fp, vm->next_fp: %d, %d, %d\n\n", opcode, vm->sp, vm->fp, vm->next_fp);\
+	} while (0)
+
+#if YASL_COMPUTED_GOTO
+#define VM_SWITCH(op)   goto *dispatch_table[op];
+#define VM_CASE(op)     L_ ## op
+#define VM_DEFAULT      L_UNKNOWN
+#define VM_NEXT()       do { VM_FETCH(vm); goto *dispatch_table[opcode]; } while (0)
+#define VM_LABEL(op)    [op] = &&L_ ## op
+
+// Label addresses and range initializers are GNU extensions, and the range initializer is overridden on purpose.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#ifdef __clang__
+#pragma GCC diagnostic ignored "-Winitializer-overrides"
+#else
+#pragma GCC diagnostic ignored "-Woverride-init"
+#endif
+#else
+#define VM_SWITCH(op)   switch (op)
+#define VM_CASE(op)     case op
+#define VM_DEFAULT      default
+#define VM_NEXT()       break
+#endif
+
 int vm_run(struct VM *vm) {
+	unsigned char opcode;
+	signed char offset;
+	yasl_int addr;
+	struct YASL_Object a, b, v;
+	yasl_int c;
+	yasl_float d;
+	int res;
+	struct YASL_Object *frame;
+	unsigned char dst;
+	int cmp;
+	int ret_fp;
+#if YASL_COMPUTED_GOTO
+	static void *const dispatch_table[256] = {
+		[0 ... 255] = &&L_UNKNOWN,
+		VM_LABEL(HALT),
+		VM_LABEL(NCONST),
+		VM_LABEL(BCONST_F),
+		VM_LABEL(BCONST_T),
+		VM_LABEL(FCONST),
+		VM_LABEL(ICONST_B1),
+		VM_LABEL(ICONST_B2),
+		VM_LABEL(ICONST_B4),
+		VM_LABEL(ICONST),
+		VM_LABEL(ICONST_M1),
+		VM_LABEL(ICONST_0),
+		VM_LABEL(ICONST_1),
+		VM_LABEL(ICONST_2),
+		VM_LABEL(ICONST_3),
+		VM_LABEL(ICONST_4),
+		VM_LABEL(ICONST_5),
+		VM_LABEL(DCONST),
+		VM_LABEL(DCONST_0),
+		VM_LABEL(DCONST_1),
+		VM_LABEL(DCONST_2),
+		VM_LABEL(DCONST_N),
+		VM_LABEL(DCONST_I),
+		VM_LABEL(R_MOV),
+		VM_LABEL(R_MOVI),
+		VM_LABEL(R_ADD),
+		VM_LABEL(R_SUB),
+		VM_LABEL(R_MUL),
+		VM_LABEL(R_ADDI),
+		VM_LABEL(R_SUBI),
+		VM_LABEL(R_BRGE),
+		VM_LABEL(R_BRGT),
+		VM_LABEL(R_BRGEI),
+		VM_LABEL(R_BRGTI),
+		VM_LABEL(INCR_GLOBAL),
+		VM_LABEL(INCR_LOCAL),
+		VM_LABEL(DECR_GLOBAL),
+		VM_LABEL(DECR_LOCAL),
+		VM_LABEL(ADD_GLOBALS),
+		VM_LABEL(ADD_LOCALS),
+		VM_LABEL(LT_BRF),
+		VM_LABEL(LE_BRF),
+		VM_LABEL(GT_BRF),
+		VM_LABEL(GE_BRF),
+		VM_LABEL(BOR),
+		VM_LABEL(BXOR),
+		VM_LABEL(BAND),
+		VM_LABEL(BANDNOT),
+		VM_LABEL(BNOT),
+		VM_LABEL(BSL),
+		VM_LABEL(BSR),
+		VM_LABEL(ADD),
+		VM_LABEL(SUB),
+		VM_LABEL(MUL),
+		VM_LABEL(EXP),
+		VM_LABEL(FDIV),
+		VM_LABEL(IDIV),
+		VM_LABEL(MOD),
+		VM_LABEL(NEG),
+		VM_LABEL(POS),
+		VM_LABEL(NOT),
+		VM_LABEL(LEN),
+		VM_LABEL(CNCT),
+		VM_LABEL(GT),
+		VM_LABEL(GE),
+		VM_LABEL(EQ),
+		VM_LABEL(ID),
+		VM_LABEL(SET),
+		VM_LABEL(GET),
+		VM_LABEL(ADD_II),
+		VM_LABEL(SUB_II),
+		VM_LABEL(MUL_II),
+		VM_LABEL(ADD_FF),
+		VM_LABEL(SUB_FF),
+		VM_LABEL(MUL_FF),
+		VM_LABEL(GET_TABLE_STR),
+		VM_LABEL(GET_LIST_INT),
+		VM_LABEL(SLICE),
+		VM_LABEL(NEWSPECIALSTR),
+		VM_LABEL(NEWSTR_1),
+		VM_LABEL(NEWSTR_2),
+		VM_LABEL(NEWSTR),
+		VM_LABEL(NEWTABLE),
+		VM_LABEL(NEWTABLE_N),
+		VM_LABEL(NEWLIST),
+		VM_LABEL(NEWLIST_N),
+		VM_LABEL(END),
+		VM_LABEL(DUP),
+		VM_LABEL(SWAP),
+		VM_LABEL(POP),
+		VM_LABEL(BR_8),
+		VM_LABEL(BRF_8),
+		VM_LABEL(BRT_8),
+		VM_LABEL(BRN_8),
+		VM_LABEL(BR_1),
+		VM_LABEL(BRF_1),
+		VM_LABEL(BRT_1),
+		VM_LABEL(BRN_1),
+		VM_LABEL(BR_2),
+		VM_LABEL(BRF_2),
+		VM_LABEL(BRT_2),
+		VM_LABEL(BRN_2),
+		VM_LABEL(BR_4),
+		VM_LABEL(BRF_4),
+		VM_LABEL(BRT_4),
+		VM_LABEL(BRN_4),
+		VM_LABEL(INITFOR),
+		VM_LABEL(ENDCOMP),
+		VM_LABEL(ENDFOR),
+		VM_LABEL(ITER_1),
+		VM_LABEL(ITER_2),
+		VM_LABEL(INIT_MC_SPECIAL),
+		VM_LABEL(INIT_MC),
+		VM_LABEL(INIT_CALL),
+		VM_LABEL(CALL),
+		VM_LABEL(RET),
+		VM_LABEL(GSTORE_1),
+		VM_LABEL(LSTORE_1),
+		VM_LABEL(GLOAD_1),
+		VM_LABEL(LLOAD_1),
+		VM_LABEL(GSTORE_2),
+		VM_LABEL(LSTORE_2),
+		VM_LABEL(GLOAD_2),
+		VM_LABEL(LLOAD_2),
+		VM_LABEL(PRINT),
+	};
+#endif
 	while (1) {
-		unsigned char opcode = NCODE(vm);        // fetch
-		signed char offset;
-		size_t size;
-		yasl_int addr;
-		struct YASL_Object a, b, v;
-		yasl_int c;
-		yasl_float d;
-		int res;
-		YASL_VM_DEBUG_LOG("----------------"
-				  "opcode: %x\n"
-				  "vm->sp, vm->fp, vm->next_fp: %d, %d, %d\n\n", opcode, vm->sp, vm->fp, vm->next_fp);
-		switch (opcode) {
-		case HALT:
+		VM_FETCH(vm);
+		VM_SWITCH(opcode) {
+		VM_CASE(HALT):
 			return YASL_SUCCESS;
-		case ICONST_M1:
-		case ICONST_0:
-		case ICONST_1:
-		case ICONST_2:
-		case ICONST_3:
-		case ICONST_4:
-		case ICONST_5:
+		VM_CASE(ICONST_M1):
+		VM_CASE(ICONST_0):
+		VM_CASE(ICONST_1):
+		VM_CASE(ICONST_2):
+		VM_CASE(ICONST_3):
+		VM_CASE(ICONST_4):
+		VM_CASE(ICONST_5):
 			vm_pushint(vm, opcode - ICONST_0); // make sure no changes to opcodes ruin this
-			break;
-		case DCONST_0:
-		case DCONST_1:
-		case DCONST_2:
+			VM_NEXT();
+		VM_CASE(DCONST_0):
+		VM_CASE(DCONST_1):
+		VM_CASE(DCONST_2):
 			vm_pushfloat(vm, opcode - DCONST_0); // make sure no changes to opcodes ruin this
-			break;
-		case DCONST_N:
+			VM_NEXT();
+		VM_CASE(DCONST_N):
 			vm_pushfloat(vm, NAN);
-			break;
-		case DCONST_I:
+			VM_NEXT();
+		VM_CASE(DCONST_I):
 			vm_pushfloat(vm, INFINITY);
-			break;
-		case DCONST:        // constants have native endianness
+			VM_NEXT();
+		VM_CASE(DCONST):        // constants have native endianness
 			d = vm_read_float(vm);
 			vm_pushfloat(vm, d);
-			break;
-		case ICONST:        // constants have native endianness
+			VM_NEXT();
+		VM_CASE(ICONST):        // constants have native endianness
 			c = vm_read_int(vm);
 			vm_pushint(vm, c);
-			break;
-		case BCONST_F:
-		case BCONST_T:
+			VM_NEXT();
+		VM_CASE(ICONST_B1):
+			c = vm_read_int8(vm);
+			vm_pushint(vm, c);
+			VM_NEXT();
+		VM_CASE(ICONST_B2):
+			c = vm_read_int16(vm);
+			vm_pushint(vm, c);
+			VM_NEXT();
+		VM_CASE(ICONST_B4):
+			c = vm_read_int32(vm);
+			vm_pushint(vm, c);
+			VM_NEXT();
+		VM_CASE(BCONST_F):
+		VM_CASE(BCONST_T):
 			vm_pushbool(vm, opcode & 0x01);
-			break;
-		case NCONST:
+			VM_NEXT();
+		VM_CASE(NCONST):
 			vm_pushundef(vm);
-			break;
-		case FCONST:
+			VM_NEXT();
+		VM_CASE(FCONST):
 			c = vm_read_int(vm);
 			vm_pushfn(vm, c);
-			break;
-		case BOR:
-			if ((res = vm_int_binop(vm, &bor, "|", OP_BIN_BAR))) return res;
-			break;
-		case BXOR:
-			if ((res = vm_int_binop(vm, &bxor, "^", OP_BIN_CARET))) return res;
-			break;
-		case BAND:
-			if ((res = vm_int_binop(vm, &band, "&", OP_BIN_AMP))) return res;
-			break;
-		case BANDNOT:
-			if ((res = vm_int_binop(vm, &bandnot, "&^", OP_BIN_AMPCARET))) return res;
-			break;
-		case BNOT:
-			if ((res = vm_int_unop(vm, &bnot, "^", OP_UN_CARET))) return res;
-			break;
-		case BSL:
-			if ((res = vm_int_binop(vm, &shift_left, "<<", OP_BIN_SHL))) return res;
-			break;
-		case BSR:
-			if ((res = vm_int_binop(vm, &shift_right, ">>", OP_BIN_SHR))) return res;
-			break;
-		case ADD:
-			if ((res = vm_num_binop(vm, &int_add, &float_add, "+", OP_BIN_PLUS))) return res;
-			break;
-		case MUL:
-			if ((res = vm_num_binop(vm, &int_mul, &float_mul, "*", OP_BIN_TIMES))) return res;
-			break;
-		case SUB:
-			if ((res = vm_num_binop(vm, &int_sub, &float_sub, "-", OP_BIN_MINUS))) return res;
-			break;
-		case FDIV:
-			if ((res = vm_fdiv(vm))) return res;   // handled differently because we always convert to float
-			break;
-		case IDIV:
-			if (YASL_ISINT(vm_peek(vm)) && YASL_GETINT(vm_peek(vm)) == 0) {
-				YASL_PRINT_ERROR_DIVIDE_BY_ZERO();
-				return YASL_DIVIDE_BY_ZERO_ERROR;
-				break;
-			}
-			if ((res = vm_int_binop(vm, &idiv, "//", OP_BIN_IDIV))) return res;
-			break;
-		case MOD:
-			// TODO: handle undefined C behaviour for negative numbers.
-			if (YASL_ISINT(vm_peek(vm)) && YASL_GETINT(vm_peek(vm)) == 0) {
-				YASL_PRINT_ERROR_DIVIDE_BY_ZERO();
-				return YASL_DIVIDE_BY_ZERO_ERROR;
-				break;
+			VM_NEXT();
+		VM_CASE(R_MOV):
+			frame = VM_FRAME(vm);
+			dst = NCODE(vm);
+			vm_reg_set(frame + dst, frame[NCODE(vm)]);
+			VM_NEXT();
+		VM_CASE(R_MOVI):
+			frame = VM_FRAME(vm);
+			dst = NCODE(vm);
+			offset = NCODE(vm);
+			vm_setnum(frame + dst, YASL_INT(offset));
+			VM_NEXT();
+		VM_CASE(R_ADD):
+			frame = VM_FRAME(vm);
+			dst = NCODE(vm);
+			a = frame[NCODE(vm)];
+			b = frame[NCODE(vm)];
+			if ((res = vm_reg_num_binop(vm, dst, a, b, &int_add, &float_add, "+", OP_BIN_PLUS))) return res;
+			VM_NEXT();
+		VM_CASE(R_SUB):
+			frame = VM_FRAME(vm);
+			dst = NCODE(vm);
+			a = frame[NCODE(vm)];
+			b = frame[NCODE(vm)];
+			if ((res = vm_reg_num_binop(vm, dst, a, b, &int_sub, &float_sub, "-", OP_BIN_MINUS))) return res;
+			VM_NEXT();
+		VM_CASE(R_MUL):
+			frame = VM_FRAME(vm);
+			dst = NCODE(vm);
+			a = frame[NCODE(vm)];
+			b = frame[NCODE(vm)];
+			if ((res = vm_reg_num_binop(vm, dst, a, b, &int_mul, &float_mul, "*", OP_BIN_TIMES))) return res;
+			VM_NEXT();
+		VM_CASE(R_ADDI):
+			frame = VM_FRAME(vm);
+			dst = NCODE(vm);
+			a = frame[NCODE(vm)];
+			offset = NCODE(vm);
+			if ((res = vm_reg_num_binop(vm, dst, a, YASL_INT(offset), &int_add, &float_add, "+", OP_BIN_PLUS))) return res;
+			VM_NEXT();
+		VM_CASE(R_SUBI):
+			frame = VM_FRAME(vm);
+			dst = NCODE(vm);
+			a = frame[NCODE(vm)];
+			offset = NCODE(vm);
+			if ((res = vm_reg_num_binop(vm, dst, a, YASL_INT(offset), &int_sub, &float_sub, "-", OP_BIN_MINUS))) return res;
+			VM_NEXT();
+		VM_CASE(R_BRGE):
+		VM_CASE(R_BRGT):
+			frame = VM_FRAME(vm);
+			a = frame[NCODE(vm)];
+			b = frame[NCODE(vm)];
+			c = vm_read_int(vm);
+			if ((res = vm_reg_cmp(vm, a, b, opcode == R_BRGT, &cmp))) return res;
+			if (cmp) vm->pc += c;
+			VM_NEXT();
+		VM_CASE(R_BRGEI):
+		VM_CASE(R_BRGTI):
+			frame = VM_FRAME(vm);
+			a = frame[NCODE(vm)];
+			offset = NCODE(vm);
+			c = vm_read_int(vm);
+			if ((res = vm_reg_cmp(vm, a, YASL_INT(offset), opcode == R_BRGTI, &cmp))) return res;
+			if (cmp) vm->pc += c;
+			VM_NEXT();
+		VM_CASE(INCR_GLOBAL):
+		VM_CASE(INCR_LOCAL):
+		VM_CASE(DECR_GLOBAL):
+		VM_CASE(DECR_LOCAL):
+			addr = NCODE(vm);
+			offset = NCODE(vm);
+			if ((res = vm_incr(vm, opcode & 0x01, addr, offset, opcode >= DECR_GLOBAL))) return res;
+			VM_NEXT();
+		VM_CASE(ADD_GLOBALS):
+			a = vm->globals[NCODE(vm)];
+			b = vm->globals[NCODE(vm)];
+			if ((res = vm_add_vars(vm, a, b))) return res;
+			VM_NEXT();
+		VM_CASE(ADD_LOCALS):
+			a = VM_PEEK(vm, vm->fp + 4 + NCODE(vm));
+			b = VM_PEEK(vm, vm->fp + 4 + NCODE(vm));
+			if ((res = vm_add_vars(vm, a, b))) return res;
+			VM_NEXT();
+		VM_CASE(LT_BRF):
+		VM_CASE(LE_BRF):
+			c = vm_read_int(vm);
+			if ((res = vm_cmp_top(vm, opcode == LE_BRF, &cmp))) return res;
+			if (cmp) vm->pc += c;
+			VM_NEXT();
+		VM_CASE(GT_BRF):
+		VM_CASE(GE_BRF):
+			c = vm_read_int(vm);
+			if ((res = vm_cmp_top(vm, opcode == GT_BRF, &cmp))) return res;
+			if (!cmp) vm->pc += c;
+			VM_NEXT();
+		VM_CASE(BOR):
+			if ((res = vm_BOR(vm))) return res;
+			VM_NEXT();
+		VM_CASE(BXOR):
+			if ((res = vm_BXOR(vm))) return res;
+			VM_NEXT();
+		VM_CASE(BAND):
+			if ((res = vm_BAND(vm))) return res;
+			VM_NEXT();
+		VM_CASE(BANDNOT):
+			if ((res = vm_BANDNOT(vm))) return res;
+			VM_NEXT();
+		VM_CASE(BNOT):
+			if ((res = vm_BNOT(vm))) return res;
+			VM_NEXT();
+		VM_CASE(BSL):
+			if ((res = vm_BSL(vm))) return res;
+			VM_NEXT();
+		VM_CASE(BSR):
+			if ((res = vm_BSR(vm))) return res;
+			VM_NEXT();
+		VM_CASE(ADD):
+			if (vm_fast_ADD_II(vm)) {
+				vm_quicken(vm, ADD_II);
+				VM_NEXT();
 			}
-			if ((res = vm_int_binop(vm, &modulo, "%", OP_BIN_MOD))) return res;
-			break;
-		case EXP:
-			if ((res = vm_pow(vm))) return res;
-			break;
-		case NEG:
-			if ((res = vm_num_unop(vm, &int_neg, &float_neg, "-", OP_UN_MINUS))) return res;
-			break;
-		case POS:
-			if ((res = vm_num_unop(vm, &int_pos, &float_pos, "+", OP_UN_PLUS))) return res;
-			break;
-		case NOT:
-			c = isfalsey(vm_pop(vm));
-			vm_pushbool(vm, c);
-			break;
-		case LEN:
-			v = vm_pop(vm);
-			if (YASL_ISSTR(v)) {
-				vm_pushint(vm, yasl_string_len(YASL_GETSTR(v)));
-			} else if (YASL_ISTABLE(v)) {
-				vm_pushint(vm, YASL_GETTABLE(v)->count);
-			} else if (YASL_ISLIST(v)) {
-				vm_pushint(vm, YASL_GETLIST(v)->count);
-			} else {
-				YASL_PRINT_ERROR_TYPE("len not supported for operand of type %s.\n",
-							      YASL_TYPE_NAMES[v.type]);
-				return YASL_TYPE_ERROR;
+			if (vm_fast_ADD_FF(vm)) {
+				vm_quicken(vm, ADD_FF);
+				VM_NEXT();
 			}
-			break;
-		case CNCT:
-		{
-			vm_stringify_top(vm);
-			String_t *b = vm_popstr(vm);
-			vm_stringify_top(vm);
-			String_t *a = vm_popstr(vm);
-
-			size = yasl_string_len((a)) + yasl_string_len((b));
-			char *ptr = malloc(size);
-			memcpy(ptr, (a)->str + (a)->start,
-			       yasl_string_len((a)));
-			memcpy(ptr + yasl_string_len((a)),
-			       ((b))->str + (b)->start,
-			       yasl_string_len((b)));
-			vm_pushstr(vm, str_new_sized_heap(0, size, ptr));
-			break;
-		}
-		case GT:
-			b = vm_pop(vm);
-			a = vm_pop(vm);
-			if (YASL_ISSTR(a) && YASL_ISSTR(b)) {
-				vm_pushbool(vm, yasl_string_cmp(YASL_GETSTR(a), YASL_GETSTR(b)) > 0);
-				break;
+			if ((res = vm_ADD(vm))) return res;
+			VM_NEXT();
+		VM_CASE(ADD_II):
+			if (vm_fast_ADD_II(vm)) VM_NEXT();
+			vm_quicken(vm, ADD);
+			if ((res = vm_ADD(vm))) return res;
+			VM_NEXT();
+		VM_CASE(ADD_FF):
+			if (vm_fast_ADD_FF(vm)) VM_NEXT();
+			vm_quicken(vm, ADD);
+			if ((res = vm_ADD(vm))) return res;
+			VM_NEXT();
+		VM_CASE(MUL):
+			if (vm_fast_MUL_II(vm)) {
+				vm_quicken(vm, MUL_II);
+				VM_NEXT();
 			}
-			if (!YASL_ISNUM(a) || !YASL_ISNUM(b)) {
-				YASL_PRINT_ERROR_TYPE("< and > not supported for operand of types %s and %s.\n",
-				       YASL_TYPE_NAMES[a.type],
-				       YASL_TYPE_NAMES[b.type]);
-				return YASL_TYPE_ERROR;
+			if (vm_fast_MUL_FF(vm)) {
+				vm_quicken(vm, MUL_FF);
+				VM_NEXT();
 			}
-			COMP(vm, a, b, GT, ">");
-			break;
-		case GE:
-			b = vm_pop(vm);
-			a = vm_pop(vm);
-			if (YASL_ISSTR(a) && YASL_ISSTR(b)) {
-				vm_push(vm, YASL_BOOL(yasl_string_cmp(YASL_GETSTR(a), YASL_GETSTR(b)) >= 0));
-				break;
+			if ((res = vm_MUL(vm))) return res;
+			VM_NEXT();
+		VM_CASE(MUL_II):
+			if (vm_fast_MUL_II(vm)) VM_NEXT();
+			vm_quicken(vm, MUL);
+			if ((res = vm_MUL(vm))) return res;
+			VM_NEXT();
+		VM_CASE(MUL_FF):
+			if (vm_fast_MUL_FF(vm)) VM_NEXT();
+			vm_quicken(vm, MUL);
+			if ((res = vm_MUL(vm))) return res;
+			VM_NEXT();
+		VM_CASE(SUB):
+			if (vm_fast_SUB_II(vm)) {
+				vm_quicken(vm, SUB_II);
+				VM_NEXT();
 			}
-			if (!YASL_ISNUM(a) || !YASL_ISNUM(b)) {
-				YASL_PRINT_ERROR_TYPE("<= and >= not supported for operand of types %s and %s.\n",
-				       YASL_TYPE_NAMES[a.type],
-				       YASL_TYPE_NAMES[b.type]);
-				return YASL_TYPE_ERROR;
+			if (vm_fast_SUB_FF(vm)) {
+				vm_quicken(vm, SUB_FF);
+				VM_NEXT();
 			}
-			COMP(vm, a, b, GE, ">=");
-			break;
-		case EQ:
-			b = vm_pop(vm);
-			a = vm_pop(vm);
-			v = isequal(a, b);
-			vm_push(vm, v);
-			break;
-		case ID: // TODO: clean-up
-			b = vm_pop(vm);
-			a = vm_pop(vm);
-			vm_push(vm, YASL_BOOL(a.type == b.type && YASL_GETINT(a) == YASL_GETINT(b)));
-			break;
-		case NEWSPECIALSTR:
+			if ((res = vm_SUB(vm))) return res;
+			VM_NEXT();
+		VM_CASE(SUB_II):
+			if (vm_fast_SUB_II(vm)) VM_NEXT();
+			vm_quicken(vm, SUB);
+			if ((res = vm_SUB(vm))) return res;
+			VM_NEXT();
+		VM_CASE(SUB_FF):
+			if (vm_fast_SUB_FF(vm)) VM_NEXT();
+			vm_quicken(vm, SUB);
+			if ((res = vm_SUB(vm))) return res;
+			VM_NEXT();
+		VM_CASE(FDIV):
+			if ((res = vm_fdiv(vm))) return res;   // handled differently because we always convert to float
+			VM_NEXT();
+		VM_CASE(IDIV):
+			if ((res = vm_IDIV(vm))) return res;
+			VM_NEXT();
+		VM_CASE(MOD):
+			if ((res = vm_MOD(vm))) return res;
+			VM_NEXT();
+		VM_CASE(EXP):
+			if ((res = vm_pow(vm))) return res;
+			VM_NEXT();
+		VM_CASE(NEG):
+			if ((res = vm_NEG(vm))) return res;
+			VM_NEXT();
+		VM_CASE(POS):
+			if ((res = vm_POS(vm))) return res;
+			VM_NEXT();
+		VM_CASE(NOT):
+			if ((res = vm_NOT(vm))) return res;
+			VM_NEXT();
+		VM_CASE(LEN):
+			if ((res = vm_LEN(vm))) return res;
+			VM_NEXT();
+		VM_CASE(CNCT):
+			if ((res = vm_CNCT(vm))) return res;
+			VM_NEXT();
+		VM_CASE(GT):
+			if (vm_fast_GT_II(vm) || vm_fast_GT_FF(vm)) VM_NEXT();
+			if ((res = vm_GT(vm))) return res;
+			VM_NEXT();
+		VM_CASE(GE):
+			if (vm_fast_GE_II(vm) || vm_fast_GE_FF(vm)) VM_NEXT();
+			if ((res = vm_GE(vm))) return res;
+			VM_NEXT();
+		VM_CASE(EQ):
+			if (vm_fast_EQ_II(vm) || vm_fast_EQ_FF(vm)) VM_NEXT();
+			if ((res = vm_EQ(vm))) return res;
+			VM_NEXT();
+		VM_CASE(ID):
+			if ((res = vm_ID(vm))) return res;
+			VM_NEXT();
+		VM_CASE(NEWSPECIALSTR):
 			if ((res = vm_NEWSPECIALSTR(vm))) return res;
-			break;
-		case NEWSTR:
+			VM_NEXT();
+		VM_CASE(NEWSTR):
 			if ((res = vm_NEWSTR(vm))) return res;
-			break;
-		case NEWTABLE: {
-			struct YASL_Object *table = YASL_Table();
-			struct Table *ht = YASL_GETTABLE(*table);
-			while (vm_peek(vm).type != Y_END) {
-				struct YASL_Object value = vm_pop(vm);
-				struct YASL_Object key = vm_pop(vm);
-				table_insert(ht, key, value);
-			}
-			vm_pop(vm);
-			vm_push(vm, *table);
-			free(table);
-			break;
-		}
-		case NEWLIST: {
-			struct RC_UserData *ls = ls_new();
-			while (vm_peek(vm).type != Y_END) {
-				ls_append(ls->data, vm_pop(vm));
-			}
-			ls_reverse(ls->data);
-			vm_pop(vm);
-			vm_push(vm, YASL_LIST(ls));
-			break;
-		}
-		case INITFOR:
-			vm_pushint(vm, 0);
-			vm_pushint(vm, vm->lp);
-			vm->lp = vm->sp - 2;
-			break;
-		case ENDCOMP:
-			a = vm_pop(vm);
-			vm->lp = vm_popint(vm);
-			vm_pop(vm);
-			vm_pop(vm);
-			vm_push(vm, a);
-			break;
-		case ENDFOR:
-			vm->lp = vm_popint(vm);
-			vm_pop(vm);
-			vm_pop(vm);
-			break;
-		case ITER_1:
-			switch (VM_PEEK(vm, vm->lp).type) {
-			case Y_LIST:
-				if (vm_peeklist(vm, vm->lp)->count <= vm_peekint(vm, vm->lp + 1)) {
-					vm_pushbool(vm, 0);
-				} else {
-					vm_push(vm, vm_peeklist(vm, vm->lp)->items[vm_peekint(vm, vm->lp + 1)++]);
-					vm_pushbool(vm, 1);
-				}
-				break;
-			case Y_TABLE:
-				while ((vm_peektable(vm, vm->lp)->items[vm_peekint(vm, vm->lp + 1)].key.type ==
-					Y_END ||
-					vm_peektable(vm, vm->lp)->items[vm_peekint(vm, vm->lp + 1)].key.type ==
-					Y_UNDEF
-				       ) &&
-					vm_peektable(vm, vm->lp)->size >
-				       (size_t) vm_peekint(vm, vm->lp + 1)) {
-					vm_peekint(vm, vm->lp + 1)++;
-				}
-				if (vm_peektable(vm, vm->lp)->size <=
-				    (size_t) vm_peekint(vm, vm->lp + 1)) {
-					vm_pushbool(vm, 0);
-					break;
-				}
-				vm_push(vm,
-					vm_peektable(vm, vm->lp)->items[vm_peekint(vm, vm->lp + 1)++].key);
-				vm_pushbool(vm, 1);
-				break;
-			case Y_STR:
-				if (yasl_string_len(vm_peekstr(vm, vm->lp)) <= vm_peekint(vm, vm->lp + 1)) {
-					vm_push(vm, YASL_BOOL(0));
-				} else {
-					int64_t i = vm_peekint(vm, vm->lp + 1);
-					vm_push(vm, YASL_STR(str_new_substring(i, i+1, vm_peekstr(vm, vm->lp))));
-					vm_peekint(vm, vm->lp + 1)++;
-					vm_pushbool(vm, 1);
-				}
-				break;
-			default:
-				YASL_PRINT_ERROR_TYPE("object of type %s is not iterable.\n", YASL_TYPE_NAMES[vm->stack[vm->lp].type]);
-				return YASL_TYPE_ERROR;
-			}
-			break;
-		case ITER_2:
+			VM_NEXT();
+		VM_CASE(NEWSTR_1):
+			if ((res = vm_NEWSTR_1(vm))) return res;
+			VM_NEXT();
+		VM_CASE(NEWSTR_2):
+			if ((res = vm_NEWSTR_2(vm))) return res;
+			VM_NEXT();
+		VM_CASE(NEWTABLE):
+			if ((res = vm_NEWTABLE(vm))) return res;
+			VM_NEXT();
+		VM_CASE(NEWTABLE_N):
+			if ((res = vm_NEWTABLE_N(vm))) return res;
+			VM_NEXT();
+		VM_CASE(NEWLIST):
+			if ((res = vm_NEWLIST(vm))) return res;
+			VM_NEXT();
+		VM_CASE(NEWLIST_N):
+			if ((res = vm_NEWLIST_N(vm))) return res;
+			VM_NEXT();
+		VM_CASE(INITFOR):
+			if ((res = vm_INITFOR(vm))) return res;
+			VM_NEXT();
+		VM_CASE(ENDCOMP):
+			if ((res = vm_ENDCOMP(vm))) return res;
+			VM_NEXT();
+		VM_CASE(ENDFOR):
+			if ((res = vm_ENDFOR(vm))) return res;
+			VM_NEXT();
+		VM_CASE(ITER_1):
+			if ((res = vm_ITER_1(vm))) return res;
+			VM_NEXT();
+		VM_CASE(ITER_2):
 			puts("NOT IMPLEMENTED");
 			exit(1);
-		case END:
+		VM_CASE(END):
 			vm_pushend(vm);
-			break;
-		case DUP: {
+			VM_NEXT();
+		VM_CASE(DUP): {
 			a = vm_peek(vm);
 			vm_push(vm, a);
-			break;
+			VM_NEXT();
 		}
-		case SWAP:
+		VM_CASE(SWAP):
 			if ((res = vm_SWAP(vm))) return res;
-			break;
-		case BR_8:
+			VM_NEXT();
+		VM_CASE(BR_8):
 			c = vm_read_int(vm);
 			vm->pc += c;
-			break;
-		case BRF_8:
+			VM_NEXT();
+		VM_CASE(BRF_8):
 			c = vm_read_int(vm);
 			v = vm_pop(vm);
 			if (isfalsey(v)) vm->pc += c;
-			break;
-		case BRT_8:
+			VM_NEXT();
+		VM_CASE(BRT_8):
 			c = vm_read_int(vm);
 			v = vm_pop(vm);
 			if (!(isfalsey(v))) vm->pc += c;
-			break;
-		case BRN_8:
+			VM_NEXT();
+		VM_CASE(BRN_8):
 			c = vm_read_int(vm);
 			v = vm_pop(vm);
 			if (!YASL_ISUNDEF(v)) vm->pc += c;
-			break;
-		case GLOAD_1:
+			VM_NEXT();
+		VM_CASE(BR_1):
+			c = vm_read_int8(vm);
+			vm->pc += c;
+			VM_NEXT();
+		VM_CASE(BRF_1):
+			c = vm_read_int8(vm);
+			v = vm_pop(vm);
+			if (isfalsey(v)) vm->pc += c;
+			VM_NEXT();
+		VM_CASE(BRT_1):
+			c = vm_read_int8(vm);
+			v = vm_pop(vm);
+			if (!(isfalsey(v))) vm->pc += c;
+			VM_NEXT();
+		VM_CASE(BRN_1):
+			c = vm_read_int8(vm);
+			v = vm_pop(vm);
+			if (!YASL_ISUNDEF(v)) vm->pc += c;
+			VM_NEXT();
+		VM_CASE(BR_2):
+			c = vm_read_int16(vm);
+			vm->pc += c;
+			VM_NEXT();
+		VM_CASE(BRF_2):
+			c = vm_read_int16(vm);
+			v = vm_pop(vm);
+			if (isfalsey(v)) vm->pc += c;
+			VM_NEXT();
+		VM_CASE(BRT_2):
+			c = vm_read_int16(vm);
+			v = vm_pop(vm);
+			if (!(isfalsey(v))) vm->pc += c;
+			VM_NEXT();
+		VM_CASE(BRN_2):
+			c = vm_read_int16(vm);
+			v = vm_pop(vm);
+			if (!YASL_ISUNDEF(v)) vm->pc += c;
+			VM_NEXT();
+		VM_CASE(BR_4):
+			c = vm_read_int32(vm);
+			vm->pc += c;
+			VM_NEXT();
+		VM_CASE(BRF_4):
+			c = vm_read_int32(vm);
+			v = vm_pop(vm);
+			if (isfalsey(v)) vm->pc += c;
+			VM_NEXT();
+		VM_CASE(BRT_4):
+			c = vm_read_int32(vm);
+			v = vm_pop(vm);
+			if (!(isfalsey(v))) vm->pc += c;
+			VM_NEXT();
+		VM_CASE(BRN_4):
+			c = vm_read_int32(vm);
+			v = vm_pop(vm);
+			if (!YASL_ISUNDEF(v)) vm->pc += c;
+			VM_NEXT();
+		VM_CASE(GLOAD_1):
 			addr = vm->code[vm->pc++];
 			vm_push(vm, vm->globals[addr]);
-			break;
-		case GSTORE_1:
+			VM_NEXT();
+		VM_CASE(GSTORE_1):
 			addr = vm->code[vm->pc++];
 			dec_ref(&vm->globals[addr]);
 			vm->globals[addr] = vm_pop(vm);
 			inc_ref(&vm->globals[addr]);
-			break;
-		case LLOAD_1:
-			offset = NCODE(vm);
-			vm_push(vm, VM_PEEK(vm, vm->fp + offset + 4));
-			break;
-		case LSTORE_1:
-			offset = NCODE(vm);
-			dec_ref(&VM_PEEK(vm, vm->fp + offset + 4));
-			VM_PEEK(vm, vm->fp + offset + 4) = vm_pop(vm);
-			inc_ref(&VM_PEEK(vm, vm->fp + offset + 4));
-			break;
-		case INIT_MC:
+			VM_NEXT();
+		VM_CASE(GLOAD_2):
+			addr = vm_read_addr16(vm);
+			vm_push(vm, vm->globals[addr]);
+			VM_NEXT();
+		VM_CASE(GSTORE_2):
+			addr = vm_read_addr16(vm);
+			dec_ref(&vm->globals[addr]);
+			vm->globals[addr] = vm_pop(vm);
+			inc_ref(&vm->globals[addr]);
+			VM_NEXT();
+		VM_CASE(LLOAD_1):
+			addr = vm->code[vm->pc++];
+			vm_push(vm, VM_PEEK(vm, vm->fp + addr + 4));
+			VM_NEXT();
+		VM_CASE(LSTORE_1):
+			addr = vm->code[vm->pc++];
+			dec_ref(&VM_PEEK(vm, vm->fp + addr + 4));
+			VM_PEEK(vm, vm->fp + addr + 4) = vm_pop(vm);
+			inc_ref(&VM_PEEK(vm, vm->fp + addr + 4));
+			VM_NEXT();
+		VM_CASE(LLOAD_2):
+			addr = vm_read_addr16(vm);
+			vm_push(vm, VM_PEEK(vm, vm->fp + addr + 4));
+			VM_NEXT();
+		VM_CASE(LSTORE_2):
+			addr = vm_read_addr16(vm);
+			dec_ref(&VM_PEEK(vm, vm->fp + addr + 4));
+			VM_PEEK(vm, vm->fp + addr + 4) = vm_pop(vm);
+			inc_ref(&VM_PEEK(vm, vm->fp + addr + 4));
+			VM_NEXT();
+		VM_CASE(INIT_MC):
 			if ((res = vm_INIT_MC(vm))) return res;
-			break;
-		case INIT_MC_SPECIAL:
+			VM_NEXT();
+		VM_CASE(INIT_MC_SPECIAL):
 			if ((res = vm_INIT_MC_SPECIAL(vm))) return res;
-			break;
-		case INIT_CALL:
+			VM_NEXT();
+		VM_CASE(INIT_CALL):
 			if ((res = vm_INIT_CALL(vm))) return res;
-			break;
-		case CALL:
+			VM_NEXT();
+		VM_CASE(CALL):
+			ret_fp = vm->fp;
 			if ((res = vm_CALL(vm))) return res;
-			break;
-		case RET:
-			// TODO: handle multiple returns
-			v = vm_pop(vm);
-			vm->sp = vm->fp + 3;
-			vm->next_fp = vm->stack[vm->fp + 3].value.ival;
-			vm_pop(vm);
-			vm->fp = vm_popint(vm);
-			vm->pc = vm_popint(vm);
-			vm_pop(vm);
-			vm_push(vm, v);
-			break;
-		case GET:
+			// a YASL function that has been compiled to machine code runs to its return right away.
+			if (vm->fp != ret_fp && (res = jit_run(vm)) != JIT_UNAVAILABLE && res) return res;
+			VM_NEXT();
+		VM_CASE(RET):
+			ret_fp = vm->fp;
+			if ((res = vm_RET(vm))) return res;
+			if (ret_fp == vm->stop_fp) return YASL_SUCCESS;
+			VM_NEXT();
+		VM_CASE(GET):
+			if (vm_GET_TABLE_STR(vm)) {
+				vm_quicken(vm, GET_TABLE_STR);
+				VM_NEXT();
+			}
+			if (vm_GET_LIST_INT(vm)) {
+				vm_quicken(vm, GET_LIST_INT);
+				VM_NEXT();
+			}
+			if ((res = vm_GET(vm))) return res;
+			VM_NEXT();
+		VM_CASE(GET_TABLE_STR):
+			if (vm_GET_TABLE_STR(vm)) VM_NEXT();
+			if (!YASL_ISTABLE(VM_PEEK(vm, vm->sp - 1)) || !YASL_ISSTR(vm_peek(vm))) vm_quicken(vm, GET);
+			if ((res = vm_GET(vm))) return res;
+			VM_NEXT();
+		VM_CASE(GET_LIST_INT):
+			if (vm_GET_LIST_INT(vm)) VM_NEXT();
+			if (!YASL_ISLIST(VM_PEEK(vm, vm->sp - 1)) || !YASL_ISINT(vm_peek(vm))) vm_quicken(vm, GET);
 			if ((res = vm_GET(vm))) return res;
-			break;
-		case SLICE:
+			VM_NEXT();
+		VM_CASE(SLICE):
 			if ((res = vm_SLICE(vm))) return res;
-			break;
-		case SET: {
-			vm->sp -= 2;
-			if (YASL_ISLIST(vm_peek(vm))) {
-				vm->sp += 2;
-				list___set((struct YASL_State *) vm);
-			} else if (YASL_ISTABLE(vm_peek(vm))) {
-				vm->sp += 2;
-				table___set((struct YASL_State *) vm);
-			} else {
-				vm->sp += 2;
-				YASL_PRINT_ERROR_TYPE("object of type %s is immutable.", YASL_TYPE_NAMES[vm_peek(vm).type]);
-				return YASL_TYPE_ERROR;
-			}
-			break;
-		}
-		case POP:
+			VM_NEXT();
+		VM_CASE(SET):
+			if ((res = vm_SET(vm))) return res;
+			VM_NEXT();
+		VM_CASE(POP):
 			vm_pop(vm);
-			break;
-		case PRINT:
-			yasl_print(vm);
-			break;
-		default:
+			VM_NEXT();
+		VM_CASE(PRINT):
+			if ((res = vm_PRINT(vm))) return res;
+			VM_NEXT();
+		VM_DEFAULT:
 			YASL_PRINT_ERROR("ERROR UNKNOWN OPCODE: %x\n", opcode);
 			return YASL_ERROR;
 		}
 	}
 }
+
+#if YASL_COMPUTED_GOTO
+#pragma GCC diagnostic pop
+#endif
+
+#undef VM_FETCH
+#undef VM_SWITCH
+#undef VM_CASE
+#undef VM_DEFAULT
+#undef VM_NEXT
+#undef VM_LABEL
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "hashtable/hashtable.h"
+#include "interpreter/collector.h"
 #include "yasl_conf.h"
 #include "opcode.h"
 
@@ -34,27 +35,30 @@
 #define vm_peektable(vm, offset) (YASL_GETTABLE(VM_PEEK(vm, offset)))
 #define vm_peekcfn(vm, offset) (YASL_GETCFN(VM_PEEK(vm, offset)))
 
+// slots addressed by register instructions: globals at top level, locals of the current function otherwise.
+#define VM_FRAME(vm) ((vm)->fp < 0 ? (vm)->globals : (vm)->stack + (vm)->fp + 4)
+
 #define BUFFER_SIZE 256
 #define NCODE(vm)    ((vm)->code[(vm)->pc++])     // get next bytecode
 
 #define GT(a, b) ((a) > (b))
 #define GE(a, b) ((a) >= (b))
 #define COMP(vm, a, b, f, str)  do {\
-                            if (a.type == Y_INT && b.type == Y_INT) {\
-                                c = f(a.value.ival, b.value.ival);\
+                            if (YASL_GETTYPE(a) == Y_INT && YASL_GETTYPE(b) == Y_INT) {\
+                                c = f(YASL_GETINT(a), YASL_GETINT(b));\
                             }\
-                            else if (a.type == Y_FLOAT && b.type == Y_INT) {\
-                                c = f(a.value.dval, (yasl_float)b.value.ival);\
+                            else if (YASL_GETTYPE(a) == Y_FLOAT && YASL_GETTYPE(b) == Y_INT) {\
+                                c = f(YASL_GETFLOAT(a), (yasl_float)YASL_GETINT(b));\
                             }\
-                            else if (a.type == Y_INT && b.type == Y_FLOAT) {\
-                                c = f((yasl_float)a.value.ival, (b).value.dval);\
+                            else if (YASL_GETTYPE(a) == Y_INT && YASL_GETTYPE(b) == Y_FLOAT) {\
+                                c = f((yasl_float)YASL_GETINT(a), YASL_GETFLOAT((b)));\
                             }\
-                            else if (a.type == Y_FLOAT && b.type == Y_FLOAT) {\
-                                c = f(a.value.dval, (b).value.dval);\
+                            else if (YASL_GETTYPE(a) == Y_FLOAT && YASL_GETTYPE(b) == Y_FLOAT) {\
+                                c = f(YASL_GETFLOAT(a), YASL_GETFLOAT((b)));\
                             }\
                             else {\
                                 printf("TypeError: %s not supported for operands of types %s and %s.\n", str,\
-                                        YASL_TYPE_NAMES[a.type], YASL_TYPE_NAMES[b.type]);\
+                                        YASL_TYPE_NAMES[YASL_GETTYPE(a)], YASL_TYPE_NAMES[YASL_GETTYPE(b)]);\
                                 return YASL_TYPE_ERROR;\
                             }\
                             vm_pushbool(vm, c);} while(0);
@@ -69,20 +73,78 @@ struct VM {
 	int fp;                        // frame pointer
 	int next_fp;
 	int lp;                        // foreach pointer
+	int stop_fp;                   // frame whose return ends the current nested vm_run, or -1
+	struct Table *strings;            // interned strings, each mapped to itself
+	String_t **constants;             // interned string constants of the loaded bytecode
+	size_t num_constants;
 	String_t *special_strings[NUM_SPECIAL_STRINGS];
 	struct Table **builtins_htable;   // htable of builtin methods
+	struct JIT *jit;               // functions compiled to machine code, or NULL if the JIT is off
+	struct Collector gc;           // cycle collector for the lists and tables made by this VM
 };
 
 void vm_init(struct VM *vm, unsigned char *code, int pc0, size_t datasize);
+void vm_grow_globals(struct VM *vm, size_t num_globals);
 
 void vm_cleanup(struct VM *vm);
 
+String_t *vm_intern(struct VM *vm, const char *chars, const size_t len);
+void vm_load_constants(struct VM *vm);
+
 int vm_stringify_top(struct VM *vm);
 
 struct YASL_Object vm_pop(struct VM *vm);
 void vm_push(struct VM *vm, struct YASL_Object val);
 
 int vm_run(struct VM *vm);
+int vm_finish_call(struct VM *vm, int fp);
+
+// handlers of single instructions, shared by vm_run and the JIT.
+int vm_ADD(struct VM *vm);
+int vm_SUB(struct VM *vm);
+int vm_MUL(struct VM *vm);
+int vm_fdiv(struct VM *vm);
+int vm_IDIV(struct VM *vm);
+int vm_MOD(struct VM *vm);
+int vm_pow(struct VM *vm);
+int vm_BOR(struct VM *vm);
+int vm_BXOR(struct VM *vm);
+int vm_BAND(struct VM *vm);
+int vm_BANDNOT(struct VM *vm);
+int vm_BSL(struct VM *vm);
+int vm_BSR(struct VM *vm);
+int vm_BNOT(struct VM *vm);
+int vm_NEG(struct VM *vm);
+int vm_POS(struct VM *vm);
+int vm_NOT(struct VM *vm);
+int vm_LEN(struct VM *vm);
+int vm_CNCT(struct VM *vm);
+int vm_GT(struct VM *vm);
+int vm_GE(struct VM *vm);
+int vm_EQ(struct VM *vm);
+int vm_ID(struct VM *vm);
+int vm_NEWSPECIALSTR(struct VM *vm);
+int vm_NEWSTR(struct VM *vm);
+int vm_NEWSTR_1(struct VM *vm);
+int vm_NEWSTR_2(struct VM *vm);
+int vm_NEWTABLE(struct VM *vm);
+int vm_NEWTABLE_N(struct VM *vm);
+int vm_NEWLIST(struct VM *vm);
+int vm_NEWLIST_N(struct VM *vm);
+int vm_INITFOR(struct VM *vm);
+int vm_ENDCOMP(struct VM *vm);
+int vm_ENDFOR(struct VM *vm);
+int vm_ITER_1(struct VM *vm);
+int vm_SWAP(struct VM *vm);
+int vm_GET(struct VM *vm);
+int vm_SET(struct VM *vm);
+int vm_SLICE(struct VM *vm);
+int vm_INIT_MC(struct VM *vm);
+int vm_INIT_MC_SPECIAL(struct VM *vm);
+int vm_INIT_CALL(struct VM *vm);
+int vm_CALL(struct VM *vm);
+int vm_RET(struct VM *vm);
+int vm_PRINT(struct VM *vm);
 
 struct Table *undef_builtins(struct VM *vm);
 struct Table *float_builtins(struct VM *vm);
@@ -6,6 +6,7 @@
 #include "hashtable/hashtable.h"
 #include "interpreter/float_methods.h"
 #include "interpreter/userdata.h"
+#include "slab/slab.h"
 
 char *float64_to_str(double d);
 
@@ -29,10 +30,10 @@ const char *YASL_TYPE_NAMES[] = {
 };
 
 struct CFunction_s *new_cfn(int (*value)(struct YASL_State *), int num_args) {
-    struct CFunction_s *fn = malloc(sizeof(struct CFunction_s));
+    struct CFunction_s *fn = slab_alloc(sizeof(struct CFunction_s));
     fn->value = value;
     fn->num_args = num_args;
-    fn->rc = rc_new();
+    fn->rc = NEW_RC();
     return fn;
 }
 
@@ -40,79 +41,78 @@ void cfn_del_data(struct CFunction_s *cfn) {
 }
 
 void cfn_del_rc(struct CFunction_s *cfn) {
-    rc_del(cfn->rc);
-    free(cfn);
+    slab_free(cfn, sizeof(struct CFunction_s));
 }
 
+#if YASL_NAN_BOXING
+struct YASL_Object yasl_box_bigint(const yasl_int i) {
+	struct BigInt_s *bigint = malloc(sizeof(struct BigInt_s));
+	bigint->rc = NEW_RC();
+	bigint->value = i;
+	return yasl_box(Y_INT, YASL_NANBOX_BIGINT | (uintptr_t) bigint >> 3);
+}
+
+void bigint_del(struct BigInt_s *bigint) {
+	free(bigint);
+}
+#endif
+
 struct YASL_Object *YASL_Undef(void) {
     struct YASL_Object *undef = malloc(sizeof(struct YASL_Object));
-    undef->type = Y_UNDEF;
-    undef->value.ival = 0;
+    *undef = YASL_UNDEF();
     return undef;
 }
 struct YASL_Object *YASL_Float(double value) {
     struct YASL_Object *num = malloc(sizeof(struct YASL_Object));
-    num->type = Y_FLOAT;
-    num->value.dval = value;
+    *num = YASL_FLOAT(value);
     return num;
 }
 
 struct YASL_Object *YASL_Integer(int64_t value) {
     struct YASL_Object *integer = malloc(sizeof(struct YASL_Object));
-    integer->type = Y_INT;
-    integer->value.ival = value;
+    *integer = YASL_INT(value);
     return integer;
 }
 
 struct YASL_Object *YASL_Boolean(int value) {
     struct YASL_Object *boolean = malloc(sizeof(struct YASL_Object));
-    boolean->type = Y_BOOL;
-    boolean->value.ival = value;
+    *boolean = YASL_BOOL(value);
     return boolean;
 }
 
 struct YASL_Object *YASL_String(String_t *str) {
     struct YASL_Object *string = malloc(sizeof(struct YASL_Object));
-    string->type = Y_STR;
-    string->value.sval = str;
+    *string = YASL_STR(str);
     return string;
 }
 
 struct YASL_Object *YASL_Table() {
     struct YASL_Object *table = malloc(sizeof(struct YASL_Object));
-    table->type = Y_TABLE;
-    table->value.uval = rcht_new();
+    *table = YASL_TABLE(rcht_new(NULL));
     return table;
 }
 
 struct YASL_Object *YASL_UserPointer(void *userpointer) {
     struct YASL_Object *userptr = malloc(sizeof(struct YASL_Object));
-    userptr->type = Y_USERPTR;
-    userptr->value.pval = userpointer;
+    *userptr = YASL_USERPTR(userpointer);
     return userptr;
 }
 
 struct YASL_Object *YASL_UserData(void *userdata, int tag, void (*destructor)(void *)) {
     struct YASL_Object *obj = malloc(sizeof(struct YASL_Object));
-    obj->type = Y_USERDATA;
-    obj->value.uval = ud_new(userdata, tag, destructor);
+    *obj = YASL_USERDATA(ud_new(userdata, tag, destructor));
     return obj;
 }
 
 struct YASL_Object *YASL_Function(int64_t index) {
     struct YASL_Object *fn = malloc(sizeof(struct YASL_Object));
-    fn->type = Y_FN;
-    fn->value.ival = index;
+    *fn = YASL_FN(index);
     return fn;
 }
 
 struct YASL_Object *YASL_CFunction(int (*value)(struct YASL_State *), int num_args) {
     struct YASL_Object *fn = malloc(sizeof(struct YASL_Object));
-    fn->type = Y_CFN;
-    fn->value.pval = malloc(sizeof(struct CFunction_s));
-    fn->value.cval->value = value;
-    fn->value.cval->num_args = num_args;
-    fn->value.cval->rc = rc_new();
+    *fn = YASL_CFN(value, num_args);
     return fn;
 }
 
@@ -122,21 +122,21 @@ int yasl_object_cmp(struct YASL_Object a, struct YASL_Object b) {
 	} else if (YASL_ISNUM(a) && YASL_ISNUM(b)) {
 		double aVal, bVal;
 		if(YASL_ISINT(a)) {
-			aVal = a.value.ival;
+			aVal = YASL_GETINT(a);
 		} else {
-			aVal = a.value.dval;
+			aVal = YASL_GETFLOAT(a);
 		}
 		if(YASL_ISINT(b)) {
-			bVal = b.value.ival;
+			bVal = YASL_GETINT(b);
 		} else {
-			bVal = b.value.dval;
+			bVal = YASL_GETFLOAT(b);
 		}
 
 		if (aVal < bVal) return -1;
 		if (aVal > bVal) return 1;
 		return 0;
 	} else {
-		printf("Cannot apply object compare to types %s and %s.\n", YASL_TYPE_NAMES[a.type], YASL_TYPE_NAMES[b.type]);
+		printf("Cannot apply object compare to types %s and %s.\n", YASL_TYPE_NAMES[YASL_GETTYPE(a)], YASL_TYPE_NAMES[YASL_GETTYPE(b)]);
 		exit(-1);
 	}
 }
@@ -155,7 +155,7 @@ struct YASL_Object isequal(struct YASL_Object a, struct YASL_Object b) {
         if (YASL_ISUNDEF(a) && YASL_ISUNDEF(b)) {
             return TRUE_C;
         }
-        switch(a.type) {
+        switch(YASL_GETTYPE(a)) {
         case Y_BOOL:
             if (YASL_ISBOOL(b)) {
                 if (YASL_GETBOOL(a) == YASL_GETBOOL(b)) {
@@ -209,16 +209,16 @@ struct YASL_Object isequal(struct YASL_Object a, struct YASL_Object b) {
             } else if (YASL_ISFLOAT(a) && YASL_ISFLOAT(b)) {
                 c = YASL_GETFLOAT(a) == YASL_GETFLOAT(b);
             } else {
-                // printf("== and != not supported for operands of types %x and %x.\n", a.type, b.type);
+                // printf("== and != not supported for operands of types %x and %x.\n", YASL_GETTYPE(a), YASL_GETTYPE(b));
                 return UNDEF_C;
             }
-            return (struct YASL_Object) { .type = Y_BOOL, .value.ival = c};
+            return YASL_BOOL(c);
         }
 }
 
 int print(struct YASL_Object v) {
     int64_t i;
-    switch (v.type) {
+    switch (YASL_GETTYPE(v)) {
         case Y_INT:
             printf("%" PRId64 "", YASL_GETINT(v));
             //printf("int64: %" PRId64 "\n", v.value);
@@ -252,13 +252,13 @@ int print(struct YASL_Object v) {
             printf("<fn>"); //, (void*)YASL_GETFN(v));
             break;
         case Y_CFN:
-            printf("<fn>"); //, (void*)(*(char**)&v.value.cval->value));
+            printf("<fn>"); //, (void*)(*(char**)&YASL_GETCFN(v)->value));
             break;
         case Y_USERPTR:
             printf("0x%p", YASL_GETUSERPTR(v));
             break;
         default:
-            printf("Error, unknown type: %x", v.type);
+            printf("Error, unknown type: %x", YASL_GETTYPE(v));
             return -1;
     }
     return 0;
@@ -1,48 +1,10 @@
 #pragma once
 
+#include <string.h>
+
 #include "yasl_conf.h"
 #include "YASL_string.h"
 
-#define UNDEF_C ((struct YASL_Object) { .type = Y_UNDEF, .value.ival = 0 })
-#define FALSE_C ((struct YASL_Object) { .type = Y_BOOL, .value.ival = 0 })
-#define TRUE_C ((struct YASL_Object) { .type = Y_BOOL, .value.ival = 1 })
-
-#define YASL_END() ((struct YASL_Object) { .type = Y_END })
-#define YASL_UNDEF() ((struct YASL_Object) { .type = Y_UNDEF })
-#define YASL_FLOAT(d) ((struct YASL_Object) { .type = Y_FLOAT, .value.dval = d })
-#define YASL_INT(i) ((struct YASL_Object) { .type = Y_INT, .value.ival = i })
-#define YASL_BOOL(b) ((struct YASL_Object) { .type = Y_BOOL, .value.ival = b })
-#define YASL_STR(s) ((struct YASL_Object) { .type = Y_STR, .value.sval = s })
-#define YASL_LIST(l) ((struct YASL_Object) { .type = Y_LIST, .value.uval = l })
-#define YASL_TABLE(t) ((struct YASL_Object) { .type = Y_TABLE, .value.uval = t })
-#define YASL_USERDATA(p) ((struct YASL_Object) { .type = Y_USERDATA, .value.uval = p })
-#define YASL_USERPTR(p) ((struct YASL_Object) { .type = Y_USERPTR, .value.pval = p })
-#define YASL_FN(f) ((struct YASL_Object) { .type = Y_FN, .value.ival = f })
-#define YASL_CFN(f, n) ((struct YASL_Object) { .type = Y_CFN, .value.cval = new_cfn(f, n) })
-
-#define YASL_ISUNDEF(v) ((v).type == Y_UNDEF)
-#define YASL_ISFLOAT(v) ((v).type == Y_FLOAT)
-#define YASL_ISINT(v) ((v).type == Y_INT)
-#define YASL_ISNUM(v) (YASL_ISINT(v) || YASL_ISFLOAT(v))
-#define YASL_ISBOOL(v) ((v).type == Y_BOOL)
-#define YASL_ISSTR(v) ((v).type == Y_STR)
-#define YASL_ISLIST(v) ((v).type == Y_LIST)
-#define YASL_ISTABLE(v) ((v).type == Y_TABLE)
-#define YASL_ISUSERDATA(v) ((v).type == Y_USERDATA)
-#define YASL_ISUSERPTR(v) ((v).type == Y_USERPTR)
-#define YASL_ISFN(v) ((v).type == Y_FN)
-#define YASL_ISCFN(v) ((v).type == Y_CFN)
-
-#define YASL_GETFLOAT(v) ((v).value.dval)
-#define YASL_GETINT(v) ((v).value.ival)
-#define YASL_GETBOOL(v) ((v).value.ival)
-#define YASL_GETSTR(v) ((v).value.sval)
-#define YASL_GETLIST(v) ((struct List *)((v).value.uval->data))
-#define YASL_GETTABLE(v) ((struct Table *)((v).value.uval->data))
-#define YASL_GETUSERDATA(v) ((v).value.uval)
-#define YASL_GETUSERPTR(v) ((v).value.pval)
-#define YASL_GETFN(v) ((v).value.ival)
-#define YASL_GETCFN(v) ((v).value.cval)
 
 struct YASL_State;
 
@@ -74,7 +36,7 @@ typedef enum {
 
 struct RC_UserData;
 struct CFunction_s {
-    struct RC *rc;
+    struct RC rc;
     int num_args;
     int (*value)(struct YASL_State *);
 };
@@ -83,6 +45,130 @@ struct CFunction_s *new_cfn(int (*value)(struct YASL_State *), int num_args);
 void cfn_del_rc(struct CFunction_s *cfn);
 void cfn_del_data(struct CFunction_s *cfn);
 
+#if YASL_NAN_BOXING
+
+/*
+ * NaN-boxed layout, 8 bytes per value. A float is stored as its own bits. Every other value is a quiet NaN with the
+ * sign bit set: 13 set bits, then a 4-bit type tag, then a 47-bit payload holding the int, bool, function address or
+ * pointer. Floats that are NaN are stored as the positive quiet NaN, so that they can't be mistaken for a boxed value.
+ * The stored bits are xor'd with YASL_NANBOX_KEY, so that zeroed memory holds undef, as it does in the default layout.
+ * Ints that fit in 46 bits are stored in the payload. Wider ones are boxed on the heap, in a refcounted BigInt_s, and
+ * the payload holds bit 46 set and the box's address shifted right by 3. A given int is always stored the same way.
+ */
+struct YASL_Object {
+    uint64_t bits;
+};
+
+#define YASL_NANBOX_KEY 0xFFF8000000000000
+#define YASL_NANBOX_PAYLOAD 0x00007FFFFFFFFFFF
+#define YASL_NANBOX_CANONICAL_NAN 0x7FF8000000000000
+#define YASL_NANBOX_BIGINT 0x0000400000000000          // set in the payload of an int that is boxed on the heap
+#define YASL_NANBOX_SMALLINT_MIN (-((yasl_int) 1 << 45))
+#define YASL_NANBOX_SMALLINT_MAX (((yasl_int) 1 << 45) - 1)
+#define YASL_NANBOX_TAG(v) ((v).bits >> 47)            // the type tag of a boxed value, 16 or more for a float
+
+static inline struct YASL_Object yasl_box(const YASL_Types type, const uint64_t payload) {
+	struct YASL_Object v = { ((uint64_t) type & 0xF) << 47 | (payload & YASL_NANBOX_PAYLOAD) };
+	return v;
+}
+
+static inline struct YASL_Object yasl_box_float(const yasl_float d) {
+	struct YASL_Object v;
+	memcpy(&v.bits, &d, sizeof(v.bits));
+	if (d != d) v.bits = YASL_NANBOX_CANONICAL_NAN;
+	v.bits ^= YASL_NANBOX_KEY;
+	return v;
+}
+
+struct BigInt_s {
+	struct RC rc;
+	yasl_int value;
+};
+
+struct YASL_Object yasl_box_bigint(const yasl_int i);
+void bigint_del(struct BigInt_s *bigint);
+
+static inline struct YASL_Object yasl_box_int(const yasl_int i) {
+	if (i < YASL_NANBOX_SMALLINT_MIN || i > YASL_NANBOX_SMALLINT_MAX) return yasl_box_bigint(i);
+	return yasl_box(Y_INT, (uint64_t) i & ~YASL_NANBOX_BIGINT);
+}
+
+static inline yasl_float yasl_unbox_float(const struct YASL_Object v) {
+	const uint64_t bits = v.bits ^ YASL_NANBOX_KEY;
+	yasl_float d;
+	memcpy(&d, &bits, sizeof(d));
+	return d;
+}
+
+static inline YASL_Types yasl_unbox_type(const struct YASL_Object v) {
+	const uint64_t tag = YASL_NANBOX_TAG(v);
+	return tag >= 16 ? Y_FLOAT : tag == 15 ? Y_END : (YASL_Types) tag;
+}
+
+#define yasl_unbox_payload(v) ((yasl_int) ((int64_t) ((v).bits << 17) >> 17))
+#define yasl_unbox_ptr(v) ((void *) (uintptr_t) ((v).bits & YASL_NANBOX_PAYLOAD))
+
+#define YASL_ISBIGINT(v) (((v).bits >> 46) == ((uint64_t) Y_INT << 1 | 1))
+#define YASL_GETBIGINT(v) ((struct BigInt_s *) (uintptr_t) (((v).bits & (YASL_NANBOX_BIGINT - 1)) << 3))
+
+static inline yasl_int yasl_unbox_int(const struct YASL_Object v) {
+	if (YASL_ISBIGINT(v)) return YASL_GETBIGINT(v)->value;
+	return (yasl_int) ((int64_t) (v.bits << 18) >> 18);
+}
+
+#define UNDEF_C yasl_box(Y_UNDEF, 0)
+#define FALSE_C yasl_box(Y_BOOL, 0)
+#define TRUE_C yasl_box(Y_BOOL, 1)
+
+#define YASL_END() yasl_box(Y_END, 0)
+#define YASL_UNDEF() yasl_box(Y_UNDEF, 0)
+#define YASL_FLOAT(d) yasl_box_float(d)
+#define YASL_INT(i) yasl_box_int(i)
+#define YASL_BOOL(b) yasl_box(Y_BOOL, (uint64_t) (b))
+#define YASL_STR(s) yasl_box(Y_STR, (uintptr_t) (s))
+#define YASL_LIST(l) yasl_box(Y_LIST, (uintptr_t) (l))
+#define YASL_TABLE(t) yasl_box(Y_TABLE, (uintptr_t) (t))
+#define YASL_USERDATA(p) yasl_box(Y_USERDATA, (uintptr_t) (p))
+#define YASL_USERPTR(p) yasl_box(Y_USERPTR, (uintptr_t) (p))
+#define YASL_FN(f) yasl_box(Y_FN, (uint64_t) (f))
+#define YASL_CFN(f, n) yasl_box(Y_CFN, (uintptr_t) new_cfn(f, n))
+#define YASL_CFN_OBJ(c) yasl_box(Y_CFN, (uintptr_t) (c))
+
+// the same value, with its type changed to type. Only used to switch between strong and weak references.
+#define YASL_RETYPE(v, type) yasl_box(type, (v).bits)
+
+#define YASL_GETTYPE(v) yasl_unbox_type(v)
+
+#define YASL_ISEND(v) (YASL_NANBOX_TAG(v) == 15)
+#define YASL_ISUNDEF(v) (YASL_NANBOX_TAG(v) == Y_UNDEF)
+#define YASL_ISFLOAT(v) (YASL_NANBOX_TAG(v) >= 16)
+#define YASL_ISINT(v) (YASL_NANBOX_TAG(v) == Y_INT)
+#define YASL_ISBOOL(v) (YASL_NANBOX_TAG(v) == Y_BOOL)
+#define YASL_ISSTR(v) (YASL_NANBOX_TAG(v) == Y_STR)
+#define YASL_ISLIST(v) (YASL_NANBOX_TAG(v) == Y_LIST)
+#define YASL_ISTABLE(v) (YASL_NANBOX_TAG(v) == Y_TABLE)
+#define YASL_ISUSERDATA(v) (YASL_NANBOX_TAG(v) == Y_USERDATA)
+#define YASL_ISUSERPTR(v) (YASL_NANBOX_TAG(v) == Y_USERPTR)
+#define YASL_ISFN(v) (YASL_NANBOX_TAG(v) == Y_FN)
+#define YASL_ISCFN(v) (YASL_NANBOX_TAG(v) == Y_CFN)
+
+#define YASL_GETFLOAT(v) yasl_unbox_float(v)
+#define YASL_GETINT(v) yasl_unbox_int(v)
+#define YASL_GETBOOL(v) yasl_unbox_payload(v)
+#define YASL_GETSTR(v) ((String_t *) yasl_unbox_ptr(v))
+#define YASL_GETLIST(v) ((struct List *) ((struct RC_UserData *) yasl_unbox_ptr(v))->data)
+#define YASL_GETTABLE(v) ((struct Table *) ((struct RC_UserData *) yasl_unbox_ptr(v))->data)
+#define YASL_GETUSERDATA(v) ((struct RC_UserData *) yasl_unbox_ptr(v))
+#define YASL_GETUSERPTR(v) yasl_unbox_ptr(v)
+#define YASL_GETFN(v) yasl_unbox_payload(v)
+#define YASL_GETCFN(v) ((struct CFunction_s *) yasl_unbox_ptr(v))
+
+// whether a and b are the same value, as for ===. Ints are compared by value, since equal ones may be separate boxes.
+#define YASL_ISIDENTICAL(a, b) ((a).bits == (b).bits ||\
+		(YASL_ISBIGINT(a) && YASL_ISBIGINT(b) && YASL_GETBIGINT(a)->value == YASL_GETBIGINT(b)->value))
+
+#else
+
 struct YASL_Object {
     YASL_Types type;
     union {
@@ -95,6 +181,62 @@ struct YASL_Object {
     } value;
 };
 
+#define UNDEF_C ((struct YASL_Object) { .type = Y_UNDEF, .value.ival = 0 })
+#define FALSE_C ((struct YASL_Object) { .type = Y_BOOL, .value.ival = 0 })
+#define TRUE_C ((struct YASL_Object) { .type = Y_BOOL, .value.ival = 1 })
+
+#define YASL_END() ((struct YASL_Object) { .type = Y_END })
+#define YASL_UNDEF() ((struct YASL_Object) { .type = Y_UNDEF })
+#define YASL_FLOAT(d) ((struct YASL_Object) { .type = Y_FLOAT, .value.dval = d })
+#define YASL_INT(i) ((struct YASL_Object) { .type = Y_INT, .value.ival = i })
+#define YASL_BOOL(b) ((struct YASL_Object) { .type = Y_BOOL, .value.ival = b })
+#define YASL_STR(s) ((struct YASL_Object) { .type = Y_STR, .value.sval = s })
+#define YASL_LIST(l) ((struct YASL_Object) { .type = Y_LIST, .value.uval = l })
+#define YASL_TABLE(t) ((struct YASL_Object) { .type = Y_TABLE, .value.uval = t })
+#define YASL_USERDATA(p) ((struct YASL_Object) { .type = Y_USERDATA, .value.uval = p })
+#define YASL_USERPTR(p) ((struct YASL_Object) { .type = Y_USERPTR, .value.pval = p })
+#define YASL_FN(f) ((struct YASL_Object) { .type = Y_FN, .value.ival = f })
+#define YASL_CFN(f, n) ((struct YASL_Object) { .type = Y_CFN, .value.cval = new_cfn(f, n) })
+#define YASL_CFN_OBJ(c) ((struct YASL_Object) { .type = Y_CFN, .value.cval = c })
+
+// the same value, with its type changed to type. Only used to switch between strong and weak references.
+#define YASL_RETYPE(v, t) ((struct YASL_Object) { .type = (t), .value = (v).value })
+
+#define YASL_GETTYPE(v) ((v).type)
+
+#define YASL_ISEND(v) ((v).type == Y_END)
+#define YASL_ISUNDEF(v) ((v).type == Y_UNDEF)
+#define YASL_ISFLOAT(v) ((v).type == Y_FLOAT)
+#define YASL_ISINT(v) ((v).type == Y_INT)
+#define YASL_ISBOOL(v) ((v).type == Y_BOOL)
+#define YASL_ISSTR(v) ((v).type == Y_STR)
+#define YASL_ISLIST(v) ((v).type == Y_LIST)
+#define YASL_ISTABLE(v) ((v).type == Y_TABLE)
+#define YASL_ISUSERDATA(v) ((v).type == Y_USERDATA)
+#define YASL_ISUSERPTR(v) ((v).type == Y_USERPTR)
+#define YASL_ISFN(v) ((v).type == Y_FN)
+#define YASL_ISCFN(v) ((v).type == Y_CFN)
+
+#define YASL_GETFLOAT(v) ((v).value.dval)
+#define YASL_GETINT(v) ((v).value.ival)
+#define YASL_GETBOOL(v) ((v).value.ival)
+#define YASL_GETSTR(v) ((v).value.sval)
+#define YASL_GETLIST(v) ((struct List *)((v).value.uval->data))
+#define YASL_GETTABLE(v) ((struct Table *)((v).value.uval->data))
+#define YASL_GETUSERDATA(v) ((v).value.uval)
+#define YASL_GETUSERPTR(v) ((v).value.pval)
+#define YASL_GETFN(v) ((v).value.ival)
+#define YASL_GETCFN(v) ((v).value.cval)
+
+// ints are never boxed in this layout.
+#define YASL_ISBIGINT(v) 0
+
+#define YASL_ISIDENTICAL(a, b) (YASL_GETTYPE(a) == YASL_GETTYPE(b) && YASL_GETINT(a) == YASL_GETINT(b))
+
+#endif
+
+#define YASL_ISNUM(v) (YASL_ISINT(v) || YASL_ISFLOAT(v))
+
 struct YASL_Object *YASL_Undef(void);
 struct YASL_Object *YASL_Float(yasl_float value);
 struct YASL_Object *YASL_Integer(yasl_int value);
@@ -120,8 +262,8 @@ void dec_ref(struct YASL_Object *v);
 const char *YASL_TYPE_NAMES[15];
 
 #define ASSERT_TYPE(vm, expected_type, name) do {\
-                    if ((vm)->stack[(vm)->sp].type != (expected_type)) {\
+                    if (YASL_GETTYPE((vm)->stack[(vm)->sp]) != (expected_type)) {\
                         printf("%s(...) expected first argument of type %s, got %s.\n", \
-                                name, YASL_TYPE_NAMES[expected_type], YASL_TYPE_NAMES[(vm)->stack[(vm)->sp].type] );\
+                                name, YASL_TYPE_NAMES[expected_type], YASL_TYPE_NAMES[YASL_GETTYPE((vm)->stack[(vm)->sp])] );\
                     }\
                 } while(0)
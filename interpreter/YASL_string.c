@@ -4,6 +4,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include "slab/slab.h"
+
 int64_t yasl_string_len(const String_t *const str) {
     return str->end - str->start;
 }
@@ -26,33 +28,37 @@ char *copy_char_buffer(const int64_t size, const char *const ptr) {
     return tmp;
 }
 
+// the substring gets its own copy of the characters, since nothing keeps the buffer of the original string alive.
 String_t *str_new_substring(const int64_t start, const int64_t end, String_t *string) {
-	String_t* str = malloc(sizeof(String_t));
-	str->start = start;
-	str->end = end;
-	str->str = string->str;
-	str->on_heap = string->on_heap;
-	str->rc = rc_new();
+	String_t* str = slab_alloc(sizeof(String_t));
+	str->start = 0;
+	str->end = end - start;
+	str->str = copy_char_buffer(end - start, string->str + start);
+	str->on_heap = 1;
+	str->hash = 0;
+	str->rc = NEW_RC();
 	return str;
 }
 
 String_t *str_new_sized(const int64_t base_size, char *ptr) {
-    String_t* str = malloc(sizeof(String_t));
+    String_t* str = slab_alloc(sizeof(String_t));
     str->start = 0;
     str->end = base_size;
     str->str = ptr;
     str->on_heap = 0;
-    str->rc = rc_new();
+    str->hash = 0;
+    str->rc = NEW_RC();
     return str;
 }
 
 String_t* str_new_sized_heap(const int64_t start, const int64_t end, char *mem) {
-    String_t* str = malloc(sizeof(String_t));
+    String_t* str = slab_alloc(sizeof(String_t));
     str->start = start;
     str->end = end;
     str->str = mem;
     str->on_heap = 1;
-    str->rc = rc_new();
+    str->hash = 0;
+    str->rc = NEW_RC();
     return str;
 }
 
@@ -63,26 +69,66 @@ void str_del_data(String_t *str) {
 }
 
 void str_del_rc(String_t *str) {
-    rc_del(str->rc);
-    free(str);
+    slab_free(str, sizeof(String_t));
 }
 
 void str_del(String_t *str) {
     if(str->on_heap) free(str->str);
-    rc_del(str->rc);
-    free(str);
+    slab_free(str, sizeof(String_t));
 }
 
+// FNV-1a. Strings are immutable, so the hash is computed once and cached in the string.
+size_t str_hash(String_t *str) {
+	if (str->hash) return str->hash;
+	uint64_t hash = 0xcbf29ce484222325;
+	const unsigned char *chars = (unsigned char *) str->str + str->start;
+	const int64_t len = yasl_string_len(str);
+	for (int64_t i = 0; i < len; i++) {
+		hash ^= chars[i];
+		hash *= 0x100000001b3;
+	}
+	str->hash = (size_t) (hash ? hash : 1);
+	return str->hash;
+}
 
 int64_t str_find_index(const String_t *haystack, const String_t *needle) {
-    // TODO: implement non-naive algorithm for string search.
-    if (yasl_string_len(haystack) < yasl_string_len(needle)) return -1;
-    int64_t i = 0;
-    char* hayStr = haystack->str + haystack->start;
-    char* needleStr = needle->str + needle->start;
-    while (i <= yasl_string_len(haystack) - yasl_string_len(needle)) {
-        if (!memcmp(hayStr + i, needleStr, yasl_string_len(needle))) return i;
-        i++;
-    }
-    return -1;
+	struct StrSearch search;
+	str_search_init(&search, needle->str + needle->start, (size_t) yasl_string_len(needle));
+	return str_search_next(&search, haystack->str + haystack->start, (size_t) yasl_string_len(haystack), 0);
+}
+
+void str_search_init(struct StrSearch *search, const char *needle, const size_t len) {
+	search->needle = needle;
+	search->len = len;
+	if (len < STR_SEARCH_SHORT) return;
+	for (size_t i = 0; i <= UCHAR_MAX; i++) {
+		search->skip[i] = len;
+	}
+	for (size_t i = 0; i + 1 < len; i++) {
+		search->skip[(unsigned char) needle[i]] = len - 1 - i;
+	}
+}
+
+int64_t str_search_next(const struct StrSearch *search, const char *haystack, const size_t len, const size_t from) {
+	const char *const needle = search->needle;
+	const size_t n = search->len;
+	if (from > len || n > len - from) return -1;
+	if (n == 0) return (int64_t) from;
+
+	if (n < STR_SEARCH_SHORT) {
+		// the last place a match could start.
+		const char *const last = haystack + len - n;
+		const char *at = haystack + from;
+		while (at <= last && (at = memchr(at, needle[0], (size_t) (last - at) + 1))) {
+			if (!memcmp(at + 1, needle + 1, n - 1)) return at - haystack;
+			at++;
+		}
+		return -1;
+	}
+
+	const unsigned char end = (unsigned char) needle[n - 1];
+	for (size_t i = from; i <= len - n; i += search->skip[(unsigned char) haystack[i + n - 1]]) {
+		if ((unsigned char) haystack[i + n - 1] == end && !memcmp(haystack + i, needle, n - 1)) return (int64_t) i;
+	}
+	return -1;
 }
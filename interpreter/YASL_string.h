@@ -1,16 +1,18 @@
 #pragma once
 
 #include <inttypes.h>
+#include <limits.h>
 #include <stdlib.h>
 
 #include "interpreter/refcount.h"
 
 typedef struct {
-    struct RC* rc;      // RC MUST BE THE FIRST MEMBER OF THIS STRUCT. DO NOT REARRANGE.
+    struct RC rc;       // RC MUST BE THE FIRST MEMBER OF THIS STRUCT. DO NOT REARRANGE.
     char *str;
     size_t start;
     int64_t end;
     int on_heap;
+    size_t hash;        // cached by str_hash, 0 until first computed.
 } String_t;
 
 // typedef String_t YASL_str;
@@ -25,4 +27,23 @@ String_t* str_new_sized_heap(const int64_t start, const int64_t end, char *mem);
 void str_del_data(String_t *str);
 void str_del_rc(String_t *str);
 void str_del(String_t *str);
+size_t str_hash(String_t *str);
 int64_t str_find_index(const String_t *haystack, const String_t *needle);
+
+/*
+ * A needle prepared for searching, so that searches for all of its occurrences only do the preparation once. Needles
+ * shorter than STR_SEARCH_SHORT are found by scanning for their first byte with memchr, which the C library vectorizes.
+ * Longer ones use Boyer-Moore-Horspool, with skip giving how far the search can move on for each byte of the haystack
+ * that lines up with the end of the needle.
+ */
+#define STR_SEARCH_SHORT 8
+
+struct StrSearch {
+	const char *needle;
+	size_t len;
+	size_t skip[UCHAR_MAX + 1];
+};
+
+void str_search_init(struct StrSearch *search, const char *needle, const size_t len);
+// returns the index of the first occurrence of the needle in haystack[from..len), or -1 if there is none.
+int64_t str_search_next(const struct StrSearch *search, const char *haystack, const size_t len, const size_t from);
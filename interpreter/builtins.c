@@ -11,7 +11,7 @@
 
 void yasl_print(struct VM* vm) {
 	if (!YASL_ISSTR(VM_PEEK(vm, vm->sp))) {
-		YASL_Types index = vm_peek(vm).type;
+		YASL_Types index = YASL_GETTYPE(vm_peek(vm));
 		struct YASL_Object key = YASL_STR(str_new_sized(strlen("tostr"), "tostr"));
 		struct YASL_Object result = table_search(vm->builtins_htable[index], key);
 		str_del(YASL_GETSTR(key));
@@ -110,7 +110,8 @@ struct Table* list_builtins(struct VM *vm) {
 	table_insert_specialstring_cfunction(vm, table, S_SLICE, &list_slice, 3);
 	table_insert_specialstring_cfunction(vm, table, S_CLEAR, &list_clear, 1);
 	table_insert_specialstring_cfunction(vm, table, S_JOIN, &list_join, 2);
-	table_insert_specialstring_cfunction(vm, table, S_SORT, &list_sort, 1);
+	table_insert_specialstring_cfunction(vm, table, S_SORT, &list_sort, 2);
+	table_insert_specialstring_cfunction(vm, table, S_STABLESORT, &list_stablesort, 2);
 	return table;
 }
 
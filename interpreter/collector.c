@@ -0,0 +1,225 @@
+#include "collector.h"
+
+#include <time.h>
+
+#include "hashtable/hashtable.h"
+#include "interpreter/list.h"
+#include "interpreter/YASL_Object.h"
+
+static void buffer_push(struct GC_Buffer *const buffer, struct RC_UserData *const ud) {
+	if (buffer->count >= buffer->size) {
+		buffer->size = buffer->size ? buffer->size * 2 : 64;
+		buffer->items = realloc(buffer->items, buffer->size * sizeof(struct RC_UserData *));
+	}
+	buffer->items[buffer->count++] = ud;
+}
+
+/*
+ * Lets go of the roots still buffered once the state's objects have been released. Those that are still alive are
+ * held from outside of the state, and are left without a collector, so that they don't point to this one once it's
+ * gone.
+ */
+void gc_cleanup(struct Collector *gc) {
+	for (size_t i = 0; i < gc->roots.count; i++) {
+		struct RC_UserData *ud = gc->roots.items[i];
+		ud->buffered = 0;
+		if (ud->rc.refs == 0 && ud->rc.weak_refs == 0) ud_del_rc(ud);
+		else ud->gc = NULL;
+	}
+	free(gc->roots.items);
+	gc->roots = (struct GC_Buffer) { NULL, 0, 0 };
+}
+
+// gives a list or table that was made without a state to gc.
+void gc_adopt(struct Collector *gc, struct RC_UserData *ud) {
+	if ((ud->tag == T_LIST || ud->tag == T_TABLE) && !ud->gc) ud->gc = gc;
+}
+
+void gc_possible_root(struct RC_UserData *ud) {
+	if (ud->tag != T_LIST && ud->tag != T_TABLE) return;
+	if (ud->color == GC_FREEING || !ud->gc) return;
+	ud->color = GC_PURPLE;
+	if (!ud->buffered) {
+		ud->buffered = 1;
+		buffer_push(&ud->gc->roots, ud);
+	}
+}
+
+int gc_should_collect(const struct Collector *gc) {
+	return gc->roots.count >= GC_THRESHOLD;
+}
+
+typedef void (*gc_visitor)(struct RC_UserData *child, struct GC_Buffer *stack);
+
+// calls visit on every list and table that ud holds a strong reference to.
+static void for_each_child(struct RC_UserData *ud, gc_visitor visit, struct GC_Buffer *stack) {
+	if (ud->tag == T_LIST) {
+		FOR_LIST(i, value, (struct List *) ud->data) {
+			if (YASL_ISLIST(value) || YASL_ISTABLE(value)) visit(YASL_GETUSERDATA(value), stack);
+		}
+	} else if (ud->tag == T_TABLE) {
+		FOR_TABLE(i, item, (struct Table *) ud->data) {
+			if (YASL_ISLIST(item->key) || YASL_ISTABLE(item->key)) visit(YASL_GETUSERDATA(item->key), stack);
+			if (YASL_ISLIST(item->value) || YASL_ISTABLE(item->value)) visit(YASL_GETUSERDATA(item->value), stack);
+		}
+	}
+}
+
+/*
+ * Visits the children of root, then the children of every object that visit pushes onto stack, and so on. Only the
+ * part of stack above its current top is used, so traversals can be nested. If popped is not NULL, every object
+ * whose children were visited is added to it.
+ */
+static void traverse(struct RC_UserData *root, gc_visitor visit, struct GC_Buffer *stack, struct GC_Buffer *popped) {
+	const size_t base = stack->count;
+	buffer_push(stack, root);
+	while (stack->count > base) {
+		struct RC_UserData *ud = stack->items[--stack->count];
+		if (popped) buffer_push(popped, ud);
+		for_each_child(ud, visit, stack);
+	}
+}
+
+static void mark_gray_child(struct RC_UserData *child, struct GC_Buffer *stack) {
+	child->rc.refs--;
+	if (child->color != GC_GRAY) {
+		child->color = GC_GRAY;
+		buffer_push(stack, child);
+	}
+}
+
+static void scan_black_child(struct RC_UserData *child, struct GC_Buffer *stack) {
+	child->rc.refs++;
+	if (child->color != GC_BLACK) {
+		child->color = GC_BLACK;
+		buffer_push(stack, child);
+	}
+}
+
+static void scan_child(struct RC_UserData *child, struct GC_Buffer *stack) {
+	buffer_push(stack, child);
+}
+
+static void collect_white_child(struct RC_UserData *child, struct GC_Buffer *stack) {
+	if (child->color == GC_WHITE && !child->buffered) {
+		child->color = GC_FREEING;
+		buffer_push(stack, child);
+	}
+}
+
+static void restore_child(struct RC_UserData *child, struct GC_Buffer *stack) {
+	child->rc.refs++;
+}
+
+static void mark_gray(struct RC_UserData *root, struct GC_Buffer *stack) {
+	if (root->color == GC_GRAY) return;
+	root->color = GC_GRAY;
+	traverse(root, mark_gray_child, stack, NULL);
+}
+
+static void scan_black(struct RC_UserData *root, struct GC_Buffer *stack) {
+	root->color = GC_BLACK;
+	traverse(root, scan_black_child, stack, NULL);
+}
+
+static void scan(struct RC_UserData *root, struct GC_Buffer *stack) {
+	const size_t base = stack->count;
+	buffer_push(stack, root);
+	while (stack->count > base) {
+		struct RC_UserData *ud = stack->items[--stack->count];
+		if (ud->color != GC_GRAY) continue;
+		if (ud->rc.refs > 0) {
+			scan_black(ud, stack);
+		} else {
+			ud->color = GC_WHITE;
+			for_each_child(ud, scan_child, stack);
+		}
+	}
+}
+
+static void collect_white(struct RC_UserData *root, struct GC_Buffer *stack, struct GC_Buffer *garbage) {
+	if (root->color != GC_WHITE || root->buffered) return;
+	root->color = GC_FREEING;
+	traverse(root, collect_white_child, stack, garbage);
+}
+
+static size_t container_bytes(struct RC_UserData *ud) {
+	if (ud->tag == T_LIST) {
+		const struct List *ls = ud->data;
+		return sizeof(struct RC_UserData) + sizeof(struct List) + ls->size * sizeof(struct YASL_Object);
+	}
+	const struct Table *table = ud->data;
+	size_t bytes = sizeof(struct RC_UserData) + sizeof(struct Table) + table->size * sizeof(Item_t);
+#if YASL_SWISS_TABLE
+	bytes += table->size + TABLE_GROUP_WIDTH;
+#endif
+	return bytes;
+}
+
+/*
+ * Frees the objects in garbage. Their counts only include references from outside of garbage at this point, which
+ * are none, so the references between them are restored first, and each one is held by one more reference while the
+ * data of the others is freed. That way, freeing their data releases all of their references, including those to
+ * objects outside of garbage, without any of them being freed twice.
+ */
+static void free_garbage(struct GC_Buffer *garbage, struct GC_Stats *stats) {
+	for (size_t i = 0; i < garbage->count; i++) {
+		for_each_child(garbage->items[i], restore_child, NULL);
+		garbage->items[i]->rc.refs++;
+	}
+	for (size_t i = 0; i < garbage->count; i++) {
+		stats->bytes += container_bytes(garbage->items[i]);
+		ud_del_data(garbage->items[i]);
+	}
+	for (size_t i = 0; i < garbage->count; i++) {
+		struct RC_UserData *ud = garbage->items[i];
+		ud->rc.refs = 0;
+		ud->color = GC_BLACK;
+		if (!ud->rc.weak_refs) ud_del_rc(ud);
+	}
+	stats->objects += garbage->count;
+}
+
+struct GC_Stats gc_collect(struct Collector *gc) {
+	struct GC_Stats stats = { 0, 0, 0.0 };
+	const clock_t start = clock();
+
+	// roots buffered while the garbage is freed go into a fresh buffer, for the next collection.
+	struct GC_Buffer candidates = gc->roots;
+	gc->roots = (struct GC_Buffer) { NULL, 0, 0 };
+	struct GC_Buffer stack = { NULL, 0, 0 };
+	struct GC_Buffer garbage = { NULL, 0, 0 };
+
+	size_t count = 0;
+	for (size_t i = 0; i < candidates.count; i++) {
+		struct RC_UserData *ud = candidates.items[i];
+		if (ud->color == GC_PURPLE && ud->rc.refs > 0) {
+			mark_gray(ud, &stack);
+			candidates.items[count++] = ud;
+		} else {
+			ud->buffered = 0;
+			// the data of a buffered object is freed as soon as it has no references left, but its header is kept
+			// until now, since the buffer still points to it.
+			if (ud->color == GC_BLACK && ud->rc.refs == 0 && ud->rc.weak_refs == 0) ud_del_rc(ud);
+		}
+	}
+	candidates.count = count;
+
+	for (size_t i = 0; i < candidates.count; i++) {
+		scan(candidates.items[i], &stack);
+	}
+
+	for (size_t i = 0; i < candidates.count; i++) {
+		candidates.items[i]->buffered = 0;
+		collect_white(candidates.items[i], &stack, &garbage);
+	}
+
+	free_garbage(&garbage, &stats);
+
+	free(candidates.items);
+	free(stack.items);
+	free(garbage.items);
+
+	stats.ms = (double) (clock() - start) * 1e3 / CLOCKS_PER_SEC;
+	return stats;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <stdlib.h>
+
+#include "interpreter/userdata.h"
+
+/*
+ * Cycle collector for lists and tables, using synchronous trial deletion (Bacon and Rajan, "Concurrent Cycle
+ * Collection in Reference Counted Systems"). Whenever a strong reference to a list or table is dropped and the object
+ * stays alive, the object is buffered as a possible root of a garbage cycle. A collection subtracts the references
+ * internal to the subgraph reachable from the buffered roots: whatever ends up with no references left is only kept
+ * alive by cycles, and is freed.
+ *
+ * Collections must only run while every live list and table is reachable through counted references, which holds
+ * between VM instructions, but not in the middle of one.
+ *
+ * Each state has its own collector, and a list or table is buffered in the collector of the state that made it, so
+ * states on different threads never touch the same buffer. Lists and tables must not be passed between states, since
+ * a collection in one could visit the objects of another in the middle of an instruction, and must not outlive the
+ * state that made them. Those made through the API without a state (YASL_Table) have no collector until they are
+ * pushed onto a state's stack, and cycles made only of such objects are never collected.
+ */
+
+#define GC_THRESHOLD 10000             // number of buffered roots after which the VM collects on its own.
+
+enum GC_Colors {
+	GC_BLACK,                      // in use, or free
+	GC_GRAY,                       // possible member of a cycle
+	GC_WHITE,                      // member of a garbage cycle
+	GC_PURPLE,                     // possible root of a cycle
+	GC_FREEING,                    // garbage being freed by the collector
+};
+
+struct GC_Buffer {
+	struct RC_UserData **items;
+	size_t size;
+	size_t count;
+};
+
+struct Collector {
+	struct GC_Buffer roots;        // possible roots of garbage cycles
+};
+
+#define NEW_COLLECTOR() ((struct Collector) { { NULL, 0, 0 } })
+
+struct GC_Stats {
+	size_t objects;                // lists and tables freed
+	size_t bytes;                  // bytes freed for those lists and tables, counting their items but not their contents
+	double ms;                     // time taken by the collection
+};
+
+void gc_cleanup(struct Collector *gc);
+void gc_adopt(struct Collector *gc, struct RC_UserData *ud);
+void gc_possible_root(struct RC_UserData *ud);
+int gc_should_collect(const struct Collector *gc);
+struct GC_Stats gc_collect(struct Collector *gc);
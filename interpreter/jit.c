@@ -0,0 +1,1043 @@
+#include "jit.h"
+
+#include "interpreter/VM.h"
+
+#if YASL_JIT
+
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "bytebuffer/bytebuffer.h"
+#include "compiler/bytecode.h"
+#include "interpreter/YASL_Object.h"
+#include "yasl_error.h"
+
+#if YASL_NAN_BOXING
+#error "YASL_JIT needs the default layout of YASL_Object."
+#endif
+
+#define JIT_MAX_DEPTH 1000             // nested compiled calls after which functions are left to the interpreter
+#define JIT_CHUNK_SIZE 65536           // executable memory is mapped in chunks of at least this many bytes
+#define JIT_EMPTY SIZE_MAX             // addr of an unused entry in the table of functions
+
+// templates index the stack with a shift, so objects have to be 16 bytes.
+typedef char jit_object_size_check[sizeof(struct YASL_Object) == 16 ? 1 : -1];
+
+typedef int (*jit_fn)(struct VM *vm);
+
+struct JIT_Function {
+	size_t addr;                   // offset of the function's header in the code, or JIT_EMPTY
+	jit_fn code;                   // NULL if the function can't be compiled
+};
+
+struct JIT_Chunk {
+	unsigned char *bytes;          // mapped executable, and only writable while code is copied in
+	size_t size;
+};
+
+struct JIT {
+	struct JIT_Function *functions;   // open addressing on addr, with a power-of-two size
+	size_t size;
+	size_t count;
+	struct JIT_Chunk *chunks;
+	size_t num_chunks;
+	size_t chunk_used;             // bytes used in the last chunk, which new code is appended to
+	int depth;                     // compiled calls currently running
+};
+
+/*
+ * Registers. Compiled code keeps the VM, its stack, the function's locals and its frame pointer in callee-saved
+ * registers, and everything else in memory, so that vm_* handlers can be called at any point without syncing.
+ */
+enum Reg { RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI, R8, R9, R10, R11, R12, R13, R14, R15 };
+
+#define REG_VM RBX                     // vm
+#define REG_STACK R12                  // vm->stack
+#define REG_LOCALS R13                 // first local of the frame, at vm->stack + vm->fp + 4
+#define REG_FP R15                     // vm->fp, 32 bits
+
+enum Cond {
+	CC_B = 0x2,
+	CC_AE = 0x3,
+	CC_E = 0x4,
+	CC_NE = 0x5,
+	CC_BE = 0x6,
+	CC_A = 0x7,
+	CC_NP = 0xB,
+	CC_L = 0xC,
+	CC_GE = 0xD,
+	CC_LE = 0xE,
+	CC_G = 0xF,
+};
+
+#define OFF_SP ((int32_t) offsetof(struct VM, sp))
+#define OFF_FP ((int32_t) offsetof(struct VM, fp))
+#define OFF_PC ((int32_t) offsetof(struct VM, pc))
+#define OFF_STACK ((int32_t) offsetof(struct VM, stack))
+#define OFF_GLOBALS ((int32_t) offsetof(struct VM, globals))
+
+#define SLOT ((int32_t) sizeof(struct YASL_Object))
+#define TYPE_AT(k) ((k) * SLOT + (int32_t) offsetof(struct YASL_Object, type))
+#define VALUE_AT(k) ((k) * SLOT + (int32_t) offsetof(struct YASL_Object, value))
+
+#define FN(f) ((uint64_t) (uintptr_t) (f))
+
+struct Fixup {
+	size_t at;                     // offset of a rel32 in the machine code
+	size_t target;                 // offset in the bytecode that it jumps to
+};
+
+struct Emitter {
+	ByteBuffer *out;
+	const unsigned char *code;
+	size_t epilogue;               // offset of the epilogue in out
+	struct Fixup *fixups;          // jumps to bytecode offsets, patched once every instruction has been emitted
+	size_t num_fixups;
+	size_t size_fixups;
+};
+
+/*
+ * Instruction encoding. Memory operands are always [base + disp32], so that only RSP and R12 need a special case.
+ */
+static void emit8(struct Emitter *e, const unsigned char byte) {
+	bb_add_byte(e->out, byte);
+}
+
+static void emit32(struct Emitter *e, const int32_t value) {
+	bb_append(e->out, (const unsigned char *) &value, sizeof(value));
+}
+
+static void emit64(struct Emitter *e, const uint64_t value) {
+	bb_append(e->out, (const unsigned char *) &value, sizeof(value));
+}
+
+// REX prefix, for 64 bit operands (w) or registers above RDI in the reg or rm field of ModRM. Left out if not needed.
+static void rex(struct Emitter *e, const int w, const int reg, const int rm) {
+	const unsigned char prefix = (unsigned char) (0x40 | w << 3 | (reg & 8) >> 1 | (rm & 8) >> 3);
+	if (prefix != 0x40) emit8(e, prefix);
+}
+
+static void modrm_mem(struct Emitter *e, const int reg, const int base, const int32_t disp) {
+	emit8(e, (unsigned char) (0x80 | (reg & 7) << 3 | (base & 7)));
+	if ((base & 7) == RSP) emit8(e, 0x24);
+	emit32(e, disp);
+}
+
+static void modrm_reg(struct Emitter *e, const int reg, const int rm) {
+	emit8(e, (unsigned char) (0xC0 | (reg & 7) << 3 | (rm & 7)));
+}
+
+// op with a register and a memory operand, 64 bits wide if w is set.
+static void op_mem(struct Emitter *e, const int w, const unsigned char op, const int reg, const int base, const int32_t disp) {
+	rex(e, w, reg, base);
+	emit8(e, op);
+	modrm_mem(e, reg, base, disp);
+}
+
+// op with two register operands, 64 bits wide if w is set.
+static void op_reg(struct Emitter *e, const int w, const unsigned char op, const int reg, const int rm) {
+	rex(e, w, reg, rm);
+	emit8(e, op);
+	modrm_reg(e, reg, rm);
+}
+
+// op with a memory operand and an 8 bit immediate, where ext is the opcode extension in the reg field of ModRM.
+static void op_mem_imm8(struct Emitter *e, const int w, const unsigned char op, const int ext, const int base,
+			const int32_t disp, const signed char imm) {
+	op_mem(e, w, op, ext, base, disp);
+	emit8(e, (unsigned char) imm);
+}
+
+// SSE2 op between xmm0 and a memory operand, with its mandatory prefix.
+static void sse_mem(struct Emitter *e, const unsigned char prefix, const unsigned char op, const int base, const int32_t disp) {
+	emit8(e, prefix);
+	rex(e, 0, 0, base);
+	emit8(e, 0x0F);
+	emit8(e, op);
+	modrm_mem(e, 0, base, disp);
+}
+
+static void cmp_mem_imm8(struct Emitter *e, const int w, const int base, const int32_t disp, const signed char imm) {
+	op_mem_imm8(e, w, 0x83, 7, base, disp, imm);
+}
+
+static void add_mem_imm8(struct Emitter *e, const int w, const int base, const int32_t disp, const signed char imm) {
+	op_mem_imm8(e, w, 0x83, 0, base, disp, imm);
+}
+
+static void mov_imm64(struct Emitter *e, const int reg, const uint64_t imm) {
+	rex(e, 1, 0, reg);
+	emit8(e, (unsigned char) (0xB8 + (reg & 7)));
+	emit64(e, imm);
+}
+
+static void shl_imm8(struct Emitter *e, const int reg, const unsigned char imm) {
+	op_reg(e, 1, 0xC1, 4, reg);
+	emit8(e, imm);
+}
+
+static void emit_call(struct Emitter *e, const uint64_t fn) {
+	mov_imm64(e, RAX, fn);
+	op_reg(e, 0, 0xFF, 2, RAX);                        // call rax
+}
+
+static void jmp_to(struct Emitter *e, const size_t to) {
+	emit8(e, 0xE9);
+	emit32(e, (int32_t) (to - (e->out->count + 4)));
+}
+
+static void jcc_to(struct Emitter *e, const enum Cond cc, const size_t to) {
+	emit8(e, 0x0F);
+	emit8(e, (unsigned char) (0x80 + cc));
+	emit32(e, (int32_t) (to - (e->out->count + 4)));
+}
+
+// forward jumps within a template return the offset of their rel32, which patch then points at the current offset.
+static size_t jmp_fwd(struct Emitter *e) {
+	emit8(e, 0xE9);
+	emit32(e, 0);
+	return e->out->count - 4;
+}
+
+static size_t jcc_fwd(struct Emitter *e, const enum Cond cc) {
+	emit8(e, 0x0F);
+	emit8(e, (unsigned char) (0x80 + cc));
+	emit32(e, 0);
+	return e->out->count - 4;
+}
+
+static void patch(struct Emitter *e, const size_t at) {
+	const int32_t rel = (int32_t) (e->out->count - (at + 4));
+	memcpy(e->out->bytes + at, &rel, sizeof(rel));
+}
+
+static void add_fixup(struct Emitter *e, const size_t target) {
+	if (e->num_fixups == e->size_fixups) {
+		e->size_fixups = e->size_fixups ? 2 * e->size_fixups : 16;
+		e->fixups = realloc(e->fixups, e->size_fixups * sizeof(struct Fixup));
+	}
+	e->fixups[e->num_fixups].at = e->out->count - 4;
+	e->fixups[e->num_fixups].target = target;
+	e->num_fixups++;
+}
+
+// jumps to the instruction at target in the bytecode, unconditionally if cc is negative.
+static void jump_bytecode(struct Emitter *e, const int cc, const size_t target) {
+	if (cc < 0) {
+		jmp_fwd(e);
+	} else {
+		jcc_fwd(e, (enum Cond) cc);
+	}
+	add_fixup(e, target);
+}
+
+/*
+ * Templates.
+ */
+static int jit_isfalsey(const struct YASL_Object *v) {
+	return isfalsey(*v);
+}
+
+// rax = vm->stack + vm->sp.
+static void emit_top(struct Emitter *e) {
+	op_mem(e, 1, 0x63, RAX, REG_VM, OFF_SP);           // movsxd rax, [vm->sp]
+	shl_imm8(e, RAX, 4);
+	op_reg(e, 1, 0x01, REG_STACK, RAX);                // add rax, r12
+}
+
+// returns from the compiled function, with the status in eax, unless it is YASL_SUCCESS.
+static void emit_check(struct Emitter *e) {
+	op_reg(e, 0, 0x85, RAX, RAX);                      // test eax, eax
+	jcc_to(e, CC_NE, e->epilogue);
+}
+
+static void emit_set_pc(struct Emitter *e, const size_t pc) {
+	if (pc <= INT32_MAX) {
+		op_mem(e, 1, 0xC7, 0, REG_VM, OFF_PC);     // mov qword [vm->pc], imm32
+		emit32(e, (int32_t) pc);
+	} else {
+		mov_imm64(e, RAX, pc);
+		op_mem(e, 1, 0x89, RAX, REG_VM, OFF_PC);   // mov [vm->pc], rax
+	}
+}
+
+/*
+ * Calls handler with vm->pc set to pc, just past the opcode. If the handler enters a YASL function, as CALL does, or
+ * as an operator does when it is overloaded, that function runs to its return before the next instruction.
+ */
+static void emit_handler(struct Emitter *e, int (*handler)(struct VM *), const size_t pc) {
+	emit_set_pc(e, pc);
+	op_reg(e, 1, 0x89, REG_VM, RDI);                   // mov rdi, rbx
+	emit_call(e, FN(handler));
+	emit_check(e);
+	op_mem(e, 0, 0x39, REG_FP, REG_VM, OFF_FP);        // cmp [vm->fp], r15d
+	const size_t same_frame = jcc_fwd(e, CC_E);
+	op_reg(e, 1, 0x89, REG_VM, RDI);                   // mov rdi, rbx
+	op_reg(e, 0, 0x89, REG_FP, RSI);                   // mov esi, r15d
+	emit_call(e, FN(&vm_finish_call));
+	emit_check(e);
+	patch(e, same_frame);
+}
+
+// calls refcount (dec_ref or inc_ref) on the slot at [base + disp], unless its value isn't refcounted.
+static void emit_refcount(struct Emitter *e, void (*refcount)(struct YASL_Object *), const int base, const int32_t disp) {
+	cmp_mem_imm8(e, 0, base, disp + TYPE_AT(0), Y_BOOL);
+	const size_t skip = jcc_fwd(e, CC_BE);
+	op_mem(e, 1, 0x8D, RDI, base, disp);               // lea rdi, [base + disp]
+	emit_call(e, FN(refcount));
+	patch(e, skip);
+}
+
+enum Base {
+	BASE_LOCALS,
+	BASE_GLOBALS,
+	BASE_TOP,                      // the top of the stack, in rax
+};
+
+static int emit_base(struct Emitter *e, const enum Base base) {
+	switch (base) {
+	case BASE_LOCALS:
+		return REG_LOCALS;
+	case BASE_GLOBALS:
+		op_mem(e, 1, 0x8B, RCX, REG_VM, OFF_GLOBALS);   // mov rcx, [vm->globals]
+		return RCX;
+	default:
+		return RAX;
+	}
+}
+
+// releases the slot above the top of the stack, which is about to be pushed to. Leaves rax at the top.
+static void emit_release_next(struct Emitter *e) {
+	emit_top(e);
+	cmp_mem_imm8(e, 0, RAX, TYPE_AT(1), Y_BOOL);
+	const size_t skip = jcc_fwd(e, CC_BE);
+	op_mem(e, 1, 0x8D, RDI, RAX, SLOT);                // lea rdi, [rax + 16]
+	emit_call(e, FN(&dec_ref));
+	emit_top(e);
+	patch(e, skip);
+}
+
+// pushes a value that isn't refcounted, as vm_push does.
+static void emit_push_const(struct Emitter *e, const YASL_Types type, const uint64_t bits) {
+	emit_release_next(e);
+	op_mem(e, 0, 0xC7, 0, RAX, TYPE_AT(1));            // mov dword [rax + 16], type
+	emit32(e, type);
+	mov_imm64(e, RCX, bits);
+	op_mem(e, 1, 0x89, RCX, RAX, VALUE_AT(1));         // mov [rax + 24], rcx
+	add_mem_imm8(e, 0, REG_VM, OFF_SP, 1);
+}
+
+static void emit_push_float(struct Emitter *e, const yasl_float value) {
+	uint64_t bits;
+	memcpy(&bits, &value, sizeof(bits));
+	emit_push_const(e, Y_FLOAT, bits);
+}
+
+// pushes the slot at disp from base, as vm_push does.
+static void emit_push(struct Emitter *e, const enum Base base, const int32_t disp) {
+	emit_release_next(e);
+	const int src = emit_base(e, base);
+	sse_mem(e, 0xF3, 0x6F, src, disp);                 // movdqu xmm0, [src + disp]
+	sse_mem(e, 0xF3, 0x7F, RAX, SLOT);                 // movdqu [rax + 16], xmm0
+	add_mem_imm8(e, 0, REG_VM, OFF_SP, 1);
+	emit_refcount(e, &inc_ref, RAX, SLOT);
+}
+
+// pops the top of the stack into the slot at disp from base, as GSTORE and LSTORE do.
+static void emit_store(struct Emitter *e, const enum Base base, const int32_t disp) {
+	emit_refcount(e, &dec_ref, emit_base(e, base), disp);
+	emit_top(e);
+	const int dst = emit_base(e, base);
+	sse_mem(e, 0xF3, 0x6F, RAX, 0);                    // movdqu xmm0, [rax]
+	sse_mem(e, 0xF3, 0x7F, dst, disp);                 // movdqu [dst + disp], xmm0
+	add_mem_imm8(e, 0, REG_VM, OFF_SP, -1);
+	emit_refcount(e, &inc_ref, dst, disp);
+}
+
+/*
+ * Checks that the top two values of the stack are both ints, and jumps to the returned forward jump if they are both
+ * floats, or to *slow otherwise. Leaves rax at the top of the stack.
+ */
+static size_t emit_binop_types(struct Emitter *e, size_t slow[3]) {
+	emit_top(e);
+	op_mem(e, 0, 0x8B, RCX, RAX, TYPE_AT(-1));         // mov ecx, [left.type]
+	op_reg(e, 0, 0x83, 7, RCX);                        // cmp ecx, Y_INT
+	emit8(e, Y_INT);
+	const size_t not_int = jcc_fwd(e, CC_NE);
+	cmp_mem_imm8(e, 0, RAX, TYPE_AT(0), Y_INT);
+	slow[0] = jcc_fwd(e, CC_NE);
+	const size_t ints = jmp_fwd(e);
+	patch(e, not_int);
+	op_reg(e, 0, 0x83, 7, RCX);                        // cmp ecx, Y_FLOAT
+	emit8(e, Y_FLOAT);
+	slow[1] = jcc_fwd(e, CC_NE);
+	cmp_mem_imm8(e, 0, RAX, TYPE_AT(0), Y_FLOAT);
+	slow[2] = jcc_fwd(e, CC_NE);
+	const size_t floats = jmp_fwd(e);
+	patch(e, ints);
+	return floats;
+}
+
+// ADD, SUB and MUL: ints and floats in place, as the interpreter's fast paths, and anything else through handler.
+static void emit_arith(struct Emitter *e, const unsigned char opcode, int (*handler)(struct VM *), const size_t pc) {
+	size_t slow[3];
+	const size_t floats = emit_binop_types(e, slow);
+	op_mem(e, 1, 0x8B, RCX, RAX, VALUE_AT(-1));        // mov rcx, [left.value]
+	if (opcode == MUL) {
+		rex(e, 1, RCX, RAX);                       // imul rcx, [right.value]
+		emit8(e, 0x0F);
+		emit8(e, 0xAF);
+		modrm_mem(e, RCX, RAX, VALUE_AT(0));
+	} else {
+		op_mem(e, 1, opcode == ADD ? 0x03 : 0x2B, RCX, RAX, VALUE_AT(0));   // add/sub rcx, [right.value]
+	}
+	op_mem(e, 1, 0x89, RCX, RAX, VALUE_AT(-1));        // mov [left.value], rcx
+	add_mem_imm8(e, 0, REG_VM, OFF_SP, -1);
+	const size_t int_done = jmp_fwd(e);
+	patch(e, floats);
+	sse_mem(e, 0xF2, 0x10, RAX, VALUE_AT(-1));         // movsd xmm0, [left.value]
+	sse_mem(e, 0xF2, opcode == ADD ? 0x58 : opcode == SUB ? 0x5C : 0x59, RAX, VALUE_AT(0));   // addsd/subsd/mulsd
+	sse_mem(e, 0xF2, 0x11, RAX, VALUE_AT(-1));         // movsd [left.value], xmm0
+	add_mem_imm8(e, 0, REG_VM, OFF_SP, -1);
+	const size_t float_done = jmp_fwd(e);
+	for (int i = 0; i < 3; i++) patch(e, slow[i]);
+	emit_handler(e, handler, pc);
+	patch(e, int_done);
+	patch(e, float_done);
+}
+
+// GT, GE and EQ: ints and floats inline, as the interpreter's fast paths, and anything else through handler.
+static void emit_compare(struct Emitter *e, const unsigned char opcode, int (*handler)(struct VM *), const size_t pc) {
+	size_t slow[3];
+	const size_t floats = emit_binop_types(e, slow);
+	op_mem(e, 1, 0x8B, RCX, RAX, VALUE_AT(-1));        // mov rcx, [left.value]
+	op_mem(e, 1, 0x3B, RCX, RAX, VALUE_AT(0));         // cmp rcx, [right.value]
+	emit8(e, 0x0F);                                    // setcc cl
+	emit8(e, (unsigned char) (0x90 + (opcode == GT ? CC_G : opcode == GE ? CC_GE : CC_E)));
+	modrm_reg(e, 0, RCX);
+	const size_t int_done = jmp_fwd(e);
+	patch(e, floats);
+	sse_mem(e, 0xF2, 0x10, RAX, VALUE_AT(-1));         // movsd xmm0, [left.value]
+	sse_mem(e, 0x66, 0x2E, RAX, VALUE_AT(0));          // ucomisd xmm0, [right.value]
+	emit8(e, 0x0F);                                    // setcc cl
+	emit8(e, (unsigned char) (0x90 + (opcode == GT ? CC_A : opcode == GE ? CC_AE : CC_E)));
+	modrm_reg(e, 0, RCX);
+	if (opcode == EQ) {
+		// unordered compares set ZF too, so NaN must be ruled out separately.
+		emit8(e, 0x0F);                            // setnp dl
+		emit8(e, 0x90 + CC_NP);
+		modrm_reg(e, 0, RDX);
+		emit8(e, 0x20);                            // and cl, dl
+		modrm_reg(e, RDX, RCX);
+	}
+	patch(e, int_done);
+	emit8(e, 0x0F);                                    // movzx ecx, cl
+	emit8(e, 0xB6);
+	modrm_reg(e, RCX, RCX);
+	op_mem(e, 1, 0x89, RCX, RAX, VALUE_AT(-1));        // mov [left.value], rcx
+	op_mem(e, 0, 0xC7, 0, RAX, TYPE_AT(-1));           // mov dword [left.type], Y_BOOL
+	emit32(e, Y_BOOL);
+	add_mem_imm8(e, 0, REG_VM, OFF_SP, -1);
+	const size_t done = jmp_fwd(e);
+	for (int i = 0; i < 3; i++) patch(e, slow[i]);
+	emit_handler(e, handler, pc);
+	patch(e, done);
+}
+
+// pops the top of the stack, and branches to target if it is truthy (or falsey, if truthy isn't set).
+static void emit_test_branch(struct Emitter *e, const int truthy, const size_t target) {
+	emit_top(e);
+	add_mem_imm8(e, 0, REG_VM, OFF_SP, -1);
+	cmp_mem_imm8(e, 0, RAX, TYPE_AT(0), Y_BOOL);
+	const size_t not_bool = jcc_fwd(e, CC_NE);
+	cmp_mem_imm8(e, 1, RAX, VALUE_AT(0), 0);
+	jump_bytecode(e, truthy ? CC_NE : CC_E, target);
+	const size_t done = jmp_fwd(e);
+	patch(e, not_bool);
+	op_reg(e, 1, 0x89, RAX, RDI);                      // mov rdi, rax
+	emit_call(e, FN(&jit_isfalsey));
+	op_reg(e, 0, 0x85, RAX, RAX);                      // test eax, eax
+	jump_bytecode(e, truthy ? CC_E : CC_NE, target);
+	patch(e, done);
+}
+
+/*
+ * LT_BRF, LE_BRF, GT_BRF and GE_BRF. Like vm_cmp_top, these compute a >= b (or a > b, for LE_BRF and GT_BRF), and
+ * branch if the result is set (LT_BRF and LE_BRF) or unset (GT_BRF and GE_BRF).
+ */
+static void emit_compare_branch(struct Emitter *e, const unsigned char opcode, const size_t pc, const size_t target) {
+	const int strict = opcode == LE_BRF || opcode == GT_BRF;
+	const int if_set = opcode == LT_BRF || opcode == LE_BRF;
+	static const enum Cond int_cc[] = { CC_GE, CC_G, CC_LE, CC_L };
+	static const enum Cond float_cc[] = { CC_AE, CC_A, CC_BE, CC_B };
+	size_t slow[3];
+	const size_t floats = emit_binop_types(e, slow);
+	add_mem_imm8(e, 0, REG_VM, OFF_SP, -2);
+	op_mem(e, 1, 0x8B, RCX, RAX, VALUE_AT(-1));        // mov rcx, [left.value]
+	op_mem(e, 1, 0x3B, RCX, RAX, VALUE_AT(0));         // cmp rcx, [right.value]
+	jump_bytecode(e, int_cc[opcode - LT_BRF], target);
+	const size_t int_done = jmp_fwd(e);
+	patch(e, floats);
+	add_mem_imm8(e, 0, REG_VM, OFF_SP, -2);
+	sse_mem(e, 0xF2, 0x10, RAX, VALUE_AT(-1));         // movsd xmm0, [left.value]
+	sse_mem(e, 0x66, 0x2E, RAX, VALUE_AT(0));          // ucomisd xmm0, [right.value]
+	jump_bytecode(e, float_cc[opcode - LT_BRF], target);
+	const size_t float_done = jmp_fwd(e);
+	for (int i = 0; i < 3; i++) patch(e, slow[i]);
+	emit_handler(e, strict ? &vm_GT : &vm_GE, pc);
+	emit_test_branch(e, if_set, target);
+	patch(e, int_done);
+	patch(e, float_done);
+}
+
+// INCR_* and DECR_*: ints in place, and anything else as the load, ICONST, ADD or SUB and store they replace.
+static void emit_incr(struct Emitter *e, const enum Base base, const int32_t disp, const signed char imm, const int sub,
+		      const size_t pc) {
+	const int slot = emit_base(e, base);
+	cmp_mem_imm8(e, 0, slot, disp + TYPE_AT(0), Y_INT);
+	const size_t slow = jcc_fwd(e, CC_NE);
+	op_mem_imm8(e, 1, 0x83, sub ? 5 : 0, slot, disp + VALUE_AT(0), imm);   // add/sub qword [value], imm8
+	const size_t done = jmp_fwd(e);
+	patch(e, slow);
+	emit_push(e, base, disp);
+	emit_push_const(e, Y_INT, (uint64_t) (yasl_int) imm);
+	emit_arith(e, sub ? SUB : ADD, sub ? &vm_SUB : &vm_ADD, pc);
+	emit_store(e, base, disp);
+	patch(e, done);
+}
+
+static void emit_prologue(struct Emitter *e) {
+	static const int saved[] = { RBX, R12, R13, R14, R15 };   // r14 only keeps the stack aligned for calls
+	for (size_t i = 0; i < sizeof(saved) / sizeof(saved[0]); i++) {
+		rex(e, 0, 0, saved[i]);                    // push
+		emit8(e, (unsigned char) (0x50 + (saved[i] & 7)));
+	}
+	op_reg(e, 1, 0x89, RDI, REG_VM);                   // mov rbx, rdi
+	op_mem(e, 1, 0x8B, REG_STACK, REG_VM, OFF_STACK);  // mov r12, [vm->stack]
+	op_mem(e, 0, 0x8B, REG_FP, REG_VM, OFF_FP);        // mov r15d, [vm->fp]
+	op_reg(e, 1, 0x63, REG_LOCALS, REG_FP);            // movsxd r13, r15d
+	shl_imm8(e, REG_LOCALS, 4);
+	op_reg(e, 1, 0x01, REG_STACK, REG_LOCALS);         // add r13, r12
+	op_mem(e, 1, 0x8D, REG_LOCALS, REG_LOCALS, 4 * SLOT);   // lea r13, [r13 + 64]
+	const size_t body = jmp_fwd(e);
+
+	e->epilogue = e->out->count;
+	for (size_t i = sizeof(saved) / sizeof(saved[0]); i-- > 0;) {
+		rex(e, 0, 0, saved[i]);                    // pop
+		emit8(e, (unsigned char) (0x58 + (saved[i] & 7)));
+	}
+	emit8(e, 0xC3);                                    // ret
+	patch(e, body);
+}
+
+/*
+ * Instructions without a template of their own call the handler the interpreter uses for them.
+ */
+static int (*const handlers[256])(struct VM *) = {
+	[FDIV] = &vm_fdiv,
+	[IDIV] = &vm_IDIV,
+	[MOD] = &vm_MOD,
+	[EXP] = &vm_pow,
+	[BOR] = &vm_BOR,
+	[BXOR] = &vm_BXOR,
+	[BAND] = &vm_BAND,
+	[BANDNOT] = &vm_BANDNOT,
+	[BSL] = &vm_BSL,
+	[BSR] = &vm_BSR,
+	[BNOT] = &vm_BNOT,
+	[NEG] = &vm_NEG,
+	[POS] = &vm_POS,
+	[NOT] = &vm_NOT,
+	[LEN] = &vm_LEN,
+	[CNCT] = &vm_CNCT,
+	[ID] = &vm_ID,
+	[NEWSPECIALSTR] = &vm_NEWSPECIALSTR,
+	[NEWSTR] = &vm_NEWSTR,
+	[NEWSTR_1] = &vm_NEWSTR_1,
+	[NEWSTR_2] = &vm_NEWSTR_2,
+	[NEWTABLE] = &vm_NEWTABLE,
+	[NEWTABLE_N] = &vm_NEWTABLE_N,
+	[NEWLIST] = &vm_NEWLIST,
+	[NEWLIST_N] = &vm_NEWLIST_N,
+	[INITFOR] = &vm_INITFOR,
+	[ENDCOMP] = &vm_ENDCOMP,
+	[ENDFOR] = &vm_ENDFOR,
+	[ITER_1] = &vm_ITER_1,
+	[SWAP] = &vm_SWAP,
+	[GET] = &vm_GET,
+	[GET_TABLE_STR] = &vm_GET,
+	[GET_LIST_INT] = &vm_GET,
+	[SET] = &vm_SET,
+	[SLICE] = &vm_SLICE,
+	[INIT_MC] = &vm_INIT_MC,
+	[INIT_MC_SPECIAL] = &vm_INIT_MC_SPECIAL,
+	[INIT_CALL] = &vm_INIT_CALL,
+	[CALL] = &vm_CALL,
+	[PRINT] = &vm_PRINT,
+};
+
+static yasl_int read_int(const unsigned char *bytes, const size_t width) {
+	int8_t i8;
+	int16_t i16;
+	int32_t i32;
+	int64_t i64;
+	switch (width) {
+	case 1:
+		memcpy(&i8, bytes, width);
+		return i8;
+	case 2:
+		memcpy(&i16, bytes, width);
+		return i16;
+	case 4:
+		memcpy(&i32, bytes, width);
+		return i32;
+	default:
+		memcpy(&i64, bytes, width);
+		return i64;
+	}
+}
+
+// width of the jump length at the end of a branch, or 0 if opcode isn't one.
+static size_t branch_width(const unsigned char opcode) {
+	switch (opcode) {
+	case BR_1:
+	case BRF_1:
+	case BRT_1:
+	case BRN_1:
+		return 1;
+	case BR_2:
+	case BRF_2:
+	case BRT_2:
+	case BRN_2:
+		return 2;
+	case BR_4:
+	case BRF_4:
+	case BRT_4:
+	case BRN_4:
+		return 4;
+	case BR_8:
+	case BRF_8:
+	case BRT_8:
+	case BRN_8:
+	case LT_BRF:
+	case LE_BRF:
+	case GT_BRF:
+	case GE_BRF:
+		return 8;
+	default:
+		return 0;
+	}
+}
+
+// whether the instruction never goes on to the next one.
+static int is_unconditional(const unsigned char opcode) {
+	return opcode == BR_1 || opcode == BR_2 || opcode == BR_4 || opcode == BR_8 || opcode == RET || opcode == HALT;
+}
+
+// emits the template for the instruction at pc. Returns 0 if it has none.
+static int emit_instruction(struct Emitter *e, const size_t pc) {
+	const unsigned char *const at = e->code + pc;
+	const unsigned char opcode = at[0];
+	const size_t length = instruction_length(at);
+	const size_t width = branch_width(opcode);
+	const size_t target = pc + length + (width ? (size_t) read_int(at + length - width, width) : 0);
+	uint16_t addr;
+	switch (opcode) {
+	case ICONST_M1:
+	case ICONST_0:
+	case ICONST_1:
+	case ICONST_2:
+	case ICONST_3:
+	case ICONST_4:
+	case ICONST_5:
+		emit_push_const(e, Y_INT, (uint64_t) (yasl_int) (opcode - ICONST_0));
+		return 1;
+	case ICONST_B1:
+		emit_push_const(e, Y_INT, (uint64_t) read_int(at + 1, 1));
+		return 1;
+	case ICONST_B2:
+		emit_push_const(e, Y_INT, (uint64_t) read_int(at + 1, 2));
+		return 1;
+	case ICONST_B4:
+		emit_push_const(e, Y_INT, (uint64_t) read_int(at + 1, 4));
+		return 1;
+	case ICONST:
+		emit_push_const(e, Y_INT, (uint64_t) read_int(at + 1, 8));
+		return 1;
+	case FCONST:
+		emit_push_const(e, Y_FN, (uint64_t) read_int(at + 1, 8));
+		return 1;
+	case DCONST_0:
+	case DCONST_1:
+	case DCONST_2:
+		emit_push_float(e, opcode - DCONST_0);
+		return 1;
+	case DCONST_N:
+		emit_push_float(e, NAN);
+		return 1;
+	case DCONST_I:
+		emit_push_float(e, INFINITY);
+		return 1;
+	case DCONST: {
+		uint64_t bits;
+		memcpy(&bits, at + 1, sizeof(bits));
+		emit_push_const(e, Y_FLOAT, bits);
+		return 1;
+	}
+	case BCONST_F:
+	case BCONST_T:
+		emit_push_const(e, Y_BOOL, opcode & 0x01);
+		return 1;
+	case NCONST:
+		emit_push_const(e, Y_UNDEF, 0);
+		return 1;
+	case END:
+		emit_push_const(e, Y_END, 0);
+		return 1;
+	case LLOAD_1:
+		emit_push(e, BASE_LOCALS, at[1] * SLOT);
+		return 1;
+	case GLOAD_1:
+		emit_push(e, BASE_GLOBALS, at[1] * SLOT);
+		return 1;
+	case LSTORE_1:
+		emit_store(e, BASE_LOCALS, at[1] * SLOT);
+		return 1;
+	case GSTORE_1:
+		emit_store(e, BASE_GLOBALS, at[1] * SLOT);
+		return 1;
+	case LLOAD_2:
+	case GLOAD_2:
+	case LSTORE_2:
+	case GSTORE_2:
+		memcpy(&addr, at + 1, sizeof(addr));
+		if (opcode == LSTORE_2 || opcode == GSTORE_2) {
+			emit_store(e, opcode == LSTORE_2 ? BASE_LOCALS : BASE_GLOBALS, addr * SLOT);
+		} else {
+			emit_push(e, opcode == LLOAD_2 ? BASE_LOCALS : BASE_GLOBALS, addr * SLOT);
+		}
+		return 1;
+	case INCR_GLOBAL:
+	case INCR_LOCAL:
+	case DECR_GLOBAL:
+	case DECR_LOCAL:
+		emit_incr(e, opcode & 0x01 ? BASE_LOCALS : BASE_GLOBALS, at[1] * SLOT, (signed char) at[2],
+			  opcode >= DECR_GLOBAL, pc + 1);
+		return 1;
+	case ADD_GLOBALS:
+	case ADD_LOCALS:
+		emit_push(e, opcode == ADD_LOCALS ? BASE_LOCALS : BASE_GLOBALS, at[1] * SLOT);
+		emit_push(e, opcode == ADD_LOCALS ? BASE_LOCALS : BASE_GLOBALS, at[2] * SLOT);
+		emit_arith(e, ADD, &vm_ADD, pc + 1);
+		return 1;
+	case POP:
+		add_mem_imm8(e, 0, REG_VM, OFF_SP, -1);
+		return 1;
+	case DUP:
+		emit_push(e, BASE_TOP, 0);
+		return 1;
+	case ADD:
+	case ADD_II:
+	case ADD_FF:
+		emit_arith(e, ADD, &vm_ADD, pc + 1);
+		return 1;
+	case SUB:
+	case SUB_II:
+	case SUB_FF:
+		emit_arith(e, SUB, &vm_SUB, pc + 1);
+		return 1;
+	case MUL:
+	case MUL_II:
+	case MUL_FF:
+		emit_arith(e, MUL, &vm_MUL, pc + 1);
+		return 1;
+	case GT:
+		emit_compare(e, GT, &vm_GT, pc + 1);
+		return 1;
+	case GE:
+		emit_compare(e, GE, &vm_GE, pc + 1);
+		return 1;
+	case EQ:
+		emit_compare(e, EQ, &vm_EQ, pc + 1);
+		return 1;
+	case LT_BRF:
+	case LE_BRF:
+	case GT_BRF:
+	case GE_BRF:
+		emit_compare_branch(e, opcode, pc + 1, target);
+		return 1;
+	case BR_1:
+	case BR_2:
+	case BR_4:
+	case BR_8:
+		jump_bytecode(e, -1, target);
+		return 1;
+	case BRF_1:
+	case BRF_2:
+	case BRF_4:
+	case BRF_8:
+		emit_test_branch(e, 0, target);
+		return 1;
+	case BRT_1:
+	case BRT_2:
+	case BRT_4:
+	case BRT_8:
+		emit_test_branch(e, 1, target);
+		return 1;
+	case BRN_1:
+	case BRN_2:
+	case BRN_4:
+	case BRN_8:
+		emit_top(e);
+		add_mem_imm8(e, 0, REG_VM, OFF_SP, -1);
+		cmp_mem_imm8(e, 0, RAX, TYPE_AT(0), Y_UNDEF);
+		jump_bytecode(e, CC_NE, target);
+		return 1;
+	case RET:
+		emit_set_pc(e, pc + 1);
+		op_reg(e, 1, 0x89, REG_VM, RDI);           // mov rdi, rbx
+		emit_call(e, FN(&vm_RET));
+		jmp_to(e, e->epilogue);
+		return 1;
+	default:
+		if (!handlers[opcode]) return 0;
+		emit_handler(e, handlers[opcode], pc + 1);
+		return 1;
+	}
+}
+
+/*
+ * Marks the instructions reachable from entry, following branches, in a map indexed by offset from entry. Functions
+ * are laid out one after the other, so this stops at the end of the function without knowing where it is.
+ */
+static unsigned char *find_reachable(const unsigned char *code, const size_t entry, size_t *size) {
+	size_t map_size = 64;
+	unsigned char *reachable = calloc(map_size, 1);
+	size_t work_size = 16, work_count = 0;
+	size_t *work = malloc(work_size * sizeof(size_t));
+	work[work_count++] = entry;
+	while (work_count) {
+		const size_t pc = work[--work_count];
+		while (pc - entry >= map_size) {
+			reachable = realloc(reachable, 2 * map_size);
+			memset(reachable + map_size, 0, map_size);
+			map_size *= 2;
+		}
+		if (reachable[pc - entry]) continue;
+		reachable[pc - entry] = 1;
+
+		const unsigned char opcode = code[pc];
+		const size_t length = instruction_length(code + pc);
+		const size_t width = branch_width(opcode);
+		if (work_count + 2 > work_size) {
+			work_size *= 2;
+			work = realloc(work, work_size * sizeof(size_t));
+		}
+		if (width) {
+			const size_t target = pc + length + (size_t) read_int(code + pc + length - width, width);
+			// jumps never leave the function, so anything before its start isn't valid bytecode.
+			if (target < entry) {
+				free(work);
+				free(reachable);
+				return NULL;
+			}
+			work[work_count++] = target;
+		}
+		if (!is_unconditional(opcode)) work[work_count++] = pc + length;
+	}
+	free(work);
+	*size = map_size;
+	return reachable;
+}
+
+static jit_fn jit_install(struct JIT *jit, const ByteBuffer *out) {
+	if (!jit->num_chunks || jit->chunk_used + out->count > jit->chunks[jit->num_chunks - 1].size) {
+		const size_t page = (size_t) sysconf(_SC_PAGESIZE);
+		size_t size = JIT_CHUNK_SIZE;
+		while (size < out->count) size *= 2;
+		size = (size + page - 1) / page * page;
+		void *chunk = mmap(NULL, size, PROT_READ | PROT_EXEC, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (chunk == MAP_FAILED) return NULL;
+		jit->chunks = realloc(jit->chunks, (jit->num_chunks + 1) * sizeof(struct JIT_Chunk));
+		jit->chunks[jit->num_chunks].bytes = chunk;
+		jit->chunks[jit->num_chunks].size = size;
+		jit->num_chunks++;
+		jit->chunk_used = 0;
+	}
+
+	const struct JIT_Chunk *chunk = jit->chunks + jit->num_chunks - 1;
+	unsigned char *start = chunk->bytes + jit->chunk_used;
+	if (mprotect(chunk->bytes, chunk->size, PROT_READ | PROT_WRITE)) return NULL;
+	memcpy(start, out->bytes, out->count);
+	if (mprotect(chunk->bytes, chunk->size, PROT_READ | PROT_EXEC)) return NULL;
+	jit->chunk_used += (out->count + 15) & ~(size_t) 15;
+
+	jit_fn fn;
+	memcpy(&fn, &start, sizeof(fn));
+	return fn;
+}
+
+static size_t find_start(const size_t *starts, const size_t count, const size_t pc) {
+	size_t lo = 0, hi = count;
+	while (lo < hi) {
+		const size_t mid = lo + (hi - lo) / 2;
+		if (starts[mid] < pc) lo = mid + 1;
+		else hi = mid;
+	}
+	return lo;
+}
+
+// compiles the function whose body starts at entry. Returns NULL if it has instructions without a template.
+static jit_fn jit_compile(struct JIT *jit, const unsigned char *code, const size_t entry) {
+	size_t map_size;
+	unsigned char *reachable = find_reachable(code, entry, &map_size);
+	if (!reachable) return NULL;
+
+	size_t count = 0;
+	for (size_t i = 0; i < map_size; i++) count += reachable[i];
+	size_t *starts = malloc(count * sizeof(size_t));
+	size_t *native = malloc(count * sizeof(size_t));
+	count = 0;
+	for (size_t i = 0; i < map_size; i++) {
+		if (reachable[i]) starts[count++] = entry + i;
+	}
+	free(reachable);
+
+	struct Emitter e = { bb_new(256), code, 0, NULL, 0, 0 };
+	emit_prologue(&e);
+	int ok = 1;
+	for (size_t i = 0; ok && i < count; i++) {
+		native[i] = e.out->count;
+		ok = emit_instruction(&e, starts[i]);
+	}
+	for (size_t i = 0; ok && i < e.num_fixups; i++) {
+		const size_t k = find_start(starts, count, e.fixups[i].target);
+		if (k == count || starts[k] != e.fixups[i].target) {
+			ok = 0;
+			break;
+		}
+		const int32_t rel = (int32_t) (native[k] - (e.fixups[i].at + 4));
+		memcpy(e.out->bytes + e.fixups[i].at, &rel, sizeof(rel));
+	}
+
+	const jit_fn fn = ok ? jit_install(jit, e.out) : NULL;
+	bb_del(e.out);
+	free(e.fixups);
+	free(starts);
+	free(native);
+	return fn;
+}
+
+static struct JIT_Function *jit_find(struct JIT *jit, const size_t addr) {
+	size_t i = (addr * 0x9E3779B97F4A7C15u) >> 16 & (jit->size - 1);
+	while (jit->functions[i].addr != JIT_EMPTY && jit->functions[i].addr != addr) {
+		i = (i + 1) & (jit->size - 1);
+	}
+	return jit->functions + i;
+}
+
+static void jit_init_functions(struct JIT *jit, const size_t size) {
+	jit->functions = malloc(size * sizeof(struct JIT_Function));
+	jit->size = size;
+	jit->count = 0;
+	for (size_t i = 0; i < size; i++) {
+		jit->functions[i].addr = JIT_EMPTY;
+		jit->functions[i].code = NULL;
+	}
+}
+
+static struct JIT_Function *jit_insert(struct JIT *jit, const size_t addr, const jit_fn code) {
+	if (2 * (jit->count + 1) > jit->size) {
+		struct JIT_Function *old = jit->functions;
+		const size_t old_size = jit->size;
+		jit_init_functions(jit, 2 * old_size);
+		for (size_t i = 0; i < old_size; i++) {
+			if (old[i].addr != JIT_EMPTY) *jit_find(jit, old[i].addr) = old[i];
+		}
+		jit->count = old_size / 2;
+		free(old);
+	}
+	struct JIT_Function *f = jit_find(jit, addr);
+	f->addr = addr;
+	f->code = code;
+	jit->count++;
+	return f;
+}
+
+struct JIT *jit_new(void) {
+	struct JIT *jit = malloc(sizeof(struct JIT));
+	jit_init_functions(jit, 16);
+	jit->chunks = NULL;
+	jit->num_chunks = 0;
+	jit->chunk_used = 0;
+	jit->depth = 0;
+	return jit;
+}
+
+static void jit_free_code(struct JIT *jit) {
+	for (size_t i = 0; i < jit->num_chunks; i++) {
+		munmap(jit->chunks[i].bytes, jit->chunks[i].size);
+	}
+	free(jit->chunks);
+	free(jit->functions);
+}
+
+void jit_del(struct JIT *jit) {
+	if (!jit) return;
+	jit_free_code(jit);
+	free(jit);
+}
+
+/*
+ * Forgets every compiled function, for when the code they were compiled from is replaced.
+ */
+void jit_reset(struct JIT *jit) {
+	if (!jit) return;
+	jit_free_code(jit);
+	jit_init_functions(jit, 16);
+	jit->chunks = NULL;
+	jit->num_chunks = 0;
+	jit->chunk_used = 0;
+}
+
+/*
+ * Runs the YASL function whose frame vm_CALL has just set up, until it returns. Returns JIT_UNAVAILABLE, without
+ * running anything, if the function can't be compiled, or if too many compiled calls are already running.
+ */
+int jit_run(struct VM *vm) {
+	struct JIT *jit = vm->jit;
+	if (!jit || jit->depth >= JIT_MAX_DEPTH || !YASL_ISFN(vm->stack[vm->fp])) return JIT_UNAVAILABLE;
+
+	const size_t addr = (size_t) YASL_GETFN(vm->stack[vm->fp]);
+	struct JIT_Function *f = jit_find(jit, addr);
+	if (f->addr == JIT_EMPTY) {
+		f = jit_insert(jit, addr, jit_compile(jit, vm->code, addr + FN_HEADER_SIZE));
+	}
+	if (!f->code) return JIT_UNAVAILABLE;
+
+	jit->depth++;
+	const int res = f->code(vm);
+	jit->depth--;
+	return res;
+}
+
+#else
+
+struct JIT *jit_new(void) {
+	return NULL;
+}
+
+void jit_del(struct JIT *jit) {
+}
+
+void jit_reset(struct JIT *jit) {
+}
+
+int jit_run(struct VM *vm) {
+	return JIT_UNAVAILABLE;
+}
+
+#endif
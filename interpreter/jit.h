@@ -0,0 +1,23 @@
+#pragma once
+
+#include "yasl_conf.h"
+
+struct VM;
+
+/*
+ * Baseline JIT for x86-64 (YASL_JIT). The first time a YASL function is called, its bytecode is compiled to machine code
+ * by stitching together a template for each of its instructions: constants, variables, arithmetic and comparisons on
+ * ints and floats, and branches are handled inline, and everything else calls the vm_* handler the interpreter uses.
+ * Functions with instructions that have no template (the register instructions) are left to the interpreter, as is
+ * the code outside of functions.
+ *
+ * Machine code works on the VM's own stack, frames and globals, so the interpreter and compiled functions can call
+ * each other freely. A compiled function is entered once vm_CALL has set up its frame, and returns once it has run RET.
+ */
+
+#define JIT_UNAVAILABLE -1             // returned by jit_run for functions that can't be compiled
+
+struct JIT *jit_new(void);
+void jit_del(struct JIT *jit);
+void jit_reset(struct JIT *jit);
+int jit_run(struct VM *vm);
@@ -2,6 +2,8 @@
 
 #include "YASL_Object.h"
 #include "hashtable/hashtable.h"
+#include "interpreter/collector.h"
+#include "slab/slab.h"
 
 int isvalueinarray(int64_t val, int64_t *arr, int size){
     int i;
@@ -12,56 +14,41 @@ int isvalueinarray(int64_t val, int64_t *arr, int size){
     return 0;
 }
 
-struct RC_UserData* ls_new_sized(const int base_size) {
-	struct RC_UserData *ls = malloc(sizeof(struct RC_UserData));
-	struct List *list = malloc(sizeof(struct List));
+struct RC_UserData* ls_new_sized(struct Collector *gc, const int base_size) {
+	struct RC_UserData *ls = slab_alloc(sizeof(struct RC_UserData));
+	struct List *list = slab_alloc(sizeof(struct List));
 	list->size = base_size;
 	list->count = 0;
 	list->items = malloc(sizeof(struct YASL_Object) * list->size);
 	ls->data = list;
-	ls->rc = rc_new();
+	ls->rc = NEW_RC();
+	ls->color = GC_BLACK;
+	ls->buffered = 0;
+	ls->gc = gc;
 	ls->destructor = ls_del_data;
 	ls->tag = T_LIST;
 	return ls;
 }
 
-struct RC_UserData* ls_new(void) {
-	return ls_new_sized(LS_BASESIZE);
+struct RC_UserData* ls_new(struct Collector *gc) {
+	return ls_new_sized(gc, LS_BASESIZE);
 }
 
 void ls_del_data(void *ls) {
 	for (int i = 0; i < ((struct List *) ls)->count; i++) dec_ref(((struct List *) ls)->items + i);
 	free(((struct List *) ls)->items);
-	free(ls);
+	slab_free(ls, sizeof(struct List));
 }
 
-void ls_del(struct RC_UserData *ls) {
-    for (int i = 0; i < ((struct List *)ls->data)->count; i++) dec_ref(((struct List *)ls->data)->items + i);
-    free(((struct List *)ls->data)->items);
-    free(((struct List *)ls->data));
-    rc_del(ls->rc);
-    free(ls);
-}
-
-static void ls_resize(struct List* ls, const int base_size) {
-    if (base_size < LS_BASESIZE) return;
-    struct RC_UserData *new_ls = ls_new_sized(base_size);
-    int i;
-    for (i = 0; i < ls->size; i++) {
-	    ((struct List *)new_ls->data)->items[i] = ls->items[i];
-    }
-    ls->size = ((struct List *)new_ls->data)->size;
-
-    struct YASL_Object* tmp_items = ls->items;
-    ls->items = ((struct List *)new_ls->data)->items;
-	((struct List *)new_ls->data)->items = tmp_items;
-
-    ls_del(new_ls);
+static void ls_resize(struct List* ls, const int64_t base_size) {
+	ls->items = realloc(ls->items, sizeof(struct YASL_Object) * base_size);
+	ls->size = base_size;
 }
 
 static void ls_resize_up(struct List* ls) {
-    const int new_size = ls->size * 2;
-    ls_resize(ls, new_size);
+	// lists built from literals are exactly as large as they need to be, so they may start out below the base size.
+	const int64_t new_size = ls->size < LS_BASESIZE ? LS_BASESIZE : ls->size * 2;
+	ls_resize(ls, new_size);
 }
 
 /*
@@ -86,7 +73,7 @@ void ls_append(struct List* ls, struct YASL_Object value) {
 }
 
 struct YASL_Object ls_search(struct List* ls, int64_t index) {
-    if (index < -ls->count || index >= ls->count) return (struct YASL_Object) { .type = Y_UNDEF, .value.ival = 0 };
+    if (index < -ls->count || index >= ls->count) return YASL_UNDEF();
     else if (0 <= index) return ls->items[index];
     else return ls->items[ls->count+index];
 }
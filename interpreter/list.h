@@ -14,8 +14,8 @@ struct List {
 };
 
 int isvalueinarray(int64_t val, int64_t *arr, int size);
-struct RC_UserData *ls_new(void);
-struct RC_UserData* ls_new_sized(const int base_size);
+struct RC_UserData *ls_new(struct Collector *gc);
+struct RC_UserData* ls_new_sized(struct Collector *gc, const int base_size);
 void ls_del_data(void *ls);
 void ls_insert(struct List* ls, int64_t index, struct YASL_Object value);
 void ls_append(struct List* ls, struct YASL_Object value);
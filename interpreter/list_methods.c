@@ -5,6 +5,7 @@
 #include "VM.h"
 #include "YASL_Object.h"
 #include "list.h"
+#include "sort.h"
 #include "yasl_state.h"
 
 int list___get(struct YASL_State *S) {
@@ -18,7 +19,7 @@ int list___get(struct YASL_State *S) {
         printf("IndexError\n");
         return -1;
     } else {
-        if (index.value.ival >= 0) {
+        if (YASL_GETINT(index) >= 0) {
             vm_pop((struct VM *)S);
             vm_push((struct VM *)S, ls->items[YASL_GETINT(index)]);
         }
@@ -92,8 +93,9 @@ int list_tostr_helper(struct YASL_State *S, void **buffer, size_t buffer_size, s
 				size_t tmp_buffer_size = buffer_count == buffer_size ? buffer_size * 2 : buffer_size;
 				void **tmp_buffer = malloc(tmp_buffer_size * sizeof(void *));
 				memcpy(tmp_buffer, buffer, sizeof(void *) * buffer_count);
-				tmp_buffer[buffer_size] = vm_peeklist((struct VM *)S, S->vm.sp);
-				list_tostr_helper(S, tmp_buffer, tmp_buffer_size, buffer_size + 1);
+				tmp_buffer[buffer_count] = vm_peeklist((struct VM *)S, S->vm.sp);
+				list_tostr_helper(S, tmp_buffer, tmp_buffer_size, buffer_count + 1);
+				free(tmp_buffer);
 			}
 		} else if (YASL_ISTABLE(VM_PEEK((struct VM *)S, S->vm.sp))) {
 			int found = 0;
@@ -116,7 +118,7 @@ int list_tostr_helper(struct YASL_State *S, void **buffer, size_t buffer_size, s
 				void **tmp_buffer = malloc(tmp_buffer_size * sizeof(void *));
 				memcpy(tmp_buffer, buffer, sizeof(void *) * buffer_count);
 				tmp_buffer[buffer_count] = vm_peeklist((struct VM *)S, S->vm.sp);
-				table_tostr_helper(S, tmp_buffer, tmp_buffer_size, buffer_size + 1);
+				table_tostr_helper(S, tmp_buffer, tmp_buffer_size, buffer_count + 1);
 				free(tmp_buffer);
 			}
 		} else {
@@ -171,7 +173,7 @@ int list_push(struct YASL_State *S) {
 int list_copy(struct YASL_State *S) {
 	ASSERT_TYPE((struct VM *)S, Y_LIST, "list.copy");
 	struct List *ls = YASL_GETLIST(vm_pop((struct VM *)S));
-	struct RC_UserData *new_ls = ls_new_sized(ls->size);
+	struct RC_UserData *new_ls = ls_new_sized(&S->vm.gc, ls->size);
 	((struct List *) new_ls->data)->count = ls->count;
 	memcpy(((struct List *) new_ls->data)->items, ls->items,
 	       ((struct List *) new_ls->data)->count * sizeof(struct YASL_Object));
@@ -186,7 +188,7 @@ int list___add(struct YASL_State *S) {
 	ASSERT_TYPE((struct VM *) S, Y_LIST, "list.__add");
 	struct List *a = YASL_GETLIST(vm_pop((struct VM *) S));
 	int64_t size = a->count + b->count;
-	struct RC_UserData *ptr = ls_new_sized(size);
+	struct RC_UserData *ptr = ls_new_sized(&S->vm.gc, size);
 	int64_t i;
 	for (i = 0; i < a->count; i++) {
 		ls_append(ptr->data, (a)->items[i]);
@@ -272,7 +274,7 @@ int list_slice(struct YASL_State *S) {
 		return -1;
 	}
 
-	struct RC_UserData *new_list = ls_new_sized(end - start);
+	struct RC_UserData *new_list = ls_new_sized(&S->vm.gc, end - start);
 
 	for (int64_t i = start; i < end; i++) {
 		ls_append(new_list->data, list->items[i]); // = list->items[i];
@@ -315,7 +317,7 @@ int list_join(struct YASL_State *S) {
 	}
 
 	vm_push((struct VM *)S, list->items[0]);
-	YASL_Types index = VM_PEEK((struct VM *)S, S->vm.sp).type;
+	YASL_Types index = YASL_GETTYPE(VM_PEEK((struct VM *)S, S->vm.sp));
 	struct YASL_Object key = YASL_STR(str_new_sized(strlen("tostr"), "tostr"));
 	struct YASL_Object result = table_search(S->vm.builtins_htable[index], key);
 	str_del(YASL_GETSTR(key));
@@ -341,7 +343,7 @@ int list_join(struct YASL_State *S) {
 		buffer_count += yasl_string_len(string);
 
 		vm_push((struct VM *)S, list->items[i]);
-		YASL_Types index = VM_PEEK((struct VM *)S, S->vm.sp).type;
+		YASL_Types index = YASL_GETTYPE(VM_PEEK((struct VM *)S, S->vm.sp));
 		struct YASL_Object key = YASL_STR(str_new_sized(strlen("tostr"), "tostr"));
 		struct YASL_Object result = table_search(S->vm.builtins_htable[index], key);
 		str_del(YASL_GETSTR(key));
@@ -362,103 +364,55 @@ int list_join(struct YASL_State *S) {
 	return 0;
 }
 
-const int SORT_TYPE_EMPTY = 0;
-const int SORT_TYPE_STR = -1;
-const int SORT_TYPE_NUM = 1;
-void sort(struct YASL_Object *list, const size_t len) {
-	// Base cases
-	struct YASL_Object tmpObj;
-	if (len < 2) return;
-	if (len == 2) {
-		if (yasl_object_cmp(list[0], list[1]) > 0) {
-			tmpObj = list[0];
-			list[0] = list[1];
-			list[1] = tmpObj;
-		}
-		return;
-	}
-
-	// Set sorting bounds
-	size_t left = 0;
-	size_t right = len-1;
-
-	// Determine random midpoint to use (good average case)
-	const size_t randIndex = rand() % len;
-	const struct YASL_Object mid = list[randIndex];
-
-	// Determine exact number of items less than mid (mid's index)
-	// Furthermore, ensure list is not homogenous to avoid infinite loops
-	size_t ltCount = 0;
-	int seenDifferent = 0;
-	for(size_t i = 0; i < len; i++) {
-		if(yasl_object_cmp(list[i], mid) < 0) ltCount++;
-		if(seenDifferent == 0 && yasl_object_cmp(list[0], list[i]) != 0) seenDifferent = 1;
-	}
-	if (seenDifferent == 0) return;
-
-	// Ensure all items are on the correct side of mid
-	while (left < right) {
-		while (yasl_object_cmp(list[left], mid) < 0) left++;
-		while (yasl_object_cmp(list[right], mid) >= 0) {
-			if (right == 0) break;
-			right--;
+/*
+ * Sorts the list in place, for list.sort and list.stablesort. With a function, the items are ordered by it (see
+ * sort_items_by), and they are detached from the list while it runs, so that it sees the list as empty and can't
+ * change the items being sorted.
+ */
+static int list_sort_impl(struct YASL_State *S, const char *name, int stable) {
+	struct VM *vm = (struct VM *) S;
+	const struct YASL_Object fn = vm_pop(vm);
+	ASSERT_TYPE(vm, Y_LIST, name);
+	struct List *list = YASL_GETLIST(vm_peek(vm));
+	// the list and the function stay on the stack while sorting, so that calls made by the sort can't free them.
+	vm->sp++;
+
+	if (YASL_ISUNDEF(fn)) {
+		if (sort_items(list->items, (size_t) list->count, stable)) {
+			printf("Only lists containing all strings or all numbers can be sorted.\n");
+			return -1;
 		}
-
-		int cmp = yasl_object_cmp(list[left], list[right]);
-		if (cmp > 0 && left < right) {
-			tmpObj = list[right];
-			list[right] = list[left];
-			list[left++] = tmpObj;
-			if(right == 0) break;
-			right--;
-		} else if (cmp == 0) {
-			left++;
-			if(right == 0) break;
-			right--;
+	} else if (YASL_ISFN(fn) || YASL_ISCFN(fn)) {
+		struct List items = *list;
+		list->size = LS_BASESIZE;
+		list->count = 0;
+		list->items = malloc(sizeof(struct YASL_Object) * list->size);
+		const int res = sort_items_by(vm, items.items, (size_t) items.count, fn, stable);
+
+		// whatever the function added to the list is dropped, and the items put back.
+		FOR_LIST(i, obj, list) dec_ref(&obj);
+		const int64_t added = list->count;
+		free(list->items);
+		*list = items;
+		if (res) return res;
+		if (added) {
+			printf("%s(...) function modified the list being sorted.\n", name);
+			return -1;
 		}
+	} else {
+		printf("%s(...) expected second argument of type fn, got %s.\n", name, YASL_TYPE_NAMES[YASL_GETTYPE(fn)]);
+		return -1;
 	}
 
-	// Let sort() finish that for us...
-	sort(list, ltCount);
-	sort(&list[ltCount], len - ltCount);
+	vm->sp -= 2;
+	vm_pushundef(vm);
+	return 0;
 }
-int list_sort(struct YASL_State *S) {
-	ASSERT_TYPE((struct VM *)S, Y_LIST, "list.sort");
-	struct List *list = vm_poplist((struct VM *)S);
-	int type = SORT_TYPE_EMPTY;
-
-	int err = 0;
-	for (int64_t i = 0; i < list->count; i++) {
-		switch (list->items[i].type) {
-		case Y_STR:
-			if (type == SORT_TYPE_EMPTY) {
-				type = SORT_TYPE_STR;
-			} else if (type == SORT_TYPE_NUM) {
-				err = -1;
-			}
-			break;
-		case Y_INT:
-		case Y_FLOAT:
-			if (type == SORT_TYPE_EMPTY) {
-				type = SORT_TYPE_NUM;
-			} else if (type == SORT_TYPE_STR) {
-				err = -1;
-			}
-			break;
-		default:
-			err = -1;
-		}
-
-		if (err != 0) {
-			printf("Only lists containing all strings or all numbers can be sorted.\n");
-			return err;
-		}
-	}
 
-	if (type != SORT_TYPE_EMPTY) {
-		sort(list->items, list->count);
-	}
+int list_sort(struct YASL_State *S) {
+	return list_sort_impl(S, "list.sort", 0);
+}
 
-	vm_pushundef((struct VM *)S);
-	return 0;
+int list_stablesort(struct YASL_State *S) {
+	return list_sort_impl(S, "list.stablesort", 1);
 }
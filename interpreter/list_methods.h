@@ -29,3 +29,5 @@ int list_clear(struct YASL_State *S);
 int list_join(struct YASL_State *S);
 
 int list_sort(struct YASL_State *S);
+
+int list_stablesort(struct YASL_State *S);
@@ -5,29 +5,19 @@
 #include "YASL_Object.h"
 #include "interpreter/list.h"
 #include "hashtable/hashtable.h"
+#include "interpreter/collector.h"
 #include "yasl_include.h"
 
-struct RC *rc_new(void) {
-	struct RC *rc = malloc(sizeof(struct RC));
-	rc->refs = 0;
-	rc->weak_refs = 0;
-	return rc;
-}
-
-void rc_del(struct RC *rc) {
-	free(rc);
-}
-
 static void inc_weak_ref(struct YASL_Object *v) {
-	//printf(K_GRN "inc_weak(%s): ", YASL_TYPE_NAMES[v->type]);
+	//printf(K_GRN "inc_weak(%s): ", YASL_TYPE_NAMES[YASL_GETTYPE(*v)]);
 	//print(*v);
 	//puts(K_END);
-	switch (v->type) {
-	case Y_STR_W:v->value.sval->rc->weak_refs++;
+	switch (YASL_GETTYPE(*v)) {
+	case Y_STR_W:YASL_GETSTR(*v)->rc.weak_refs++;
 		break;
-	case Y_LIST_W:v->value.uval->rc->weak_refs++;
+	case Y_LIST_W:YASL_GETUSERDATA(*v)->rc.weak_refs++;
 		break;
-	case Y_TABLE_W:v->value.uval->rc->weak_refs++;
+	case Y_TABLE_W:YASL_GETUSERDATA(*v)->rc.weak_refs++;
 		break;
 	default:puts("NOt Implemented");
 		break;
@@ -35,29 +25,37 @@ static void inc_weak_ref(struct YASL_Object *v) {
 }
 
 static void inc_strong_ref(struct YASL_Object *v) {
-	switch (v->type) {
-	case Y_STR:v->value.sval->rc->refs++;
-		//printf(K_BLU "after : %zd\n" K_END, v->value.sval->rc->refs);
+	switch (YASL_GETTYPE(*v)) {
+	case Y_STR:YASL_GETSTR(*v)->rc.refs++;
+		//printf(K_BLU "after : %zd\n" K_END, YASL_GETSTR(*v)->rc.refs);
 		//print(*v);
 		//puts("");
 		break;
 	case Y_LIST:
-	case Y_TABLE:v->value.uval->rc->refs++;
+	case Y_TABLE:YASL_GETUSERDATA(*v)->rc.refs++;
+		YASL_GETUSERDATA(*v)->color = GC_BLACK;
 		break;
-	case Y_CFN:v->value.cval->rc->refs++;
+	case Y_CFN:YASL_GETCFN(*v)->rc.refs++;
 		break;
+#if YASL_NAN_BOXING
+	case Y_INT:YASL_GETBIGINT(*v)->rc.refs++;
+		break;
+#endif
 	default:puts("NOt Implemented");
 		break;
 	}
 }
 
 void inc_ref(struct YASL_Object *v) {
-	switch (v->type) {
+	switch (YASL_GETTYPE(*v)) {
 	case Y_STR:
 	case Y_LIST:
 	case Y_TABLE:
 	case Y_CFN:inc_strong_ref(v);
 		break;
+	case Y_INT:
+		if (YASL_ISBIGINT(*v)) inc_strong_ref(v);
+		break;
 	case Y_STR_W:
 	case Y_LIST_W:
 	case Y_TABLE_W:inc_weak_ref(v);
@@ -67,21 +65,23 @@ void inc_ref(struct YASL_Object *v) {
 }
 
 static void dec_weak_ref(struct YASL_Object *v) {
-	switch (v->type) {
+	switch (YASL_GETTYPE(*v)) {
 	case Y_STR_W:
-		if (--(v->value.sval->rc->weak_refs) || v->value.sval->rc->refs) return;
-		str_del_rc(v->value.sval);
-		v->type = Y_UNDEF;
+		if (--(YASL_GETSTR(*v)->rc.weak_refs) || YASL_GETSTR(*v)->rc.refs) return;
+		str_del_rc(YASL_GETSTR(*v));
+		*v = YASL_UNDEF();
 		break;
 	case Y_LIST_W:
-		if (--(v->value.uval->rc->weak_refs) || v->value.uval->rc->refs) return;
-		ud_del_rc(v->value.uval);
-		v->type = Y_UNDEF;
+		if (--(YASL_GETUSERDATA(*v)->rc.weak_refs) || YASL_GETUSERDATA(*v)->rc.refs) return;
+		if (YASL_GETUSERDATA(*v)->buffered) return;
+		ud_del_rc(YASL_GETUSERDATA(*v));
+		*v = YASL_UNDEF();
 		break;
 	case Y_TABLE_W:
-		if (--(v->value.uval->rc->weak_refs) || v->value.uval->rc->refs) return;
-		ud_del_rc(v->value.uval);
-		v->type = Y_UNDEF;
+		if (--(YASL_GETUSERDATA(*v)->rc.weak_refs) || YASL_GETUSERDATA(*v)->rc.refs) return;
+		if (YASL_GETUSERDATA(*v)->buffered) return;
+		ud_del_rc(YASL_GETUSERDATA(*v));
+		*v = YASL_UNDEF();
 		break;
 	default:
 		puts("NoT IMPELemented");
@@ -90,40 +90,52 @@ static void dec_weak_ref(struct YASL_Object *v) {
 }
 
 void dec_strong_ref(struct YASL_Object *v) {
-	switch (v->type) {
+	switch (YASL_GETTYPE(*v)) {
 	case Y_STR:
-		//printf(K_MAG "after : %zd\n" K_END, v->value.sval->rc->refs - 1);
+		//printf(K_MAG "after : %zd\n" K_END, YASL_GETSTR(*v)->rc.refs - 1);
 		//print(*v);
 		//puts("");
-		if (--(v->value.sval->rc->refs)) return;
-		str_del_data(v->value.sval);
-		if (v->value.sval->rc->weak_refs) return;
-		str_del_rc(v->value.sval);
-		v->type = Y_UNDEF;
+		if (--(YASL_GETSTR(*v)->rc.refs)) return;
+		str_del_data(YASL_GETSTR(*v));
+		if (YASL_GETSTR(*v)->rc.weak_refs) return;
+		str_del_rc(YASL_GETSTR(*v));
+		*v = YASL_UNDEF();
 		break;
 	/* case Y_LIST:
-		if (--(v->value.uval->rc->refs)) return;
-		ls_del_data(v->value.uval);
-		if (v->value.uval->rc->weak_refs) return;
-		ls_del_rc(v->value.uval);
+		if (--(YASL_GETUSERDATA(*v)->rc.refs)) return;
+		ls_del_data(YASL_GETUSERDATA(*v));
+		if (YASL_GETUSERDATA(*v)->rc.weak_refs) return;
+		ls_del_rc(YASL_GETUSERDATA(*v));
 		break;
 	 */
 	case Y_LIST:
 	case Y_USERDATA:
 	case Y_TABLE:
-		if (--(v->value.uval->rc->refs)) return;
-		ud_del_data(v->value.uval);
-		if (v->value.uval->rc->weak_refs) return;
-		ud_del_rc(v->value.uval);
-		v->type = Y_UNDEF;
+		if (--(YASL_GETUSERDATA(*v)->rc.refs)) {
+			gc_possible_root(YASL_GETUSERDATA(*v));
+			return;
+		}
+		ud_del_data(YASL_GETUSERDATA(*v));
+		YASL_GETUSERDATA(*v)->color = GC_BLACK;
+		// the header of a possible root is freed by the cycle collector, since its buffer still points to it.
+		if (YASL_GETUSERDATA(*v)->rc.weak_refs || YASL_GETUSERDATA(*v)->buffered) return;
+		ud_del_rc(YASL_GETUSERDATA(*v));
+		*v = YASL_UNDEF();
 		break;
 	case Y_CFN:
-		if (--(v->value.cval->rc->refs)) return;
-		cfn_del_data(v->value.cval);
-		if (v->value.cval->rc->weak_refs) return;
-		cfn_del_rc(v->value.cval);
-		v->type = Y_UNDEF;
-		break;
+		if (--(YASL_GETCFN(*v)->rc.refs)) return;
+		cfn_del_data(YASL_GETCFN(*v));
+		if (YASL_GETCFN(*v)->rc.weak_refs) return;
+		cfn_del_rc(YASL_GETCFN(*v));
+		*v = YASL_UNDEF();
+		break;
+#if YASL_NAN_BOXING
+	case Y_INT:
+		if (--(YASL_GETBIGINT(*v)->rc.refs)) return;
+		bigint_del(YASL_GETBIGINT(*v));
+		*v = YASL_UNDEF();
+		break;
+#endif
 	default:
 		puts("NoT IMPELemented");
 		exit(EXIT_FAILURE);
@@ -131,12 +143,15 @@ void dec_strong_ref(struct YASL_Object *v) {
 }
 
 void dec_ref(struct YASL_Object *v) {
-	switch (v->type) {
+	switch (YASL_GETTYPE(*v)) {
 	case Y_STR:
 	case Y_LIST:
 	case Y_TABLE:
 	case Y_CFN:dec_strong_ref(v);
 		break;
+	case Y_INT:
+		if (YASL_ISBIGINT(*v)) dec_strong_ref(v);
+		break;
 	case Y_STR_W:
 	case Y_LIST_W:
 	case Y_TABLE_W:dec_weak_ref(v);
@@ -5,12 +5,16 @@
 
 struct YASL_Object;
 
+/*
+ * Reference counts, embedded in the header of every refcounted object (String_t, RC_UserData and CFunction_s), so
+ * that an object and its counts are a single allocation. An object's data is freed when refs drops to 0, and the
+ * object itself once weak_refs has dropped to 0 too.
+ */
 struct RC {
     size_t refs;
     size_t weak_refs;
 };
 
-struct RC *rc_new(void);
-void rc_del(struct RC *rc);
+#define NEW_RC() ((struct RC) { .refs = 0, .weak_refs = 0 })
 
 void dec_ref(struct YASL_Object *v);
@@ -0,0 +1,202 @@
+#include "sort.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "VM.h"
+#include "yasl_error.h"
+#include "yasl_include.h"
+
+#define NUM_VALUE(v) (YASL_ISINT(v) ? (yasl_float) YASL_GETINT(v) : YASL_GETFLOAT(v))
+#define STR_LESS(a, b) (yasl_string_cmp(YASL_GETSTR(a), YASL_GETSTR(b)) < 0)
+#define SORT_WITH(name, a, n, c) (stable ? name##_stable_sort(a, n, c) : name##_sort(a, n, c))
+
+// what a range of values has in common, which decides how they are compared.
+enum SortKind {
+	SORT_EMPTY,
+	SORT_INT,
+	SORT_FLOAT,
+	SORT_NUM,
+	SORT_STR,
+	SORT_MIXED
+};
+
+static enum SortKind sort_kind(enum SortKind kind, struct YASL_Object value) {
+	switch (YASL_GETTYPE(value)) {
+	case Y_INT:
+		if (kind == SORT_EMPTY || kind == SORT_INT) return SORT_INT;
+		return kind == SORT_FLOAT || kind == SORT_NUM ? SORT_NUM : SORT_MIXED;
+	case Y_FLOAT:
+		if (kind == SORT_EMPTY || kind == SORT_FLOAT) return SORT_FLOAT;
+		return kind == SORT_INT || kind == SORT_NUM ? SORT_NUM : SORT_MIXED;
+	case Y_STR:
+		return kind == SORT_EMPTY || kind == SORT_STR ? SORT_STR : SORT_MIXED;
+	default:
+		return SORT_MIXED;
+	}
+}
+
+/*
+ * Items, compared by type without any dispatch.
+ */
+#define SORT_NAME sort_int
+#define SORT_TYPE struct YASL_Object
+#define SORT_LESS(c, a, b) (YASL_GETINT(a) < YASL_GETINT(b))
+#include "sort_template.h"
+
+#define SORT_NAME sort_float
+#define SORT_TYPE struct YASL_Object
+#define SORT_LESS(c, a, b) (YASL_GETFLOAT(a) < YASL_GETFLOAT(b))
+#include "sort_template.h"
+
+#define SORT_NAME sort_num
+#define SORT_TYPE struct YASL_Object
+#define SORT_LESS(c, a, b) (NUM_VALUE(a) < NUM_VALUE(b))
+#include "sort_template.h"
+
+#define SORT_NAME sort_str
+#define SORT_TYPE struct YASL_Object
+#define SORT_LESS(c, a, b) STR_LESS(a, b)
+#include "sort_template.h"
+
+/*
+ * Items paired with their keys, compared by key.
+ */
+struct KeyedItem {
+	struct YASL_Object key;
+	struct YASL_Object item;
+};
+
+#define SORT_NAME sort_keyed_int
+#define SORT_TYPE struct KeyedItem
+#define SORT_LESS(c, a, b) (YASL_GETINT((a).key) < YASL_GETINT((b).key))
+#include "sort_template.h"
+
+#define SORT_NAME sort_keyed_num
+#define SORT_TYPE struct KeyedItem
+#define SORT_LESS(c, a, b) (NUM_VALUE((a).key) < NUM_VALUE((b).key))
+#include "sort_template.h"
+
+#define SORT_NAME sort_keyed_str
+#define SORT_TYPE struct KeyedItem
+#define SORT_LESS(c, a, b) STR_LESS((a).key, (b).key)
+#include "sort_template.h"
+
+/*
+ * Items compared by a YASL function. The first error it raises stops the sort.
+ */
+struct SortCall {
+	struct VM *vm;
+	struct YASL_Object fn;
+	int status;
+};
+
+// calls fn with args, leaving what it returns in result.
+static int sort_call_fn(struct VM *vm, struct YASL_Object fn, const struct YASL_Object *args, int num_args,
+			struct YASL_Object *result) {
+	const int fp = vm->fp;
+	int res;
+	vm_push(vm, fn);
+	if ((res = vm_INIT_CALL(vm))) return res;
+	for (int i = 0; i < num_args; i++) {
+		vm_push(vm, args[i]);
+	}
+	if ((res = vm_CALL(vm)) || (res = vm_finish_call(vm, fp))) return res;
+	*result = vm_pop(vm);
+	return YASL_SUCCESS;
+}
+
+static int sort_call_less(struct SortCall *call, struct YASL_Object a, struct YASL_Object b) {
+	if (call->status) return 0;
+	const struct YASL_Object args[] = { a, b };
+	struct YASL_Object result;
+	if ((call->status = sort_call_fn(call->vm, call->fn, args, 2, &result))) return 0;
+	if (YASL_ISINT(result)) return YASL_GETINT(result) < 0;
+	if (YASL_ISFLOAT(result)) return YASL_GETFLOAT(result) < 0;
+	YASL_PRINT_ERROR_TYPE("sort comparator must return a number, got %s.\n", YASL_TYPE_NAMES[YASL_GETTYPE(result)]);
+	call->status = YASL_TYPE_ERROR;
+	return 0;
+}
+
+#define SORT_NAME sort_call
+#define SORT_TYPE struct YASL_Object
+#define SORT_LESS(c, a, b) sort_call_less((struct SortCall *) (c), a, b)
+#define SORT_FAILED(c) (((struct SortCall *) (c))->status)
+#include "sort_template.h"
+
+int sort_items(struct YASL_Object *items, size_t len, int stable) {
+	enum SortKind kind = SORT_EMPTY;
+	for (size_t i = 0; i < len && kind != SORT_MIXED; i++) {
+		kind = sort_kind(kind, items[i]);
+	}
+
+	switch (kind) {
+	case SORT_EMPTY:
+		return YASL_SUCCESS;
+	case SORT_INT:
+		SORT_WITH(sort_int, items, len, NULL);
+		return YASL_SUCCESS;
+	case SORT_FLOAT:
+		SORT_WITH(sort_float, items, len, NULL);
+		return YASL_SUCCESS;
+	case SORT_NUM:
+		SORT_WITH(sort_num, items, len, NULL);
+		return YASL_SUCCESS;
+	case SORT_STR:
+		SORT_WITH(sort_str, items, len, NULL);
+		return YASL_SUCCESS;
+	default:
+		return YASL_TYPE_ERROR;
+	}
+}
+
+// sorts items by the key fn gives for each of them.
+static int sort_items_by_key(struct VM *vm, struct YASL_Object *items, size_t len, struct YASL_Object fn,
+			     int stable) {
+	struct KeyedItem *keyed = malloc(sizeof(struct KeyedItem) * len);
+	enum SortKind kind = SORT_EMPTY;
+	size_t count = 0;
+	int res = YASL_SUCCESS;
+	for (; count < len; count++) {
+		if ((res = sort_call_fn(vm, fn, items + count, 1, &keyed[count].key))) break;
+		inc_ref(&keyed[count].key);
+		keyed[count].item = items[count];
+		kind = sort_kind(kind, keyed[count].key);
+	}
+
+	if (res == YASL_SUCCESS) {
+		switch (kind) {
+		case SORT_INT:
+			SORT_WITH(sort_keyed_int, keyed, len, NULL);
+			break;
+		case SORT_FLOAT:
+		case SORT_NUM:
+			SORT_WITH(sort_keyed_num, keyed, len, NULL);
+			break;
+		case SORT_STR:
+			SORT_WITH(sort_keyed_str, keyed, len, NULL);
+			break;
+		case SORT_EMPTY:
+			break;
+		default:
+			YASL_PRINT_ERROR_TYPE("%s\n", "sort keys must be all strings or all numbers.");
+			res = YASL_TYPE_ERROR;
+		}
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		if (res == YASL_SUCCESS) items[i] = keyed[i].item;
+		dec_ref(&keyed[i].key);
+	}
+	free(keyed);
+	return res;
+}
+
+int sort_items_by(struct VM *vm, struct YASL_Object *items, size_t len, struct YASL_Object fn, int stable) {
+	const int num_args = YASL_ISCFN(fn) ? YASL_GETCFN(fn)->num_args : vm->code[YASL_GETFN(fn)];
+	if (num_args == 1) return sort_items_by_key(vm, items, len, fn, stable);
+
+	struct SortCall call = { vm, fn, YASL_SUCCESS };
+	SORT_WITH(sort_call, items, len, &call);
+	return call.status;
+}
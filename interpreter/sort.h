@@ -0,0 +1,22 @@
+#pragma once
+
+#include <stddef.h>
+
+#include "YASL_Object.h"
+
+struct VM;
+
+/*
+ * Sorts items in ascending order, comparing them directly when they are all ints, all floats, all numbers or all
+ * strings. Uses a pattern-defeating quicksort, or if stable is set, a merge sort (timsort) that keeps equal items in
+ * order and takes advantage of runs that are already sorted. Returns YASL_SUCCESS, or YASL_TYPE_ERROR without sorting
+ * if they are none of these.
+ */
+int sort_items(struct YASL_Object *items, size_t len, int stable);
+
+/*
+ * Sorts items by fn, which is called through vm. If fn takes one argument, items are ordered by fn(item), which is
+ * called once per item and must give all numbers or all strings. Otherwise, a goes before b if fn(a, b) is a number
+ * less than 0. stable is as for sort_items. Returns YASL_SUCCESS, or the error raised by fn.
+ */
+int sort_items_by(struct VM *vm, struct YASL_Object *items, size_t len, struct YASL_Object fn, int stable);
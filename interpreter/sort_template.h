@@ -0,0 +1,605 @@
+/*
+ * Pattern-defeating quicksort (pdqsort), after Orson Peters. Included once per element type and ordering, with:
+ *   SORT_NAME           prefix of the functions it defines,
+ *   SORT_TYPE           type of the elements,
+ *   SORT_LESS(c, a, b)  whether element a goes before element b, where c is the context pointer passed to the sort.
+ *                       It may evaluate its arguments more than once, so it is never given ones with side effects.
+ *   SORT_FAILED(c)      optionally, whether the sort should stop early (such as after an error in SORT_LESS).
+ * and defines SORT_NAME_sort(SORT_TYPE *a, size_t n, void *c), which sorts the n elements of a in place, and
+ * SORT_NAME_stable_sort(SORT_TYPE *a, size_t n, void *c), which does the same with a stable merge sort (timsort, after
+ * Tim Peters) that finds the runs already in a and merges them, galloping through whichever run keeps winning.
+ *
+ * Every loop is bounded by the size of the range it works on, so an ordering that isn't consistent (such as one given
+ * by a YASL function, or floats including NaN) leaves the elements in some order, but never reads or writes outside a.
+ */
+
+#ifndef SORT_INSERTION_THRESHOLD
+#define SORT_INSERTION_THRESHOLD 24       // ranges smaller than this are insertion sorted
+#define SORT_NINTHER_THRESHOLD 128        // ranges larger than this pick their pivot with Tukey's ninther
+#define SORT_PARTIAL_INSERTION_LIMIT 8    // most elements moved before giving up on a range that looks sorted
+#define SORT_MIN_MERGE 64                 // ranges smaller than this are merge sorted as a single run
+#define SORT_MIN_GALLOP 7                 // wins in a row after which a merge starts galloping
+#define SORT_MAX_RUNS 85                  // most runs pending a merge, given the invariants on their lengths
+#define SORT_CONCAT_(a, b) a##_##b
+#define SORT_CONCAT(a, b) SORT_CONCAT_(a, b)
+#define SORT_FN(name) SORT_CONCAT(SORT_NAME, name)
+#endif
+
+#ifndef SORT_FAILED
+#define SORT_FAILED(c) 0
+#endif
+
+static inline void SORT_FN(swap)(SORT_TYPE *a, SORT_TYPE *b) {
+	SORT_TYPE tmp = *a;
+	*a = *b;
+	*b = tmp;
+}
+
+static inline void SORT_FN(sort2)(SORT_TYPE *a, SORT_TYPE *b, void *c) {
+	if (SORT_LESS(c, *b, *a)) SORT_FN(swap)(a, b);
+}
+
+static inline void SORT_FN(sort3)(SORT_TYPE *a, SORT_TYPE *b, SORT_TYPE *d, void *c) {
+	SORT_FN(sort2)(a, b, c);
+	SORT_FN(sort2)(b, d, c);
+	SORT_FN(sort2)(a, b, c);
+}
+
+// moves a[i] back to its place among the sorted a[0..i), and returns how far it moved.
+static inline size_t SORT_FN(insert)(SORT_TYPE *a, size_t i, void *c) {
+	if (!SORT_LESS(c, a[i], a[i - 1])) return 0;
+	SORT_TYPE tmp = a[i];
+	size_t j = i;
+	do {
+		a[j] = a[j - 1];
+		j--;
+	} while (j > 0 && SORT_LESS(c, tmp, a[j - 1]));
+	a[j] = tmp;
+	return i - j;
+}
+
+static void SORT_FN(insertion_sort)(SORT_TYPE *a, size_t n, void *c) {
+	for (size_t i = 1; i < n; i++) {
+		SORT_FN(insert)(a, i, c);
+	}
+}
+
+// insertion sorts a, unless that takes moving more than a few elements. Returns whether a was sorted.
+static int SORT_FN(partial_insertion_sort)(SORT_TYPE *a, size_t n, void *c) {
+	size_t moved = 0;
+	for (size_t i = 1; i < n; i++) {
+		moved += SORT_FN(insert)(a, i, c);
+		if (moved > SORT_PARTIAL_INSERTION_LIMIT) return 0;
+	}
+	return 1;
+}
+
+static void SORT_FN(sift_down)(SORT_TYPE *a, size_t root, size_t n, void *c) {
+	for (;;) {
+		size_t child = 2 * root + 1;
+		if (child >= n) return;
+		if (child + 1 < n && SORT_LESS(c, a[child], a[child + 1])) child++;
+		if (!SORT_LESS(c, a[root], a[child])) return;
+		SORT_FN(swap)(a + root, a + child);
+		root = child;
+	}
+}
+
+static void SORT_FN(heap_sort)(SORT_TYPE *a, size_t n, void *c) {
+	for (size_t i = n / 2; i-- > 0;) {
+		SORT_FN(sift_down)(a, i, n, c);
+	}
+	for (size_t end = n; end-- > 1;) {
+		SORT_FN(swap)(a, a + end);
+		SORT_FN(sift_down)(a, 0, end, c);
+	}
+}
+
+/*
+ * Partitions a around the pivot a[0], with the elements less than it on its left and the others on its right. Returns
+ * the position the pivot ends up at, and sets already_partitioned if no elements had to be swapped.
+ */
+static size_t SORT_FN(partition_right)(SORT_TYPE *a, size_t n, int *already_partitioned, void *c) {
+	const SORT_TYPE pivot = a[0];
+	size_t first = 0;
+	size_t last = n;
+	while (++first < n && SORT_LESS(c, a[first], pivot));
+	while (first < last && !SORT_LESS(c, a[last - 1], pivot)) last--;
+	if (first < last) last--;
+	*already_partitioned = first >= last;
+	while (first < last) {
+		SORT_FN(swap)(a + first, a + last);
+		while (++first < n && SORT_LESS(c, a[first], pivot));
+		while (--last > 0 && !SORT_LESS(c, a[last], pivot));
+	}
+	const size_t pivot_pos = first - 1;
+	a[0] = a[pivot_pos];
+	a[pivot_pos] = pivot;
+	return pivot_pos;
+}
+
+/*
+ * Partitions a around the pivot a[0], with the elements equal to it on its left and the greater ones on its right. Used
+ * when the pivot equals the element before the range, so that runs of equal elements are dealt with in one pass.
+ */
+static size_t SORT_FN(partition_left)(SORT_TYPE *a, size_t n, void *c) {
+	const SORT_TYPE pivot = a[0];
+	size_t first = 0;
+	size_t last = n;
+	while (--last > 0 && SORT_LESS(c, pivot, a[last]));
+	while (first < last && !SORT_LESS(c, pivot, a[first + 1])) first++;
+	if (first < last) first++;
+	while (first < last) {
+		SORT_FN(swap)(a + first, a + last);
+		while (--last > 0 && SORT_LESS(c, pivot, a[last]));
+		while (++first < n - 1 && !SORT_LESS(c, pivot, a[first]));
+	}
+	a[0] = a[last];
+	a[last] = pivot;
+	return last;
+}
+
+static void SORT_FN(loop)(SORT_TYPE *a, size_t n, int bad_allowed, int leftmost, void *c) {
+	for (;;) {
+		if (SORT_FAILED(c)) return;
+		if (n < SORT_INSERTION_THRESHOLD) {
+			SORT_FN(insertion_sort)(a, n, c);
+			return;
+		}
+
+		// move the median of three (or the ninther, for large ranges) to a[0].
+		const size_t half = n / 2;
+		if (n > SORT_NINTHER_THRESHOLD) {
+			SORT_FN(sort3)(a, a + half, a + n - 1, c);
+			SORT_FN(sort3)(a + 1, a + half - 1, a + n - 2, c);
+			SORT_FN(sort3)(a + 2, a + half + 1, a + n - 3, c);
+			SORT_FN(sort3)(a + half - 1, a + half, a + half + 1, c);
+			SORT_FN(swap)(a, a + half);
+		} else {
+			SORT_FN(sort3)(a + half, a, a + n - 1, c);
+		}
+
+		// if the pivot equals the element before the range, so does everything up to the next greater element.
+		if (!leftmost && !SORT_LESS(c, a[-1], a[0])) {
+			const size_t pivot_pos = SORT_FN(partition_left)(a, n, c);
+			a += pivot_pos + 1;
+			n -= pivot_pos + 1;
+			continue;
+		}
+
+		int already_partitioned;
+		const size_t pivot_pos = SORT_FN(partition_right)(a, n, &already_partitioned, c);
+		const size_t l_size = pivot_pos;
+		const size_t r_size = n - pivot_pos - 1;
+
+		if (l_size < n / 8 || r_size < n / 8) {
+			// too many bad pivots means this input defeats quicksort, so it is heapsorted instead.
+			if (--bad_allowed == 0) {
+				SORT_FN(heap_sort)(a, n, c);
+				return;
+			}
+
+			// otherwise shuffle some elements around, to break whatever pattern led to the bad pivot.
+			if (l_size >= SORT_INSERTION_THRESHOLD) {
+				SORT_FN(swap)(a, a + l_size / 4);
+				SORT_FN(swap)(a + pivot_pos - 1, a + pivot_pos - l_size / 4);
+				if (l_size > SORT_NINTHER_THRESHOLD) {
+					SORT_FN(swap)(a + 1, a + l_size / 4 + 1);
+					SORT_FN(swap)(a + 2, a + l_size / 4 + 2);
+					SORT_FN(swap)(a + pivot_pos - 2, a + pivot_pos - (l_size / 4 + 1));
+					SORT_FN(swap)(a + pivot_pos - 3, a + pivot_pos - (l_size / 4 + 2));
+				}
+			}
+			if (r_size >= SORT_INSERTION_THRESHOLD) {
+				SORT_FN(swap)(a + pivot_pos + 1, a + pivot_pos + 1 + r_size / 4);
+				SORT_FN(swap)(a + n - 1, a + n - r_size / 4);
+				if (r_size > SORT_NINTHER_THRESHOLD) {
+					SORT_FN(swap)(a + pivot_pos + 2, a + pivot_pos + 2 + r_size / 4);
+					SORT_FN(swap)(a + pivot_pos + 3, a + pivot_pos + 3 + r_size / 4);
+					SORT_FN(swap)(a + n - 2, a + n - (1 + r_size / 4));
+					SORT_FN(swap)(a + n - 3, a + n - (2 + r_size / 4));
+				}
+			}
+		} else if (already_partitioned &&
+			   SORT_FN(partial_insertion_sort)(a, l_size, c) &&
+			   SORT_FN(partial_insertion_sort)(a + pivot_pos + 1, r_size, c)) {
+			// a range that was already partitioned is likely sorted, which a few cheap insertions can confirm.
+			return;
+		}
+
+		SORT_FN(loop)(a, l_size, bad_allowed, leftmost, c);
+		a += pivot_pos + 1;
+		n = r_size;
+		leftmost = 0;
+	}
+}
+
+static void SORT_FN(sort)(SORT_TYPE *a, size_t n, void *c) {
+	int bad_allowed = 0;
+	for (size_t m = n; m > 1; m >>= 1) {
+		bad_allowed++;
+	}
+	SORT_FN(loop)(a, n, bad_allowed, 1, c);
+}
+
+/*
+ * Stable merge sort. Runs are found left to right, extended to a minimum length by binary insertion and pushed onto a
+ * stack, where they are merged so that each run is longer than the two above it combined. This keeps the stack short
+ * and the merges balanced, while a range that is already sorted (or reversed) is a single run and is never merged.
+ */
+struct SORT_FN(run) {
+	size_t base;
+	size_t len;
+};
+
+struct SORT_FN(merge_state) {
+	SORT_TYPE *a;
+	void *c;
+	SORT_TYPE *tmp;
+	size_t tmp_size;
+	size_t min_gallop;
+	size_t num_runs;
+	struct SORT_FN(run) runs[SORT_MAX_RUNS];
+};
+
+static void SORT_FN(reverse)(SORT_TYPE *a, size_t n) {
+	for (size_t i = 0, j = n - 1; i < j; i++, j--) {
+		SORT_FN(swap)(a + i, a + j);
+	}
+}
+
+// inserts each of a[sorted..n) into the sorted a[0..sorted), after any elements equal to it.
+static void SORT_FN(binary_insertion_sort)(SORT_TYPE *a, size_t sorted, size_t n, void *c) {
+	for (size_t i = sorted; i < n; i++) {
+		const SORT_TYPE pivot = a[i];
+		size_t lo = 0;
+		size_t hi = i;
+		while (lo < hi) {
+			const size_t mid = lo + (hi - lo) / 2;
+			if (SORT_LESS(c, pivot, a[mid])) hi = mid;
+			else lo = mid + 1;
+		}
+		memmove(a + lo + 1, a + lo, sizeof(SORT_TYPE) * (i - lo));
+		a[lo] = pivot;
+	}
+}
+
+/*
+ * Returns the length of the run at the start of a, reversing it first if it is strictly descending. Descending runs
+ * have to be strict, since reversing equal elements would change their order.
+ */
+static size_t SORT_FN(count_run)(SORT_TYPE *a, size_t n, void *c) {
+	if (n < 2) return n;
+	size_t len = 2;
+	if (SORT_LESS(c, a[1], a[0])) {
+		while (len < n && SORT_LESS(c, a[len], a[len - 1])) len++;
+		SORT_FN(reverse)(a, len);
+	} else {
+		while (len < n && !SORT_LESS(c, a[len], a[len - 1])) len++;
+	}
+	return len;
+}
+
+// shortest run worth merging for n elements, chosen so that n / minrun is a power of 2, or just under one.
+static size_t SORT_FN(min_run)(size_t n) {
+	size_t r = 0;
+	while (n >= SORT_MIN_MERGE) {
+		r |= n & 1;
+		n >>= 1;
+	}
+	return n + r;
+}
+
+/*
+ * Returns how many elements of the sorted a[0..n) are less than key, searching outwards from a[hint] in steps of
+ * 1, 3, 7, ... and then by bisection between the last two steps. Takes n > 0 and hint < n.
+ */
+static size_t SORT_FN(gallop_left)(SORT_TYPE key, SORT_TYPE *a, size_t n, size_t hint, void *c) {
+	size_t lo;
+	size_t hi;
+	size_t ofs = 1;
+	size_t last_ofs = 0;
+	if (SORT_LESS(c, a[hint], key)) {
+		// a[hint + last_ofs] < key <= a[hint + ofs]
+		const size_t max_ofs = n - hint;
+		while (ofs < max_ofs && SORT_LESS(c, a[hint + ofs], key)) {
+			last_ofs = ofs;
+			ofs = 2 * ofs + 1;
+		}
+		if (ofs > max_ofs) ofs = max_ofs;
+		lo = hint + last_ofs + 1;
+		hi = hint + ofs;
+	} else {
+		// a[hint - ofs] < key <= a[hint - last_ofs]
+		const size_t max_ofs = hint + 1;
+		while (ofs < max_ofs && !SORT_LESS(c, a[hint - ofs], key)) {
+			last_ofs = ofs;
+			ofs = 2 * ofs + 1;
+		}
+		if (ofs > max_ofs) ofs = max_ofs;
+		lo = hint + 1 - ofs;
+		hi = hint - last_ofs;
+	}
+	while (lo < hi) {
+		const size_t mid = lo + (hi - lo) / 2;
+		if (SORT_LESS(c, a[mid], key)) lo = mid + 1;
+		else hi = mid;
+	}
+	return hi;
+}
+
+/*
+ * Returns how many elements of the sorted a[0..n) are less than or equal to key, searching in the same way as
+ * gallop_left.
+ */
+static size_t SORT_FN(gallop_right)(SORT_TYPE key, SORT_TYPE *a, size_t n, size_t hint, void *c) {
+	size_t lo;
+	size_t hi;
+	size_t ofs = 1;
+	size_t last_ofs = 0;
+	if (SORT_LESS(c, key, a[hint])) {
+		// a[hint - ofs] <= key < a[hint - last_ofs]
+		const size_t max_ofs = hint + 1;
+		while (ofs < max_ofs && SORT_LESS(c, key, a[hint - ofs])) {
+			last_ofs = ofs;
+			ofs = 2 * ofs + 1;
+		}
+		if (ofs > max_ofs) ofs = max_ofs;
+		lo = hint + 1 - ofs;
+		hi = hint - last_ofs;
+	} else {
+		// a[hint + last_ofs] <= key < a[hint + ofs]
+		const size_t max_ofs = n - hint;
+		while (ofs < max_ofs && !SORT_LESS(c, key, a[hint + ofs])) {
+			last_ofs = ofs;
+			ofs = 2 * ofs + 1;
+		}
+		if (ofs > max_ofs) ofs = max_ofs;
+		lo = hint + last_ofs + 1;
+		hi = hint + ofs;
+	}
+	while (lo < hi) {
+		const size_t mid = lo + (hi - lo) / 2;
+		if (SORT_LESS(c, key, a[mid])) hi = mid;
+		else lo = mid + 1;
+	}
+	return hi;
+}
+
+static SORT_TYPE *SORT_FN(get_tmp)(struct SORT_FN(merge_state) *ms, size_t n) {
+	if (ms->tmp_size < n) {
+		free(ms->tmp);
+		ms->tmp = malloc(sizeof(SORT_TYPE) * n);
+		ms->tmp_size = n;
+	}
+	return ms->tmp;
+}
+
+/*
+ * Merges the runs a[0..na) and a[na..na + nb), where na <= nb, the first element of b goes before the first of a, and
+ * the last element of a goes after the last of b. a is moved aside, and the merge fills the range from the left. Once
+ * one run has won SORT_MIN_GALLOP times in a row, the merge gallops, looking for where the next element of the other
+ * run goes and moving everything before it at once, until that stops paying off.
+ */
+static void SORT_FN(merge_lo)(struct SORT_FN(merge_state) *ms, SORT_TYPE *a, size_t na, size_t nb) {
+	void *c = ms->c;
+	SORT_TYPE *pa = SORT_FN(get_tmp)(ms, na);
+	SORT_TYPE *pb = a + na;
+	SORT_TYPE *dest = a;
+	size_t min_gallop = ms->min_gallop;
+	memcpy(pa, a, sizeof(SORT_TYPE) * na);
+
+	*dest++ = *pb++;
+	if (--nb == 0) goto done;
+	if (na == 1) goto copy_b;
+
+	for (;;) {
+		size_t a_wins = 0;
+		size_t b_wins = 0;
+		do {
+			if (SORT_LESS(c, *pb, *pa)) {
+				*dest++ = *pb++;
+				b_wins++;
+				a_wins = 0;
+				if (--nb == 0) goto done;
+			} else {
+				*dest++ = *pa++;
+				a_wins++;
+				b_wins = 0;
+				if (--na == 1) goto copy_b;
+			}
+		} while (a_wins < min_gallop && b_wins < min_gallop);
+
+		min_gallop++;
+		do {
+			if (min_gallop > 1) min_gallop--;
+			size_t k = a_wins = SORT_FN(gallop_right)(*pb, pa, na, 0, c);
+			if (k) {
+				memcpy(dest, pa, sizeof(SORT_TYPE) * k);
+				dest += k;
+				pa += k;
+				na -= k;
+				if (na == 1) goto copy_b;
+				// only if the ordering isn't consistent.
+				if (na == 0) goto done;
+			}
+			*dest++ = *pb++;
+			if (--nb == 0) goto done;
+
+			k = b_wins = SORT_FN(gallop_left)(*pa, pb, nb, 0, c);
+			if (k) {
+				memmove(dest, pb, sizeof(SORT_TYPE) * k);
+				dest += k;
+				pb += k;
+				nb -= k;
+				if (nb == 0) goto done;
+			}
+			*dest++ = *pa++;
+			if (--na == 1) goto copy_b;
+		} while (a_wins >= SORT_MIN_GALLOP || b_wins >= SORT_MIN_GALLOP);
+		min_gallop++;
+	}
+
+copy_b:
+	// the last element of a goes after all of what is left of b.
+	memmove(dest, pb, sizeof(SORT_TYPE) * nb);
+	dest[nb] = *pa;
+	ms->min_gallop = min_gallop;
+	return;
+done:
+	memcpy(dest, pa, sizeof(SORT_TYPE) * na);
+	ms->min_gallop = min_gallop;
+}
+
+/*
+ * Merges the runs a[0..na) and a[na..na + nb) like merge_lo, but for na >= nb: b is moved aside, and the merge fills
+ * the range from the right. Counting na and nb down, the next free slot is always a[na + nb - 1].
+ */
+static void SORT_FN(merge_hi)(struct SORT_FN(merge_state) *ms, SORT_TYPE *a, size_t na, size_t nb) {
+	void *c = ms->c;
+	SORT_TYPE *b = SORT_FN(get_tmp)(ms, nb);
+	size_t min_gallop = ms->min_gallop;
+	memcpy(b, a + na, sizeof(SORT_TYPE) * nb);
+
+	a[na + nb - 1] = a[na - 1];
+	if (--na == 0) goto done;
+	if (nb == 1) goto copy_a;
+
+	for (;;) {
+		size_t a_wins = 0;
+		size_t b_wins = 0;
+		do {
+			if (SORT_LESS(c, b[nb - 1], a[na - 1])) {
+				a[na + nb - 1] = a[na - 1];
+				a_wins++;
+				b_wins = 0;
+				if (--na == 0) goto done;
+			} else {
+				a[na + nb - 1] = b[nb - 1];
+				b_wins++;
+				a_wins = 0;
+				if (--nb == 1) goto copy_a;
+			}
+		} while (a_wins < min_gallop && b_wins < min_gallop);
+
+		min_gallop++;
+		do {
+			if (min_gallop > 1) min_gallop--;
+			size_t k = a_wins = na - SORT_FN(gallop_right)(b[nb - 1], a, na, na - 1, c);
+			if (k) {
+				na -= k;
+				memmove(a + na + nb, a + na, sizeof(SORT_TYPE) * k);
+				if (na == 0) goto done;
+			}
+			a[na + nb - 1] = b[nb - 1];
+			if (--nb == 1) goto copy_a;
+
+			k = b_wins = nb - SORT_FN(gallop_left)(a[na - 1], b, nb, nb - 1, c);
+			if (k) {
+				nb -= k;
+				memcpy(a + na + nb, b + nb, sizeof(SORT_TYPE) * k);
+				if (nb == 1) goto copy_a;
+				// only if the ordering isn't consistent.
+				if (nb == 0) goto done;
+			}
+			a[na + nb - 1] = a[na - 1];
+			if (--na == 0) goto done;
+		} while (a_wins >= SORT_MIN_GALLOP || b_wins >= SORT_MIN_GALLOP);
+		min_gallop++;
+	}
+
+copy_a:
+	// the first element of b goes before all of what is left of a.
+	memmove(a + 1, a, sizeof(SORT_TYPE) * na);
+	a[0] = b[0];
+	ms->min_gallop = min_gallop;
+	return;
+done:
+	memcpy(a + na, b, sizeof(SORT_TYPE) * nb);
+	ms->min_gallop = min_gallop;
+}
+
+// merges the runs at i and i + 1 on the stack.
+static void SORT_FN(merge_at)(struct SORT_FN(merge_state) *ms, size_t i) {
+	void *c = ms->c;
+	size_t base = ms->runs[i].base;
+	size_t na = ms->runs[i].len;
+	size_t nb = ms->runs[i + 1].len;
+	SORT_TYPE *b = ms->a + ms->runs[i + 1].base;
+
+	ms->runs[i].len = na + nb;
+	if (i + 3 == ms->num_runs) ms->runs[i + 1] = ms->runs[i + 2];
+	ms->num_runs--;
+
+	// elements of a that go before all of b, and elements of b that go after all of a, are already in place.
+	const size_t k = SORT_FN(gallop_right)(b[0], ms->a + base, na, 0, c);
+	base += k;
+	na -= k;
+	if (na == 0) return;
+	nb = SORT_FN(gallop_left)(ms->a[base + na - 1], b, nb, nb - 1, c);
+	if (nb == 0) return;
+
+	if (na <= nb) SORT_FN(merge_lo)(ms, ms->a + base, na, nb);
+	else SORT_FN(merge_hi)(ms, ms->a + base, na, nb);
+}
+
+// merges runs until, from the top of the stack down, each one is longer than the one above it and the two above it.
+static void SORT_FN(merge_collapse)(struct SORT_FN(merge_state) *ms) {
+	struct SORT_FN(run) *runs = ms->runs;
+	while (ms->num_runs > 1) {
+		size_t i = ms->num_runs - 2;
+		if ((i > 0 && runs[i - 1].len <= runs[i].len + runs[i + 1].len) ||
+		    (i > 1 && runs[i - 2].len <= runs[i - 1].len + runs[i].len)) {
+			if (runs[i - 1].len < runs[i + 1].len) i--;
+		} else if (runs[i].len > runs[i + 1].len) {
+			return;
+		}
+		SORT_FN(merge_at)(ms, i);
+	}
+}
+
+static void SORT_FN(merge_force_collapse)(struct SORT_FN(merge_state) *ms) {
+	while (ms->num_runs > 1) {
+		size_t i = ms->num_runs - 2;
+		if (i > 0 && ms->runs[i - 1].len < ms->runs[i + 1].len) i--;
+		SORT_FN(merge_at)(ms, i);
+	}
+}
+
+static void SORT_FN(stable_sort)(SORT_TYPE *a, size_t n, void *c) {
+	if (n < 2) return;
+	if (n < SORT_MIN_MERGE) {
+		SORT_FN(binary_insertion_sort)(a, SORT_FN(count_run)(a, n, c), n, c);
+		return;
+	}
+
+	struct SORT_FN(merge_state) ms;
+	ms.a = a;
+	ms.c = c;
+	ms.tmp = NULL;
+	ms.tmp_size = 0;
+	ms.min_gallop = SORT_MIN_GALLOP;
+	ms.num_runs = 0;
+
+	const size_t min_run = SORT_FN(min_run)(n);
+	for (size_t base = 0; base < n && !SORT_FAILED(c);) {
+		size_t len = SORT_FN(count_run)(a + base, n - base, c);
+		if (len < min_run) {
+			const size_t forced = n - base < min_run ? n - base : min_run;
+			SORT_FN(binary_insertion_sort)(a + base, len, forced, c);
+			len = forced;
+		}
+		ms.runs[ms.num_runs].base = base;
+		ms.runs[ms.num_runs].len = len;
+		ms.num_runs++;
+		SORT_FN(merge_collapse)(&ms);
+		base += len;
+	}
+	SORT_FN(merge_force_collapse)(&ms);
+	free(ms.tmp);
+}
+
+#undef SORT_NAME
+#undef SORT_TYPE
+#undef SORT_LESS
+#undef SORT_FAILED
@@ -16,7 +16,7 @@ int str___get(struct YASL_State *S) {
 	struct YASL_Object index = vm_pop((struct VM *)S);
 	ASSERT_TYPE((struct VM *)S, Y_STR, "str.__get");
 	String_t *str = YASL_GETSTR(vm_pop((struct VM *)S));
-	if (index.type != Y_INT) {
+	if (YASL_GETTYPE(index) != Y_INT) {
 		return -1;
 		vm_push((struct VM *)S, YASL_UNDEF());
 	} else if (YASL_GETINT(index) < -yasl_string_len(str) || YASL_GETINT(index) >= yasl_string_len(str)) {
@@ -377,15 +377,16 @@ int str_replace(struct YASL_State *S) {
 	}
 
 	ByteBuffer *buff = bb_new(yasl_string_len(str));
+	struct StrSearch search;
+	str_search_init(&search, search_str_ptr, search_len);
 	size_t i = 0;
-	while (i < str_len) {
-		if (search_len <= str_len - i && memcmp(str_ptr + i, search_str_ptr, search_len) == 0) {
-			bb_append(buff, replace_str_ptr, yasl_string_len(replace_str));
-			i += search_len;
-		} else {
-			bb_add_byte(buff, str_ptr[i++]);
-		}
+	int64_t found;
+	while ((found = str_search_next(&search, (char *) str_ptr, str_len, i)) >= 0) {
+		bb_append(buff, str_ptr + i, (size_t) found - i);
+		bb_append(buff, replace_str_ptr, yasl_string_len(replace_str));
+		i = (size_t) found + search_len;
 	}
+	bb_append(buff, str_ptr + i, str_len - i);
 
 	char *new_str = malloc(buff->count);
 	memcpy(new_str, buff->bytes, buff->count);
@@ -413,14 +414,17 @@ int str_count(struct YASL_State *S) {
 	ASSERT_TYPE((struct VM *)S, Y_STR, "str.count");
 	String_t *haystack = vm_popstr((struct VM *)S);
 
-	int64_t nLen = yasl_string_len(needle);
-	int64_t hLen = yasl_string_len(haystack);
+	// occurrences don't overlap, and an empty needle occurs at every position.
+	const size_t nLen = (size_t) yasl_string_len(needle);
+	const size_t hLen = (size_t) yasl_string_len(haystack);
+	struct StrSearch search;
+	str_search_init(&search, needle->str + needle->start, nLen);
 	int64_t count = 0;
-	for(int64_t i = 0; i + nLen <= hLen; i++) {
-		if(memcmp(needle->str + needle->start, haystack->str + haystack->start + i, nLen) == 0) {
-			count++;
-			i += nLen-1;
-		}
+	int64_t found;
+	size_t i = 0;
+	while ((found = str_search_next(&search, haystack->str + haystack->start, hLen, i)) >= 0) {
+		count++;
+		i = (size_t) found + (nLen ? nLen : 1);
 	}
 	vm_pushint((struct VM *)S, count);
 	return 0;
@@ -437,21 +441,17 @@ int str_split(struct YASL_State *S) {
 		printf("Error: str.split(...) requires type %x of length > 0 as second argument\n", Y_STR);
 		return -1;
 	}
-	int64_t end = 0, start = 0;
-	struct RC_UserData *result = ls_new();
-	while (end + yasl_string_len(needle) <= yasl_string_len(haystack)) {
-		if (!memcmp(haystack->str + haystack->start + end,
-			    needle->str + needle->start,
-			    yasl_string_len(needle))) {
-			ls_append(result->data,
-				  YASL_STR(
-					  str_new_substring(start + haystack->start, end + haystack->start, haystack)));
-			end += yasl_string_len(needle);
-			start = end;
-		} else {
-			end++;
-		}
-	}
+	struct StrSearch search;
+	str_search_init(&search, needle->str + needle->start, (size_t) yasl_string_len(needle));
+	int64_t end, start = 0;
+	struct RC_UserData *result = ls_new(&S->vm.gc);
+	while ((end = str_search_next(&search, haystack->str + haystack->start, (size_t) yasl_string_len(haystack),
+				      (size_t) start)) >= 0) {
+		ls_append(result->data,
+			  YASL_STR(str_new_substring(start + haystack->start, end + haystack->start, haystack)));
+		start = end + yasl_string_len(needle);
+	}
+	end = yasl_string_len(haystack);
 	ls_append(result->data, YASL_STR(str_new_substring(start + haystack->start, end + haystack->start, haystack)));
 	vm_push((struct VM *)S, YASL_LIST(result));
 	return 0;
@@ -11,7 +11,7 @@ int table___get(struct YASL_State *S) {
     ASSERT_TYPE((struct VM *)S, Y_TABLE, "table.__get");
     struct Table* ht = YASL_GETTABLE(vm_peek((struct VM *)S));
     struct YASL_Object result = table_search(ht, key);
-    if (result.type == Y_END) {
+    if (YASL_GETTYPE(result) == Y_END) {
         S->vm.sp++;  // TODO: fix this
         //vm_push((struct VM *)S, key);
         return -1;
@@ -30,7 +30,7 @@ int table___set(struct YASL_State *S) {
 	struct Table *ht = YASL_GETTABLE(vm_pop((struct VM *)S));
 
 	if (YASL_ISLIST(key) || YASL_ISTABLE(key) || YASL_ISUSERDATA(key)) {
-		printf("Error: unable to use mutable object of type %x as key.\n", key.type);
+		printf("Error: unable to use mutable object of type %x as key.\n", YASL_GETTYPE(key));
 		return -1;
 	}
 	table_insert(ht, key, val);
@@ -39,7 +39,7 @@ int table___set(struct YASL_State *S) {
 }
 
 int object_tostr(struct YASL_State *S) {
-	YASL_Types index = VM_PEEK((struct VM *)S, S->vm.sp).type;
+	YASL_Types index = YASL_GETTYPE(VM_PEEK((struct VM *)S, S->vm.sp));
 	struct YASL_Object key = YASL_STR(str_new_sized(strlen("tostr"), "tostr"));
 	struct YASL_Object result = table_search(S->vm.builtins_htable[index], key);
 	str_del(YASL_GETSTR(key));
@@ -107,7 +107,7 @@ int table_tostr_helper(struct YASL_State *S, void **buffer, size_t buffer_size,
 				void **tmp_buffer = malloc(tmp_buffer_size * sizeof(void *));
 				memcpy(tmp_buffer, buffer, sizeof(void *) * buffer_count);
 				tmp_buffer[buffer_count] = vm_peeklist((struct VM *)S, S->vm.sp);
-				list_tostr_helper(S, tmp_buffer, tmp_buffer_size, buffer_size + 1);
+				list_tostr_helper(S, tmp_buffer, tmp_buffer_size, buffer_count + 1);
 				free(tmp_buffer);
 			}
 		} else if (YASL_ISTABLE(VM_PEEK((struct VM *)S, S->vm.sp))) {
@@ -130,8 +130,9 @@ int table_tostr_helper(struct YASL_State *S, void **buffer, size_t buffer_size,
 				size_t tmp_buffer_size = buffer_count == buffer_size ? buffer_size * 2 : buffer_size;
 				void **tmp_buffer = malloc(tmp_buffer_size * sizeof(void *));
 				memcpy(tmp_buffer, buffer, sizeof(void *) * buffer_count);
-				tmp_buffer[buffer_size] = vm_peeklist((struct VM *)S, S->vm.sp);
-				table_tostr_helper(S, tmp_buffer, tmp_buffer_size, buffer_size + 1);
+				tmp_buffer[buffer_count] = vm_peeklist((struct VM *)S, S->vm.sp);
+				table_tostr_helper(S, tmp_buffer, tmp_buffer_size, buffer_count + 1);
+				free(tmp_buffer);
 			}
 		} else {
 			vm_stringify_top((struct VM *)S);
@@ -184,7 +185,7 @@ int table_tostr(struct YASL_State *S) {
 int table_keys(struct YASL_State *S) {
 	ASSERT_TYPE((struct VM *)S, Y_TABLE, "table.keys");
 	struct Table *ht = YASL_GETTABLE(vm_pop((struct VM *)S));
-	struct RC_UserData *ls = ls_new();
+	struct RC_UserData *ls = ls_new(&S->vm.gc);
 	FOR_TABLE(i, item, ht) {
 			ls_append(ls->data, (item->key));
 		}
@@ -196,7 +197,7 @@ int table_keys(struct YASL_State *S) {
 int table_values(struct YASL_State *S) {
 	ASSERT_TYPE((struct VM *)S, Y_TABLE, "table.values");
 	struct Table *ht = YASL_GETTABLE(vm_pop((struct VM *)S));
-	struct RC_UserData *ls = ls_new();
+	struct RC_UserData *ls = ls_new(&S->vm.gc);
 	FOR_TABLE(i, item, ht) {
 		ls_append(ls->data, (item->value));
 	}
@@ -207,11 +208,10 @@ int table_values(struct YASL_State *S) {
 int table_clone(struct YASL_State *S) {
 	ASSERT_TYPE((struct VM *)S, Y_TABLE, "table.clone");
 	struct Table *ht = YASL_GETTABLE(vm_pop((struct VM *)S));
-	struct RC_UserData *new_ht = rcht_new_sized(ht->base_size);
+	struct RC_UserData *new_ht = rcht_new_sized(&S->vm.gc, ht->base_size);
 
+	table_reserve(new_ht->data, ht->count);
 	FOR_TABLE(i, item, ht) {
-		inc_ref(&item->key);
-		inc_ref(&item->value);
 		table_insert(new_ht->data, item->key, item->value);
 	}
 
@@ -223,14 +223,7 @@ int table_clear(struct YASL_State *S) {
 	ASSERT_TYPE((struct VM *)S, Y_TABLE, "table.clear");
 	struct Table* ht = YASL_GETTABLE(vm_peek((struct VM *)S));
 	inc_ref(&vm_peek((struct VM *)S));
-	FOR_TABLE(i, item, ht) {
-		del_item(item);
-	}
-
-	ht->count = 0;
-	ht->size = HT_BASESIZE;
-	free(ht->items);
-	ht->items = calloc((size_t) ht->size, sizeof(Item_t));
+	table_rm_all(ht);
 	dec_ref(&vm_peek((struct VM *)S));
 	vm_pop((struct VM *)S);
 	vm_pushundef((struct VM *)S);
@@ -2,11 +2,16 @@
 
 #include <stdlib.h>
 
+#include "interpreter/collector.h"
+#include "slab/slab.h"
+
 struct RC_UserData *ud_new(void *data, int tag, void (*destructor)(void *)) {
-	struct RC_UserData *ud = malloc(sizeof(struct RC_UserData));
+	struct RC_UserData *ud = slab_alloc(sizeof(struct RC_UserData));
 	ud->tag = tag;
-	ud->rc = rc_new();
-	//ud->mt = NULL;
+	ud->rc = NEW_RC();
+	ud->color = GC_BLACK;
+	ud->buffered = 0;
+	ud->gc = NULL;
 	ud->destructor = destructor;
 	ud->data = data;
 	return ud;
@@ -17,13 +22,10 @@ void ud_del_data(struct RC_UserData *ud) {
 }
 
 void ud_del_rc(struct RC_UserData *ud) {
-    rc_del(ud->rc);
-    free(ud);
+    slab_free(ud, sizeof(struct RC_UserData));
 }
 
 void ud_del(struct RC_UserData *ud) {
     ud->destructor(ud->data);
-    // dec_ref(ud->mt);
-    rc_del(ud->rc);
-    free(ud);
+    slab_free(ud, sizeof(struct RC_UserData));
 }
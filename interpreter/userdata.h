@@ -2,13 +2,15 @@
 
 #include "interpreter/refcount.h"
 
-struct RC_Table;
+struct Collector;
 
 struct RC_UserData {
-	struct RC *rc;        // DO NOT REARRANGE. RC MUST BE THE FIRST MEMBER OF THIS STRUCT.
+	struct RC rc;         // DO NOT REARRANGE. RC MUST BE THE FIRST MEMBER OF THIS STRUCT.
 	int tag;
+	unsigned char color;          // state for the cycle collector, see interpreter/collector.h.
+	unsigned char buffered;       // whether the cycle collector holds this as a possible root.
 	void (*destructor)(void *);
-	struct RC_Table *mt;
+	struct Collector *gc;         // collector of the state that made this list or table, or NULL.
 	void *data;
 };
 
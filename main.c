@@ -7,6 +7,7 @@
 #include "yasl-std-io.h"
 #include "yasl-std-math.h"
 #include "yasl_state.h"
+#include "compiler/bytecode_file.h"
 
 
 #define VERSION "v0.4.1"
@@ -17,12 +18,21 @@ static int main_error(int argc, char **argv) {
 	return EXIT_FAILURE;
 }
 
+static int main_bad_option(char *option) {
+	printf("ERROR: Unknown option %s. Type `yasl -h` for help (without the backticks).\n", option);
+	return EXIT_FAILURE;
+}
+
 static int main_help(int argc, char **argv) {
 	puts("usage: yasl [option] [file]\n"
 	     "options:\n"
 	     "\t-h: this menu\n"
 	     "\t-V: print current version\n"
-	     "\tfile: name of file containing script"
+	     "\t-r: compile simple arithmetic to register instructions\n"
+	     "\t-O0: disable optimizations (peephole optimizer, superinstructions, constant propagation and inlining)\n"
+	     "\t-J0: disable the JIT, and interpret all code\n"
+	     "\t-c file -o output: compile file to bytecode, and write it to output instead of running it\n"
+	     "\tfile: name of file containing script, or of a bytecode file written with -c"
 	);
 	exit(EXIT_SUCCESS);
 }
@@ -32,20 +42,55 @@ static int main_version(int argc, char **argv) {
 	exit(EXIT_SUCCESS);
 }
 
-static int main_file(int argc, char **argv) {
-	if (!strcmp(argv[1], "-h")) {
-		return main_help(argc, argv);
-	} else if (!strcmp(argv[1], "-V")) {
-		return main_version(argc, argv);
+// enables exactly the given options, including turning off those on by default.
+static void set_options(struct YASL_State *S, int options) {
+	YASL_setoption(S, options, 1);
+	YASL_setoption(S, ~options, 0);
+}
+
+static int main_compile(char *filename, char *output, int options) {
+	struct YASL_State *S = YASL_newstate(filename);
+
+	if (!S) {
+		puts("ERROR: cannot open file.");
+		exit(EXIT_FAILURE);
+	}
+
+	set_options(S, options);
+
+	// the standard libraries are declared as they are when running, so that globals get the same indices.
+	YASL_load_math(S);
+	YASL_load_io(S);
+
+	int status = YASL_compile_to_file(S, output);
+	if (status == YASL_ERROR) {
+		puts("ERROR: cannot write bytecode file.");
 	}
 
-	struct YASL_State *S = YASL_newstate(argv[1]);
+	YASL_delstate(S);
+
+	return status;
+}
+
+static int main_file(char *filename, int options) {
+	struct YASL_State *S;
+	if (bytecode_file_check(filename)) {
+		S = YASL_newstate_bytecode(filename);
+		if (!S) {
+			puts("ERROR: invalid or incompatible bytecode file.");
+			exit(EXIT_FAILURE);
+		}
+	} else {
+		S = YASL_newstate(filename);
+	}
 
 	if (!S) {
 		puts("ERROR: cannot open file.");
 		exit(EXIT_FAILURE);
 	}
 
+	set_options(S, options);
+
 	// Load Standard Libraries
 	YASL_load_math(S);
 	YASL_load_io(S);
@@ -57,11 +102,12 @@ static int main_file(int argc, char **argv) {
 	return status;
 }
 
-static int main_REPL(int argc, char **argv) {
+static int main_REPL(int options) {
 	int next;
 	size_t size = 8, count = 0;
 	char *buffer = malloc(size);
 	struct YASL_State *S = YASL_newstate_bb(buffer, 0);
+	set_options(S, options);
 	YASL_load_math(S);
 	YASL_load_io(S);
 	puts(VERSION_PRINTOUT);
@@ -100,11 +146,44 @@ int main(int argc, char **argv) {
 	// Initialize prng seed
 	srand(time(NULL));
 
-	if (argc > 2) {
+	int options = YASL_OPT_DEFAULT;
+	char *compile_input = NULL;
+	char *compile_output = NULL;
+	int i;
+	for (i = 1; i < argc && argv[i][0] == '-'; i++) {
+		if (!strcmp(argv[i], "-h")) {
+			return main_help(argc, argv);
+		} else if (!strcmp(argv[i], "-V")) {
+			return main_version(argc, argv);
+		} else if (!strcmp(argv[i], "-r")) {
+			options |= YASL_OPT_REGISTERS;
+		} else if (!strcmp(argv[i], "-O0")) {
+			options &= ~(YASL_OPT_PEEPHOLE | YASL_OPT_SUPERINSTRUCTIONS | YASL_OPT_CONSTANTS |
+			             YASL_OPT_INLINE);
+		} else if (!strcmp(argv[i], "-J0")) {
+			options &= ~YASL_OPT_JIT;
+		} else if (!strcmp(argv[i], "-c") && i + 1 < argc) {
+			compile_input = argv[++i];
+		} else if (!strcmp(argv[i], "-o") && i + 1 < argc) {
+			compile_output = argv[++i];
+		} else {
+			return main_bad_option(argv[i]);
+		}
+	}
+
+	if (compile_input || compile_output) {
+		if (!compile_input || !compile_output || argc - i > 0) {
+			puts("ERROR: -c and -o must be used together, as in `yasl -c script.yasl -o script.yb`.");
+			return EXIT_FAILURE;
+		}
+		return main_compile(compile_input, compile_output, options);
+	}
+
+	if (argc - i > 1) {
 		return main_error(argc, argv);
-	} else if (argc == 2) {
-		return main_file(argc, argv);
+	} else if (argc - i == 1) {
+		return main_file(argv[i], options);
 	} else {
-		return main_REPL(argc, argv);
+		return main_REPL(options);
 	}
 }
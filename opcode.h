@@ -1,5 +1,16 @@
 #pragma once
 
+// size of the header at the start of each function: [num params (1 byte)][num locals besides params (2 bytes)].
+#define FN_HEADER_SIZE 3
+
+// size of the inline cache following the operand of INIT_MC and INIT_MC_SPECIAL: receiver type + 1, then method.
+#define MC_CACHE_SIZE 9
+
+/*
+ * The compiler emits every branch in its 8 byte form (BR_8, BRF_8, BRT_8 and BRN_8), and then rewrites each one to the
+ * shortest form its jump length fits in. Jump lengths are relative to the end of the branch instruction.
+ */
+
 enum Opcode {
 	HALT            = 0x00, // halt
 	NCONST          = 0x01, // push literal undef onto stack
@@ -7,6 +18,9 @@ enum Opcode {
 	BCONST_T        = 0x09, // push literal true onto stack
 	FCONST          = 0x0A, // push function literal onto stack
 
+	ICONST_B1       = 0x0D, // push next byte onto stack as signed integer constant
+	ICONST_B2       = 0x0E, // push next 2 bytes onto stack as signed integer constant
+	ICONST_B4       = 0x0F, // push next 4 bytes onto stack as signed integer constant
 	ICONST          = 0x10, // push next 8 bytes onto stack as integer constant
 	ICONST_M1       = 0x11, // push -1 onto stack
 	ICONST_0        = 0x12, // push 0 onto stack
@@ -22,6 +36,31 @@ enum Opcode {
 	DCONST_N        = 0x1E, // push nan onto stack
 	DCONST_I        = 0x1F, // push inf onto stack
 
+	// register instructions, operating directly on frame slots (globals at top level, locals inside a function)
+	R_MOV           = 0x20, // copy slot (dst, src)
+	R_MOVI          = 0x21, // store small int in slot (dst, next byte as signed int)
+	R_ADD           = 0x22, // add two slots (dst, a, b)
+	R_SUB           = 0x23, // subtract two slots (dst, a, b)
+	R_MUL           = 0x24, // multiply two slots (dst, a, b)
+	R_ADDI          = 0x25, // add small int to slot (dst, a, next byte as signed int)
+	R_SUBI          = 0x26, // subtract small int from slot (dst, a, next byte as signed int)
+	R_BRGE          = 0x28, // branch if a >= b (a, b, next 8 bytes as jump length)
+	R_BRGT          = 0x29, // branch if a > b (a, b, next 8 bytes as jump length)
+	R_BRGEI         = 0x2A, // branch if a >= small int (a, next byte as signed int, next 8 bytes as jump length)
+	R_BRGTI         = 0x2B, // branch if a > small int (a, next byte as signed int, next 8 bytes as jump length)
+
+	// superinstructions, each doing the work of a common sequence of stack instructions
+	INCR_GLOBAL     = 0x30, // add small int to global (addr (1 byte), next byte as signed int)
+	INCR_LOCAL      = 0x31, // add small int to local (addr (1 byte), next byte as signed int)
+	DECR_GLOBAL     = 0x32, // subtract small int from global (addr (1 byte), next byte as signed int)
+	DECR_LOCAL      = 0x33, // subtract small int from local (addr (1 byte), next byte as signed int)
+	ADD_GLOBALS     = 0x34, // push sum of two globals (addr (1 byte), addr (1 byte))
+	ADD_LOCALS      = 0x35, // push sum of two locals (addr (1 byte), addr (1 byte))
+	LT_BRF          = 0x38, // pop b and a, branch unless a < b (next 8 bytes as jump length)
+	LE_BRF          = 0x39, // pop b and a, branch unless a <= b (next 8 bytes as jump length)
+	GT_BRF          = 0x3A, // pop b and a, branch unless a > b (next 8 bytes as jump length)
+	GE_BRF          = 0x3B, // pop b and a, branch unless a >= b (next 8 bytes as jump length)
+
 	BOR             = 0x40, // bitwise or
 	BXOR            = 0x41, // bitwise xor
 	BAND            = 0x42, // bitwise and
@@ -30,6 +69,17 @@ enum Opcode {
 	BSL             = 0x45, // bitwise left shift
 	BSR             = 0x46, // bitwise right shift
 
+	// quickened forms, which the VM rewrites the generic instructions to once it has seen the types of their operands.
+	// The compiler never emits these.
+	ADD_II          = 0x50, // add two ints
+	SUB_II          = 0x51, // subtract two ints
+	MUL_II          = 0x52, // multiply two ints
+	ADD_FF          = 0x54, // add two floats
+	SUB_FF          = 0x55, // subtract two floats
+	MUL_FF          = 0x56, // multiply two floats
+	GET_TABLE_STR   = 0x58, // get field of table by string key
+	GET_LIST_INT    = 0x59, // get item of list by int index
+
 	ADD             = 0x60, // add two integers
 	SUB             = 0x61, // subtract two integers
 	MUL             = 0x62, // multiply two integers
@@ -52,10 +102,14 @@ enum Opcode {
 	GET             = 0x88, // gets field.
 	SLICE           = 0x8A, // slice of list or str
 
+	NEWSTR_1        = 0x98, // push string constant onto stack (index into string pool (1 byte))
+	NEWSTR_2        = 0x99, // push string constant onto stack (index into string pool (2 bytes))
 	NEWSPECIALSTR   = 0x9A, // new special string.
-	NEWSTR          = 0x9B, // make new String and push it onto stack (length (8 bytes), string (length bytes))
-	NEWTABLE        = 0x9C, // make new HashTable and push it onto stack
-	NEWLIST         = 0x9D, // make new List and push it onto stack
+	NEWSTR          = 0x9B, // push string constant onto stack (index into string pool (8 bytes))
+	NEWTABLE        = 0x9C, // make new HashTable from the key-value pairs above END and push it onto stack
+	NEWLIST         = 0x9D, // make new List from the values above END and push it onto stack
+	NEWLIST_N       = 0x9E, // make new List from the top n values of the stack and push it (next 8 bytes as n)
+	NEWTABLE_N      = 0x9F, // make new HashTable from the top n key-value pairs of the stack and push it (next 8 bytes as n)
 
 	END             = 0xB0, // indicate end of list on stack.
 	DUP             = 0xB8, // duplicate top value of stack
@@ -66,6 +120,18 @@ enum Opcode {
 	BRF_8           = 0xC1, // branch if condition is falsey (takes next 8 bytes as jump length)
 	BRT_8           = 0xC2, // branch if condition is truthy (takes next 8 bytes as jump length)
 	BRN_8           = 0xC3, // branch if condition is not undef (takes next 8 bytes as jump length)
+	BR_1            = 0xC4, // branch unconditionally (takes next byte as jump length)
+	BRF_1           = 0xC5, // branch if condition is falsey (takes next byte as jump length)
+	BRT_1           = 0xC6, // branch if condition is truthy (takes next byte as jump length)
+	BRN_1           = 0xC7, // branch if condition is not undef (takes next byte as jump length)
+	BR_2            = 0xC8, // branch unconditionally (takes next 2 bytes as jump length)
+	BRF_2           = 0xC9, // branch if condition is falsey (takes next 2 bytes as jump length)
+	BRT_2           = 0xCA, // branch if condition is truthy (takes next 2 bytes as jump length)
+	BRN_2           = 0xCB, // branch if condition is not undef (takes next 2 bytes as jump length)
+	BR_4            = 0xCC, // branch unconditionally (takes next 4 bytes as jump length)
+	BRF_4           = 0xCD, // branch if condition is falsey (takes next 4 bytes as jump length)
+	BRT_4           = 0xCE, // branch if condition is truthy (takes next 4 bytes as jump length)
+	BRN_4           = 0xCF, // branch if condition is not undef (takes next 4 bytes as jump length)
 
 	INITFOR         = 0xD0, // initialises for-loop in VM
 	ENDCOMP         = 0xD1, // end list / table comprehension
@@ -73,16 +139,20 @@ enum Opcode {
 	ITER_1          = 0xD3, // iterate to next, 1 var
 	ITER_2          = 0xD5, // iterate to next, 2 var
 
-	INIT_MC_SPECIAL = 0xE6,
-	INIT_MC         = 0xE7,
+	INIT_MC_SPECIAL = 0xE6, // set up method call (special string index, inline cache)
+	INIT_MC         = 0xE7, // set up method call (string address (8 bytes), inline cache)
 	INIT_CALL       = 0xE8, // set up function call
 	CALL            = 0xE9, // function call
 	RET             = 0xEA, // return from function
 
-	GSTORE_1        = 0xF4, // store top of stack at addr provided
-	LSTORE_1        = 0xF5, // store top of stack as local at addr
-	GLOAD_1         = 0xF6, // load global from addr
-	LLOAD_1         = 0xF7, // load local from addr
+	GSTORE_1        = 0xF4, // store top of stack at addr provided (1 byte)
+	LSTORE_1        = 0xF5, // store top of stack as local at addr (1 byte)
+	GLOAD_1         = 0xF6, // load global from addr (1 byte)
+	LLOAD_1         = 0xF7, // load local from addr (1 byte)
+	GSTORE_2        = 0xF8, // store top of stack at addr provided (2 bytes)
+	LSTORE_2        = 0xF9, // store top of stack as local at addr (2 bytes)
+	GLOAD_2         = 0xFA, // load global from addr (2 bytes)
+	LLOAD_2         = 0xFB, // load local from addr (2 bytes)
 	PRINT           = 0xFF  // print
 };
 
@@ -123,6 +193,7 @@ enum SpecialStrings {
 	S_SLICE,      // slice
 	S_SORT,       // sort
 	S_SPLIT,      // split
+	S_STABLESORT, // stablesort
 	S_STARTSWITH, // startswith
 
 	S_TOBOOL,     // tobool
@@ -0,0 +1,72 @@
+#include "slab.h"
+
+#if YASL_SLAB_ALLOC
+
+#define SLAB_CHUNK_SIZE 16384
+
+struct SlabBlock {
+	struct SlabBlock *next;
+};
+
+struct Slab {
+	// each chunk starts with a pointer to the previous one, so that they can all be freed together.
+	void *chunks;
+	struct SlabBlock *free_lists[SLAB_NUM_CLASSES];
+	size_t users;                  // VMs and compilers on this thread
+};
+
+static YASL_THREAD_LOCAL struct Slab slab;
+
+static void slab_refill(const size_t size_class) {
+	const size_t block_size = (size_class + 1) * SLAB_ALIGN;
+	char *chunk = malloc(SLAB_CHUNK_SIZE);
+	*(void **) chunk = slab.chunks;
+	slab.chunks = chunk;
+
+	struct SlabBlock *head = slab.free_lists[size_class];
+	for (size_t offset = SLAB_ALIGN; offset + block_size <= SLAB_CHUNK_SIZE; offset += block_size) {
+		struct SlabBlock *block = (struct SlabBlock *) (chunk + offset);
+		block->next = head;
+		head = block;
+	}
+	slab.free_lists[size_class] = head;
+}
+
+void *slab_alloc(const size_t size) {
+	if (size > SLAB_MAX_SIZE) return malloc(size);
+	const size_t size_class = (size - 1) / SLAB_ALIGN;
+	if (!slab.free_lists[size_class]) slab_refill(size_class);
+	struct SlabBlock *block = slab.free_lists[size_class];
+	slab.free_lists[size_class] = block->next;
+	return block;
+}
+
+void slab_free(void *const ptr, const size_t size) {
+	if (!ptr) return;
+	if (size > SLAB_MAX_SIZE) {
+		free(ptr);
+		return;
+	}
+	const size_t size_class = (size - 1) / SLAB_ALIGN;
+	struct SlabBlock *block = ptr;
+	block->next = slab.free_lists[size_class];
+	slab.free_lists[size_class] = block;
+}
+
+void slab_retain(void) {
+	slab.users++;
+}
+
+void slab_release(void) {
+	if (--slab.users) return;
+	while (slab.chunks) {
+		void *prev = *(void **) slab.chunks;
+		free(slab.chunks);
+		slab.chunks = prev;
+	}
+	for (size_t i = 0; i < SLAB_NUM_CLASSES; i++) {
+		slab.free_lists[i] = NULL;
+	}
+}
+
+#endif
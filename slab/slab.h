@@ -0,0 +1,38 @@
+#pragma once
+
+#include "yasl_conf.h"
+#include <stdlib.h>
+
+/*
+ * Allocator for the fixed-size headers of VM objects (String_t, RC_UserData, List, Table and CFunction_s). Sizes are
+ * rounded up to a multiple of SLAB_ALIGN, and each of these size classes keeps a free list of blocks carved out of
+ * larger chunks, so that allocating or freeing a header is a couple of pointer moves instead of a call to malloc.
+ * Larger sizes go straight to malloc. Blocks must be freed with the same size they were allocated with.
+ *
+ * Each thread has its own free lists and chunks, so that states on different threads don't race on them. A state's
+ * objects must be allocated and freed on one thread, and must not be passed to states on other threads. Every live VM
+ * and compiler holds its thread's allocator, through slab_retain and slab_release, and the chunks are given back to
+ * the system once none does anymore, so objects must not outlive the last state on their thread.
+ *
+ * With YASL_SLAB_ALLOC set to 0, both calls go straight to malloc and free, so that sanitizers see every object.
+ */
+
+#define SLAB_ALIGN 16
+#define SLAB_NUM_CLASSES 4
+#define SLAB_MAX_SIZE (SLAB_ALIGN * SLAB_NUM_CLASSES)
+
+#if YASL_SLAB_ALLOC
+
+void *slab_alloc(const size_t size);
+void slab_free(void *const ptr, const size_t size);
+void slab_retain(void);
+void slab_release(void);
+
+#else
+
+#define slab_alloc(size) malloc(size)
+#define slab_free(ptr, size) free(ptr)
+#define slab_retain() ((void) 0)
+#define slab_release() ((void) 0)
+
+#endif
@@ -12,7 +12,7 @@
 					struct YASL_Object *obj_name = YASL_popobject(state); \
                     if (!YASL_ISNUM(*obj_name)) { \
                         printf("%s(...) expected first argument of numerical type, got %s.\n", \
-                                fn_name, YASL_TYPE_NAMES[obj_name->type] ); \
+                                fn_name, YASL_TYPE_NAMES[YASL_GETTYPE(*obj_name)] ); \
 						return -1; \
                     }
 
@@ -29,11 +29,11 @@ int YASL_math_abs(struct YASL_State *S) {
 	POP_NUMBER(S, num, "math.abs");
 
 	if (YASL_ISINT(*num)) {
-		yasl_int i = num->value.ival;
+		yasl_int i = YASL_GETINT(*num);
 		if (i < 0) i = -i;
 		return YASL_pushinteger(S, i);
 	} else {
-		double n = num->value.dval;
+		double n = YASL_GETFLOAT(*num);
 		if (n < 0) n = -n;
 		return YASL_pushfloat(S, n);
 	}
@@ -44,9 +44,9 @@ int YASL_math_exp(struct YASL_State *S) {
 
 	double n;
 	if (YASL_ISINT(*num)) {
-		n = num->value.ival;
+		n = YASL_GETINT(*num);
 	} else {
-		n = num->value.dval;
+		n = YASL_GETFLOAT(*num);
 	}
 	return YASL_pushfloat(S, exp(n));
 }
@@ -56,9 +56,9 @@ int YASL_math_log(struct YASL_State *S) {
 
 	double n;
 	if (YASL_ISINT(*num)) {
-		n = num->value.ival;
+		n = YASL_GETINT(*num);
 	} else {
-		n = num->value.dval;
+		n = YASL_GETFLOAT(*num);
 	}
 	return YASL_pushfloat(S, log(n));
 }
@@ -68,9 +68,9 @@ int YASL_math_sqrt(struct YASL_State *S) {
 
 	double n;
 	if (YASL_ISINT(*num)) {
-		n = num->value.ival;
+		n = YASL_GETINT(*num);
 	} else {
-		n = num->value.dval;
+		n = YASL_GETFLOAT(*num);
 	}
 	return YASL_pushfloat(S, sqrt(n));
 }
@@ -80,9 +80,9 @@ int YASL_math_cos(struct YASL_State *S) {
 
 	double n;
 	if (YASL_ISINT(*num)) {
-		n = num->value.ival;
+		n = YASL_GETINT(*num);
 	} else {
-		n = num->value.dval;
+		n = YASL_GETFLOAT(*num);
 	}
 	return YASL_pushfloat(S, cos(n));
 }
@@ -91,9 +91,9 @@ int YASL_math_sin(struct YASL_State *S) {
 
 	double n;
 	if (YASL_ISINT(*num)) {
-		n = num->value.ival;
+		n = YASL_GETINT(*num);
 	} else {
-		n = num->value.dval;
+		n = YASL_GETFLOAT(*num);
 	}
 	return YASL_pushfloat(S, sin(n));
 }
@@ -102,9 +102,9 @@ int YASL_math_tan(struct YASL_State *S) {
 
 	double n;
 	if (YASL_ISINT(*num)) {
-		n = num->value.ival;
+		n = YASL_GETINT(*num);
 	} else {
-		n = num->value.dval;
+		n = YASL_GETFLOAT(*num);
 	}
 	return YASL_pushfloat(S, tan(n));
 }
@@ -113,9 +113,9 @@ int YASL_math_acos(struct YASL_State *S) {
 
 	double n;
 	if (YASL_ISINT(*num)) {
-		n = num->value.ival;
+		n = YASL_GETINT(*num);
 	} else {
-		n = num->value.dval;
+		n = YASL_GETFLOAT(*num);
 	}
 	return YASL_pushfloat(S, acos(n));
 }
@@ -124,9 +124,9 @@ int YASL_math_asin(struct YASL_State *S) {
 
 	double n;
 	if (YASL_ISINT(*num)) {
-		n = num->value.ival;
+		n = YASL_GETINT(*num);
 	} else {
-		n = num->value.dval;
+		n = YASL_GETFLOAT(*num);
 	}
 	return YASL_pushfloat(S, asin(n));
 }
@@ -135,9 +135,9 @@ int YASL_math_atan(struct YASL_State *S) {
 
 	double n;
 	if (YASL_ISINT(*num)) {
-		n = num->value.ival;
+		n = YASL_GETINT(*num);
 	} else {
-		n = num->value.dval;
+		n = YASL_GETFLOAT(*num);
 	}
 	return YASL_pushfloat(S, atan(n));
 }
@@ -147,9 +147,9 @@ int YASL_math_ceil(struct YASL_State *S) {
 
 	double n;
 	if (YASL_ISINT(*num)) {
-		n = num->value.ival;
+		n = YASL_GETINT(*num);
 	} else {
-		n = num->value.dval;
+		n = YASL_GETFLOAT(*num);
 	}
 	return YASL_pushfloat(S, ceil(n));
 }
@@ -158,9 +158,9 @@ int YASL_math_floor(struct YASL_State *S) {
 
 	double n;
 	if (YASL_ISINT(*num)) {
-		n = num->value.ival;
+		n = YASL_GETINT(*num);
 	} else {
-		n = num->value.dval;
+		n = YASL_GETFLOAT(*num);
 	}
 	return YASL_pushfloat(S, floor(n));
 }
@@ -170,9 +170,9 @@ int YASL_math_deg(struct YASL_State *S) {
 
 	double n;
 	if (YASL_ISINT(*num)) {
-		n = num->value.ival;
+		n = YASL_GETINT(*num);
 	} else {
-		n = num->value.dval;
+		n = YASL_GETFLOAT(*num);
 	}
 
 	n *= (double)180.0/YASL_PI;
@@ -183,9 +183,9 @@ int YASL_math_rad(struct YASL_State *S) {
 
 	double n;
 	if (YASL_ISINT(*num)) {
-		n = num->value.ival;
+		n = YASL_GETINT(*num);
 	} else {
-		n = num->value.dval;
+		n = YASL_GETFLOAT(*num);
 	}
 
 	n *= YASL_PI/(double)180.0;
@@ -197,9 +197,9 @@ int YASL_math_isprime(struct YASL_State *S) {
 
 	yasl_int n;
 	if (YASL_ISFLOAT(*num)) {
-		n = num->value.dval;
+		n = YASL_GETFLOAT(*num);
 	} else {
-		n = num->value.ival;
+		n = YASL_GETINT(*num);
 	}
 
 	int p = is_prime(n);
@@ -227,14 +227,14 @@ int YASL_math_gcd(struct YASL_State *S) {
 
 	yasl_int a = 0, b = 0;
 	if (YASL_ISFLOAT(*numA)) {
-		a = numA->value.dval;
+		a = YASL_GETFLOAT(*numA);
 	} else {
-		a = numA->value.ival;
+		a = YASL_GETINT(*numA);
 	}
 	if (YASL_ISFLOAT(*numB)) {
-		b = numB->value.dval;
+		b = YASL_GETFLOAT(*numB);
 	} else {
-		b = numB->value.ival;
+		b = YASL_GETINT(*numB);
 	}
 	if (!(a > 0 && b > 0)) {
 		return YASL_pushundef(S);
@@ -248,14 +248,14 @@ int YASL_math_lcm(struct YASL_State *S) {
 
 	yasl_int a = 0, b = 0;
 	if (YASL_ISFLOAT(*numA)) {
-		a = numA->value.dval;
+		a = YASL_GETFLOAT(*numA);
 	} else {
-		a = numA->value.ival;
+		a = YASL_GETINT(*numA);
 	}
 	if (YASL_ISFLOAT(*numB)) {
-		b = numB->value.dval;
+		b = YASL_GETFLOAT(*numB);
 	} else {
-		b = numB->value.ival;
+		b = YASL_GETINT(*numB);
 	}
 	if (!(a > 0 && b > 0)) {
 		return YASL_pushundef(S);
@@ -288,20 +288,17 @@ int YASL_load_math(struct YASL_State *S) {
 
 	struct YASL_Object *pi_str = YASL_CString("pi");
 	struct YASL_Object *pi_val = malloc(sizeof(struct YASL_Object));
-	pi_val->type = Y_FLOAT;
-	pi_val->value.dval = YASL_PI;
+	*pi_val = YASL_FLOAT(YASL_PI);
 	YASL_Table_set(math, pi_str, pi_val);
 
 	struct YASL_Object *nan_str = YASL_CString("nan");
 	struct YASL_Object *nan_val = malloc(sizeof(struct YASL_Object));
-	nan_val->type = Y_FLOAT;
-	nan_val->value.dval = YASL_NAN;
+	*nan_val = YASL_FLOAT(YASL_NAN);
 	YASL_Table_set(math, nan_str, nan_val);
 
 	struct YASL_Object *inf_str = YASL_CString("inf");
 	struct YASL_Object *inf_val = malloc(sizeof(struct YASL_Object));
-	inf_val->type = Y_FLOAT;
-	inf_val->value.dval = YASL_INF;
+	*inf_val = YASL_FLOAT(YASL_INF);
 	YASL_Table_set(math, inf_str, inf_val);
 
 	struct YASL_Object *sqrt_str = YASL_CString("sqrt");
@@ -32,7 +32,78 @@ assert_output("YASL -h",
               "options:\n" .
               "\t-h: this menu\n" .
               "\t-V: print current version\n" .
-              "\tfile: name of file containing script\n",
+              "\t-r: compile simple arithmetic to register instructions\n" .
+              "\t-O0: disable optimizations (peephole optimizer, superinstructions, constant propagation and inlining)\n" .
+              "\t-J0: disable the JIT, and interpret all code\n" .
+              "\t-c file -o output: compile file to bytecode, and write it to output instead of running it\n" .
+              "\tfile: name of file containing script, or of a bytecode file written with -c\n",
               0);
 
+assert_output("YASL -c inputs/fib.yasl -o fib.yb", "", 0);
+assert_output("YASL fib.yb", scalar(qx+../YASL inputs/fib.yasl+), 0);
+unlink "fib.yb";
+
+# FNV-1a, as used for the checksum of bytecode files, computed in 32-bit halves.
+sub fnv1a {
+    my ($bytes) = @_;
+    my ($hi, $lo) = (0xcbf29ce4, 0x84222325);
+    foreach my $byte (unpack("C*", $bytes)) {
+        $lo ^= $byte;
+        my $low = $lo * 0x1b3;
+        $hi = ($hi * 0x1b3 + int($low / 4294967296) + (($lo << 8) & 0xFFFFFFFF)) % 4294967296;
+        $lo = $low % 4294967296;
+    }
+    return ($hi << 32) | $lo;
+}
+
+# writes a copy of the bytecode file in to out, with the values packed as format written at offset into the bytecode,
+# and the checksum fixed up, so that only the checks on the contents of the bytecode can catch it.
+sub corrupt_bytecode {
+    my ($in, $out, $offset, $format, @values) = @_;
+    open(my $fh, '<:raw', $in) or die "Could not open file $in";
+    local $/;
+    my $file = <$fh>;
+    close $fh;
+    my $code = substr($file, 32);
+    my $bytes = pack($format, @values);
+    substr($code, $offset, length($bytes)) = $bytes;
+    substr($file, 8, 8) = substr($code, 8, 8) if $offset == 8;
+    $file = substr($file, 0, 24) . pack("Q", fnv1a($code)) . $code;
+    open($fh, '>:raw', $out) or die "Could not open file $out";
+    print $fh $file;
+    close $fh;
+}
+
+assert_output("YASL -c inputs/search.yasl -o search.yb", "", 0);
+open(my $fh, '<:raw', "search.yb") or die "Could not open file search.yb";
+read($fh, my $header, 56);
+close $fh;
+my $pool = unpack("q", substr($header, 48, 8));
+foreach my $corruption ([16, "q", 1 << 40],          # string pool past the end of the code
+                        [$pool, "q", 1 << 40],       # more constants than fit in the pool
+                        [$pool + 8, "q", 1 << 40],   # string longer than what is left of the pool
+                        [$pool + 8, "q", -1],        # string of negative length
+                        [0, "q", $pool],             # entry point in the string pool
+                        [8, "q", 1 << 40]) {         # too many globals
+    corrupt_bytecode("search.yb", "corrupt.yb", @$corruption);
+    assert_output("YASL corrupt.yb", "ERROR: invalid or incompatible bytecode file.\n", 256);
+}
+unlink "search.yb", "corrupt.yb";
+
+# hi.yb is just NEWSTR_1 0, PRINT and HALT, starting at 24 bytes into the bytecode.
+open($fh, '>', "hi.yasl") or die "Could not open file hi.yasl";
+print $fh "echo 'hi';\n";
+close $fh;
+assert_output("YASL -c hi.yasl -o hi.yb", "", 0);
+assert_output("YASL hi.yb", "hi\n", 0);
+foreach my $corruption ([25, "C", 0x40],             # string constant past the end of the pool
+                        [24, "CC", 0xF6, 0x40],      # global past the number of globals
+                        [24, "CC", 0xC4, 0x02],      # jump into the string pool
+                        [24, "CC", 0xC4, 0xFF],      # jump into the middle of an instruction
+                        [24, "C", 0xEA]) {           # return from the main code
+    corrupt_bytecode("hi.yb", "corrupt.yb", @$corruption);
+    assert_output("YASL corrupt.yb", "ERROR: invalid or incompatible bytecode file.\n", 256);
+}
+unlink "hi.yasl", "hi.yb", "corrupt.yb";
+
 exit $__CLI_TESTS_FAILED__;
@@ -35,6 +35,10 @@ while (defined(my $file = glob 'inputs/*.yasl')) {
     $line =~ s/^##//;
     $line =~ s/\n$//;
     assert_output($file, eval '"' . $line . '"', 0);
+    # register-based bytecode must behave exactly like the stack-based one.
+    assert_output("-r $file", eval '"' . $line . '"', 0);
+    # so must bytecode compiled without optimizations.
+    assert_output("-O0 $file", eval '"' . $line . '"', 0);
 }
 
 
@@ -0,0 +1,129 @@
+use strict;
+use warnings;
+
+# Differential tests for the JIT: every script must print the same and exit with the same status whether its functions
+# are compiled to machine code or interpreted (-J0).
+
+my $__JIT_TESTS_FAILED__ = 0;
+my $RED = "\x1B[31m";
+my $END = "\x1B[0m";
+
+sub assert_same {
+    my ($file) = @_;
+    my (undef, $filename, $line) = caller;
+
+    my $exitcode = 0;
+    foreach my $options ('', '-r', '-O0') {
+        my $jit_output = qx/..\/YASL $options "$file"/;
+        my $jit_status = $? >> 8;
+        my $vm_output = qx/..\/YASL $options -J0 "$file"/;
+        my $vm_status = $? >> 8;
+
+        if ($jit_output ne $vm_output) {
+            print $RED . "output assert failed for $file (line $line, options '$options'): $vm_output =/= $jit_output" . $END . "\n";
+        }
+        if ($jit_status != $vm_status) {
+            print $RED . "exitcode assert failed for $file (line $line, options '$options'): $vm_status =/= $jit_status" . $END . "\n";
+        }
+
+        $exitcode ||= !($jit_output eq $vm_output && $jit_status == $vm_status) || 0;
+    }
+
+    $__JIT_TESTS_FAILED__ ||= $exitcode;
+    return $exitcode;
+}
+
+sub assert_same_source {
+    my ($string) = @_;
+
+    my $debug_dump = '../dump.ysl';
+    open(my $fh, '>', $debug_dump) or die "Could not open file $debug_dump";
+    print $fh "$string";
+    close $fh;
+
+    return assert_same($debug_dump);
+}
+
+while (defined(my $file = glob 'inputs/*.yasl')) {
+    assert_same($file);
+}
+
+# Arithmetic and comparisons on ints, floats and mixed operands, including overflow and NaN.
+assert_same_source(q{fn f(a, b) {
+                         echo a + b; echo a - b; echo a * b; echo a / b; echo a > b; echo a >= b; echo a < b;
+                         echo a <= b; echo a == b; echo a != b; echo a === b; echo a ** 2; echo -a; echo a + 1;
+                     }
+                     f(3, 4); f(3.5, 4); f(3, 4.5); f(1.5, 1.5); f(0.0 / 0.0, 0.0 / 0.0);
+                     f(9223372036854775807, 1); f(-9223372036854775807 - 1, -1);
+});
+assert_same_source(q{fn f(a, b) { return a // b; }
+                     echo f(7, 2); echo f(7, 0);
+});
+assert_same_source(q{fn f(a, b) { return a % b; }
+                     echo f(7, -2); echo f(7, 0);
+});
+
+# Type errors inside functions, at any depth.
+assert_same_source(q{fn f(a) { return a + true; }
+                     fn g(a) { echo 'before'; return f(a) * 2; }
+                     echo g(1);
+});
+assert_same_source(q{fn f(a) { return a < 'a'; }
+                     echo f(1);
+});
+
+# Branches, loops and truthiness of every type.
+assert_same_source(q{fn f(x) {
+                         if x { echo 'yes'; } else { echo 'no'; };
+                         echo x ?? 'default'; echo x || 'or'; echo x && 'and'; echo !x;
+                     }
+                     f(0); f(1); f(0.0); f(''); f('a'); f([]); f({}); f(undef); f(true); f(false);
+});
+assert_same_source(q{fn sum(n) {
+                         total := 0;
+                         for i := 0; i < n; i += 1 { total += i; };
+                         j := n;
+                         while j > 0 { j -= 1; if j % 3 == 0 { continue; }; if j < 10 { break; }; total -= j; };
+                         return total;
+                     }
+                     echo sum(100); echo sum(0); echo sum(1000); echo sum(10.5);
+});
+assert_same_source(q{fn f(ls) {
+                         s := '';
+                         for x <- ls { s = s ~ x->tostr() ~ ','; };
+                         return s ~ [ y * 2 for y <- ls if y > 1 ]->tostr();
+                     }
+                     echo f([1, 2, 3]); echo f([]);
+});
+
+# Recursion, including deeper than the JIT nests calls, and calls between compiled and C functions.
+assert_same_source(q{fn fib(n) { if n < 2 { return n; }; return fib(n - 1) + fib(n - 2); }
+                     fn depth(n) { if n == 0 { return 0; }; return 1 + depth(n - 1); }
+                     echo fib(20); echo depth(5000);
+});
+assert_same_source(q{fn square(x) { return x * x; }
+                     fn f(ls) { ls->push(len ls); return ls->map(square); }
+                     echo f([1, 2, 3]); echo 'abc'->toupper(); echo math.sqrt(2.0);
+});
+
+# Globals, tables, lists and strings.
+assert_same_source(q{g := 0;
+                     fn f(t, k) { g += 1; t[k] = g; t.x = k; return t[k] + len t; }
+                     t := {};
+                     echo f(t, 'a'); echo f(t, 'b'); echo g; echo t.x; echo f([1, 2], 0);
+});
+assert_same_source(q{fn f(s, i) { return s[i] ~ s[1:3] ~ "#{i}"; }
+                     echo f('hello', 0); echo f('hello', 10);
+});
+
+# Operators overloaded with YASL functions, which run nested in the middle of a compiled instruction.
+assert_same_source(q{fn add(a, b) { return a.v + b.v; }
+                     fn mul(a, b) { return a.v * b.v * 1.5; }
+                     fn neg(a) { return -a.v; }
+                     fn f(a, b) { echo a + b; echo a * b; echo -a; echo a - b; }
+                     x := { .__add: add, .__mul: mul, .__neg: neg, .v: 1 };
+                     y := { .__add: add, .__mul: mul, .__neg: neg, .v: 2 };
+                     f(x, y);
+});
+
+exit $__JIT_TESTS_FAILED__;
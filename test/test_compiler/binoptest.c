@@ -5,230 +5,259 @@ SETUP_YATS();
 
 static void test_mul() {
 	unsigned char expected[] = {
-		0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x21, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		ICONST_2,
 		GSTORE_1, 0x00,
 		GLOAD_1, 0x00,
 		ICONST_3,
 		MUL,
 		POP,
-		HALT
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
 	};
 	ASSERT_GEN_BC_EQ(expected, "x := 2; x * 3;");
 }
 
 static void test_fdiv() {
 	unsigned char expected[] = {
-		0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x1D, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		ICONST_3,
 		ICONST_2,
 		FDIV,
 		POP,
-		HALT
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
 	};
 	ASSERT_GEN_BC_EQ(expected, "3 / 2;");
 }
 
 static void test_idiv() {
 	unsigned char expected[] = {
-		0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x21, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		ICONST_3,
 		GSTORE_1, 0x00,
 		GLOAD_1, 0x00,
 		ICONST_2,
 		IDIV,
 		POP,
-		HALT
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
 	};
 	ASSERT_GEN_BC_EQ(expected, "x := 3; x // 2;");
 }
 
 static void test_mod() {
 	unsigned char expected[] = {
-		0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x21, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		ICONST_5,
 		GSTORE_1, 0x00,
 		GLOAD_1, 0x00,
 		ICONST_3,
 		MOD,
 		POP,
-		HALT
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
 	};
 	ASSERT_GEN_BC_EQ(expected, "x := 5; x % 3;");
 }
 
 static void test_add() {
 	unsigned char expected[] = {
-		0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x21, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		ICONST_5,
 		GSTORE_1, 0x00,
 		GLOAD_1, 0x00,
 		ICONST_5,
 		ADD,
 		POP,
-		HALT
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
 	};
 	ASSERT_GEN_BC_EQ(expected, "x := 5; x + 5;");
 }
 
 static void test_sub() {
 	unsigned char expected[] = {
-		0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x21, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		ICONST_5,
 		GSTORE_1, 0x00,
 		GLOAD_1, 0x00,
 		ICONST_3,
 		SUB,
 		POP,
-		HALT
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
 	};
 	ASSERT_GEN_BC_EQ(expected, "x := 5; x - 3;");
 }
 
 static void test_bshl() {
 	unsigned char expected[] = {
-		0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x21, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		ICONST_2,
 		GSTORE_1, 0x00,
 		GLOAD_1, 0x00,
 		ICONST_3,
 		BSL,
 		POP,
-		HALT
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
 	};
 	ASSERT_GEN_BC_EQ(expected, "x := 2; x << 3;");
 }
 
 static void test_bshr() {
 	unsigned char expected[] = {
-		0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-		ICONST,
-		0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x22, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		ICONST_B1, 0x08,
 		GSTORE_1, 0x00,
 		GLOAD_1, 0x00,
 		ICONST_2,
 		BSR,
 		POP,
-		HALT
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
 	};
 	ASSERT_GEN_BC_EQ(expected, "x := 8; x >> 2;");
 }
 
 static void test_band() {
 	unsigned char expected[] = {
-		0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-		ICONST,
-		0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x22, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		ICONST_B1, 0x08,
 		GSTORE_1, 0x00,
 		GLOAD_1, 0x00,
 		ICONST_2,
 		BAND,
 		POP,
-		HALT
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
 	};
 	ASSERT_GEN_BC_EQ(expected, "x := 8; x & 2;");
 }
 
 static void test_bandnot() {
 	unsigned char expected[] = {
-		0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-		ICONST,
-		0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x22, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		ICONST_B1, 0x08,
 		GSTORE_1, 0x00,
 		GLOAD_1, 0x00,
 		ICONST_2,
 		BANDNOT,
 		POP,
-		HALT
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
 	};
 	ASSERT_GEN_BC_EQ(expected, "x := 8; x &^ 2;");
 }
 
 static void test_bxor() {
 	unsigned char expected[] = {
-		0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-		ICONST,
-		0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x22, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		ICONST_B1, 0x08,
 		GSTORE_1, 0x00,
 		GLOAD_1, 0x00,
 		ICONST_2,
 		BXOR,
 		POP,
-		HALT
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
 	};
 	ASSERT_GEN_BC_EQ(expected, "x := 8; x ^ 2;");
 }
 
 static void test_bor() {
 	unsigned char expected[] = {
-		0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-		ICONST,
-		0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x22, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		ICONST_B1, 0x08,
 		GSTORE_1, 0x00,
 		GLOAD_1, 0x00,
 		ICONST_2,
 		BOR,
 		POP,
-		HALT
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
 	};
 	ASSERT_GEN_BC_EQ(expected, "x := 8; x | 2;");
 }
 
 static void test_concat() {
 	unsigned char expected[] = {
-		0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x1D, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		ICONST_2,
 		ICONST_1,
 		CNCT,
 		POP,
-		HALT
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
 	};
 	ASSERT_GEN_BC_EQ(expected, "2 ~ 1;");
 }
 
 static void test_and() {
 	unsigned char expected[] = {
-		0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x24, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		BCONST_T,
+		GSTORE_1, 0x00,
+		GLOAD_1, 0x00,
 		DUP,
-		BRF_8,
-		0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		BRF_1, 0x02,
 		POP,
 		BCONST_F,
 		POP,
-		HALT
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
 	};
-	ASSERT_GEN_BC_EQ(expected, "true && false;");
+	// a literal on the left would be folded away.
+	ASSERT_GEN_BC_EQ(expected, "x := true; x && false;");
 }
 
 static void test_or() {
 	unsigned char expected[] = {
-		0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x24, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		BCONST_T,
+		GSTORE_1, 0x00,
+		GLOAD_1, 0x00,
 		DUP,
-		BRT_8,
-		0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		BRT_1, 0x02,
 		POP,
 		BCONST_F,
 		POP,
-		HALT
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
 	};
-	ASSERT_GEN_BC_EQ(expected, "true || false;");
+	// a literal on the left would be folded away.
+	ASSERT_GEN_BC_EQ(expected, "x := true; x || false;");
 }
 
 int binoptest(void) {
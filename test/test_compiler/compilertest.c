@@ -10,6 +10,11 @@
 #include "foreachtest.h"
 #include "comprehensiontest.h"
 #include "foldingtest.h"
+#include "registertest.h"
+#include "peepholetest.h"
+#include "superinstructiontest.h"
+#include "methodcalltest.h"
+#include "inliningtest.h"
 
 #define RUN(test) __YASL_TESTS_FAILED__ |= test()
 
@@ -29,6 +34,11 @@ int compilertest() {
     RUN(foreachtest);
     RUN(comprehensiontest);
     RUN(foldingtest);
+    RUN(registertest);
+    RUN(peepholetest);
+    RUN(superinstructiontest);
+    RUN(methodcalltest);
+    RUN(inliningtest);
 
     return __YASL_TESTS_FAILED__;
 }
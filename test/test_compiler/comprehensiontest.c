@@ -5,46 +5,46 @@ SETUP_YATS();
 
 static void test_tablecomp_noif() {
 	unsigned char expected[] = {
-		0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-		END,
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x36, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		ICONST_1,
 		ICONST_2,
 		ICONST_3,
-		NEWLIST,
+		NEWLIST_N,
+		0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		INITFOR,
 		END,
 		ITER_1,
-		BRF_8,
-		0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		BRF_1, 0x09,
 		GSTORE_1, 0x00,
 		GLOAD_1, 0x00,
 		GLOAD_1, 0x00,
 		NEG,
-		BR_8,
-		0xE6, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		BR_1, 0xF4,
 		NEWTABLE,
 		ENDCOMP,
 		PRINT,
-		HALT
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
 	};
 	ASSERT_GEN_BC_EQ(expected, "echo {i:-i for i <- [1,2,3]};");
 }
 
 static void test_tablecomp() {
 	unsigned char expected[] = {
-		0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-		END,
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x3F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		ICONST_1,
 		ICONST_2,
 		ICONST_3,
-		NEWLIST,
+		NEWLIST_N,
+		0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		INITFOR,
 		END,
 		ITER_1,
-		BRF_8,
-		0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		BRF_1, 0x12,
 		GSTORE_1, 0x00,
 		GLOAD_1, 0x00,
 		ICONST_2,
@@ -52,62 +52,61 @@ static void test_tablecomp() {
 		ICONST_0,
 		EQ,
 		NOT,
-		BRF_8,
-		0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		BRF_1, 0x05,
 		GLOAD_1, 0x00,
 		GLOAD_1, 0x00,
 		NEG,
-		BR_8,
-		0xD6, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		BR_1, 0xEB,
 		NEWTABLE,
 		ENDCOMP,
 		PRINT,
-		HALT
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
 	};
 	ASSERT_GEN_BC_EQ(expected, "echo {i:-i for i <- [1,2,3] if i % 2 != 0};");
 }
 
 static void test_listcomp_noif() {
 	unsigned char expected[] = {
-		0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-		END,
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x34, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		ICONST_1,
 		ICONST_2,
 		ICONST_3,
-		NEWLIST,
+		NEWLIST_N,
+		0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		INITFOR,
 		END,
 		ITER_1,
-		BRF_8,
-		0x0E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		BRF_1, 0x07,
 		GSTORE_1, 0x00,
 		GLOAD_1, 0x00,
 		NEG,
-		BR_8,
-		0xE8, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		BR_1, 0xF6,
 		NEWLIST,
 		ENDCOMP,
 		PRINT,
-		HALT
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
 	};
 	ASSERT_GEN_BC_EQ(expected, "echo [-i for i <- [1,2,3]];");
 }
 
 static void test_listcomp() {
 	unsigned char expected[] = {
-		0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-		END,
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x3D, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		ICONST_1,
 		ICONST_2,
 		ICONST_3,
-		NEWLIST,
+		NEWLIST_N,
+		0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		INITFOR,
 		END,
 		ITER_1,
-		BRF_8,
-		0x1E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		BRF_1, 0x10,
 		GSTORE_1, 0x00,
 		GLOAD_1, 0x00,
 		ICONST_2,
@@ -115,16 +114,15 @@ static void test_listcomp() {
 		ICONST_0,
 		EQ,
 		NOT,
-		BRF_8,
-		0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		BRF_1, 0x03,
 		GLOAD_1, 0x00,
 		NEG,
-		BR_8,
-		0xD8, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		BR_1, 0xED,
 		NEWLIST,
 		ENDCOMP,
 		PRINT,
-		HALT
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
 	};
 	ASSERT_GEN_BC_EQ(expected, "echo [-i for i <- [1,2,3] if i % 2 != 0];");
 }
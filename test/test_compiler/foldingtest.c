@@ -1,169 +1,262 @@
 #include "unoptest.h"
 #include "yats.h"
+#include "yasl_options.h"
 
 SETUP_YATS();
 
 static void test_neg() {
 	unsigned char expected[] = {
-		0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-		ICONST,
-		0xF0, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		0x1C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		ICONST_B1, 0xF0,
 		PRINT,
-		HALT
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
 	};
 	ASSERT_GEN_BC_EQ(expected, "echo -16;");
 }
 
 static void test_not() {
 	unsigned char expected[] = {
-		0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x1B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		BCONST_F,
 		PRINT,
-		HALT
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
 	};
 	ASSERT_GEN_BC_EQ(expected, "echo !true;");
 }
 
 static void test_bnot() {
 	unsigned char expected[] = {
-		0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x1B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		ICONST_M1,
 		PRINT,
-		HALT
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
 	};
 	ASSERT_GEN_BC_EQ(expected, "echo ^0x00;");
 }
 
 static void test_mul() {
 	unsigned char expected[] = {
-		0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-		ICONST,
-		0x06, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x1C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		ICONST_B1, 0x06,
 		PRINT,
-		HALT
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
 	};
 	ASSERT_GEN_BC_EQ(expected, "echo 2 * 3;");
 }
 
 static void test_idiv() {
 	unsigned char expected[] = {
-		0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x1B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		ICONST_1,
 		PRINT,
-		HALT
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
 	};
 	ASSERT_GEN_BC_EQ(expected, "echo 3 // 2;");
 }
 
 static void test_mod() {
 	unsigned char expected[] = {
-		0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x1B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		ICONST_2,
 		PRINT,
-		HALT
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
 	};
 	ASSERT_GEN_BC_EQ(expected, "echo 5 % 3;");
 }
 
 static void test_add() {
 	unsigned char expected[] = {
-		0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-		ICONST,
-		0x0B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x1C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		ICONST_B1, 0x0B,
 		PRINT,
-		HALT
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
 	};
 	ASSERT_GEN_BC_EQ(expected, "echo 6 + 5;");
 }
 
 static void test_sub() {
 	unsigned char expected[] = {
-		0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x1B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		ICONST_5,
 		PRINT,
-		HALT
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
 	};
 	ASSERT_GEN_BC_EQ(expected, "echo 8 - 3;");
 }
 
 static void test_bshl() {
 	unsigned char expected[] = {
-		0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-		ICONST,
-		0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x1C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		ICONST_B1, 0x10,
 		PRINT,
-		HALT
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
 	};
 	ASSERT_GEN_BC_EQ(expected, "echo 2 << 3;");
 }
 
 static void test_bshr() {
 	unsigned char expected[] = {
-		0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x1B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		ICONST_2,
 		PRINT,
-		HALT
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
 	};
 	ASSERT_GEN_BC_EQ(expected,"echo 8 >> 2;");
 }
 
 static void test_band() {
 	unsigned char expected[] = {
-		0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-		ICONST,
-		0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x1C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		ICONST_B1, 0x08,
 		PRINT,
-		HALT
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
 	};
 	ASSERT_GEN_BC_EQ(expected,"echo 8 & 10;");
 }
 
 static void test_bandnot() {
 	unsigned char expected[] = {
-		0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x1B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		ICONST_2,
 		PRINT,
-		HALT
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
 	};
 	ASSERT_GEN_BC_EQ(expected,"echo 2 &^ 12;");
 }
 
 static void test_bxor() {
 	unsigned char expected[] = {
-		0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-		ICONST,
-		0x0A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x1C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		ICONST_B1, 0x0A,
 		PRINT,
-		HALT
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
 	};
 	ASSERT_GEN_BC_EQ(expected,"echo 8 ^ 2;");
 }
 
 static void test_bor() {
 	unsigned char expected[] = {
-		0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-		ICONST,
-		0x0A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x1C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		ICONST_B1, 0x0A,
 		PRINT,
-		HALT
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
 	};
 	ASSERT_GEN_BC_EQ(expected, "echo 8 | 2;");
 }
 
+static void test_concat_str() {
+	unsigned char expected[] = {
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x1C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		NEWSTR_1, 0x00,
+		PRINT,
+		HALT,
+		0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		'a', 'b', 'c', 'd'
+	};
+	ASSERT_GEN_BC_EQ(expected, "echo 'ab' ~ 'cd';");
+}
+
+static void test_len_str() {
+	unsigned char expected[] = {
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x1B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		ICONST_3,
+		PRINT,
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+	};
+	ASSERT_GEN_BC_EQ(expected, "echo len 'abc';");
+}
+
+static void test_ternary() {
+	unsigned char expected[] = {
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x1B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		ICONST_2,
+		PRINT,
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+	};
+	ASSERT_GEN_BC_EQ(expected, "echo '' ? 1 : 2;");
+}
+
+static void test_const_propagation() {
+	unsigned char expected[] = {
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x1F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		ICONST_4,
+		GSTORE_1, 0x00,
+		ICONST_B1, 0x08,
+		PRINT,
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+	};
+	ASSERT_GEN_BC_OPT_EQ(expected, "const x := 4; echo x * 2;", YASL_OPT_CONSTANTS);
+}
+
+static void test_dead_branch() {
+	unsigned char expected[] = {
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x1E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		BCONST_F,
+		GSTORE_1, 0x00,
+		ICONST_2,
+		PRINT,
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+	};
+	ASSERT_GEN_BC_OPT_EQ(expected, "const debug := false; if debug { echo 1; } else { echo 2; };", YASL_OPT_CONSTANTS);
+}
+
 int foldingtest(void) {
 	test_neg();
 	test_not();
@@ -181,5 +274,12 @@ int foldingtest(void) {
 	test_bxor();
 	test_bor();
 
+	test_concat_str();
+	test_len_str();
+	test_ternary();
+
+	test_const_propagation();
+	test_dead_branch();
+
 	return __YASL_TESTS_FAILED__;
 }
@@ -6,16 +6,16 @@ SETUP_YATS();
 /*
 static void test_while() {
     unsigned char expected[] = {
-            0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
             0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
             BCONST_T,
-            BRF_8,
-            0x0B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            BRF_1, 0x04,
             BCONST_T,
             POP,
-            BR_8,
-            0xEB, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-            HALT
+            BR_1, 0xF9,
+            HALT,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
     };
     ASSERT_GEN_BC_EQ(expected,"while true { true; };");
 }
@@ -23,69 +23,65 @@ static void test_while() {
 
 static void test_continue() {
 	unsigned char expected[] = {
-		0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-		END,
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x3C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		ICONST_0,
 		ICONST_1,
 		ICONST_2,
 		ICONST_3,
 		ICONST_4,
 		ICONST_5,
-		NEWLIST,
+		NEWLIST_N,
+		0x06, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		INITFOR,
 		ITER_1,
-		BRF_8,
-		0x24, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		BRF_1, 0x0F,
 		GSTORE_1, 0x00,
 		GLOAD_1, 0x00,
 		ICONST_5,
 		EQ,
-		BRF_8,
-		0x09, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-		BR_8,
-		0xDE, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		BRF_1, 0x02,
+		BR_1, 0xF3,
 		GLOAD_1, 0x00,
 		PRINT,
-		BR_8,
-		0xD2, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		BR_1, 0xEE,
 		ENDFOR,
-		HALT
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
 	};
 	ASSERT_GEN_BC_EQ(expected, "for i <- [0, 1, 2, 3, 4, 5] { if i == 5 { continue; }; echo i; };");
 }
 
 static void test_break() {
 	unsigned char expected[] = {
-		0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-		END,
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x3D, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		ICONST_0,
 		ICONST_1,
 		ICONST_2,
 		ICONST_3,
 		ICONST_4,
 		ICONST_5,
-		NEWLIST,
+		NEWLIST_N,
+		0x06, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		INITFOR,
 		ITER_1,
-		BRF_8,
-		0x25, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		BRF_1, 0x10,
 		GSTORE_1, 0x00,
 		GLOAD_1, 0x00,
 		ICONST_5,
 		EQ,
-		BRF_8,
-		0x0A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		BRF_1, 0x03,
 		BCONST_F,
-		BR_8,
-		0xDE, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		BR_1, 0xF3,
 		GLOAD_1, 0x00,
 		PRINT,
-		BR_8,
-		0xD1, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		BR_1, 0xED,
 		ENDFOR,
-		HALT
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
 	};
 	ASSERT_GEN_BC_EQ(expected, "for i <- [0, 1, 2, 3, 4, 5] { if i == 5 { break; }; echo i; };");
 }
@@ -6,16 +6,16 @@ SETUP_YATS();
 /*
 static void test_while() {
     unsigned char expected[] = {
-            0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
             0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
             BCONST_T,
-            BRF_8,
-            0x0B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            BRF_1, 0x04,
             BCONST_T,
             POP,
-            BR_8,
-            0xEB, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-            HALT
+            BR_1, 0xF9,
+            HALT,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
     };
     ASSERT_GEN_BC_EQ(expected,"while true { true; };");
 }
@@ -23,71 +23,63 @@ static void test_while() {
 
 static void test_continue() {
 	unsigned char expected[] = {
-		0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x39, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		ICONST_0,
 		GSTORE_1, 0x00,
-		BR_8,
-		0x06, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		BR_1, 0x06,
 		GLOAD_1, 0x00,
 		ICONST_1,
 		ADD,
 		GSTORE_1, 0x00,
 		GLOAD_1, 0x00,
-		ICONST,
-		0x0A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		ICONST_B1, 0x0A,
 		GE,
 		NOT,
-		BRF_8,
-		0x22, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		BRF_1, 0x0D,
 		GLOAD_1, 0x00,
 		ICONST_5,
 		EQ,
-		BRF_8,
-		0x09, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-		BR_8,
-		0xCE, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		BRF_1, 0x02,
+		BR_1, 0xEA,
 		GLOAD_1, 0x00,
 		PRINT,
-		BR_8,
-		0xC2, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-		HALT
+		BR_1, 0xE5,
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
 	};
 	ASSERT_GEN_BC_EQ(expected, "for i := 0; i < 10; i += 1 { if i == 5 { continue; }; echo i; };");
 }
 
 static void test_break() {
 	unsigned char expected[] = {
-		0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x3A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		ICONST_0,
 		GSTORE_1, 0x00,
-		BR_8,
-		0x06, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		BR_1, 0x06,
 		GLOAD_1, 0x00,
 		ICONST_1,
 		ADD,
 		GSTORE_1, 0x00,
 		GLOAD_1, 0x00,
-		ICONST,
-		0x0A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		ICONST_B1, 0x0A,
 		GE,
 		NOT,
-		BRF_8,
-		0x23, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		BRF_1, 0x0E,
 		GLOAD_1, 0x00,
 		ICONST_5,
 		EQ,
-		BRF_8,
-		0x0A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		BRF_1, 0x03,
 		BCONST_F,
-		BR_8,
-		0xE0, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		BR_1, 0xF5,
 		GLOAD_1, 0x00,
 		PRINT,
-		BR_8,
-		0xC1, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-		HALT
+		BR_1, 0xE4,
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
 	};
 	ASSERT_GEN_BC_EQ(expected, "for i := 0; i < 10; i += 1 { if i == 5 { break; }; echo i; };");
 }
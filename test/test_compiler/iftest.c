@@ -6,57 +6,56 @@ SETUP_YATS();
 
 static void test_if() {
 	unsigned char expected[] = {
-		0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x1E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		BCONST_T,
-		BRF_8,
-		0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		BRF_1, 0x02,
 		BCONST_T,
 		PRINT,
-		HALT
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
 	};
 	ASSERT_GEN_BC_EQ(expected, "if true { echo true; };");
 }
 
 static void test_ifelse() {
 	unsigned char expected[] = {
-		0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x22, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		BCONST_T,
-		BRF_8,
-		0x0B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		BRF_1, 0x04,
 		BCONST_T,
 		PRINT,
-		BR_8,
-		0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		BR_1, 0x02,
 		BCONST_F,
 		PRINT,
-		HALT
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
 	};
 	ASSERT_GEN_BC_EQ(expected, "if true { echo true; } else { echo false; };");
 }
 
 static void test_ifelseelseif() {
 	unsigned char expected[] = {
-		0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x29, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		BCONST_T,
-		BRF_8,
-		0x0B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		BRF_1, 0x04,
 		BCONST_T,
 		PRINT,
-		BR_8,
-		0x17, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		BR_1, 0x09,
 		BCONST_F,
-		BRF_8,
-		0x0B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		BRF_1, 0x04,
 		BCONST_F,
 		PRINT,
-		BR_8,
-		0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		BR_1, 0x02,
 		NCONST,
 		PRINT,
-		HALT
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
 	};
 	ASSERT_GEN_BC_EQ(expected, "if true { echo true; } elseif false { echo false; } else { echo undef; };");
 }
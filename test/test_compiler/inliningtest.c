@@ -0,0 +1,88 @@
+#include "inliningtest.h"
+#include "yats.h"
+#include "yasl_options.h"
+
+SETUP_YATS();
+
+static void test_inline_call() {
+	unsigned char expected[] = {
+		0x23, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x3F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x02, 0x00, 0x00,
+		LLOAD_1, 0x00,
+		LLOAD_1, 0x01,
+		ADD,
+		RET,
+		NCONST,
+		RET,
+		FCONST, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		GSTORE_1, 0x00,
+		ICONST_1,
+		GSTORE_1, 0x01,
+		GLOAD_1, 0x01,
+		ICONST_2,
+		GSTORE_1, 0x03,
+		GSTORE_1, 0x02,
+		GLOAD_1, 0x02,
+		GLOAD_1, 0x03,
+		ADD,
+		PRINT,
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+	};
+	ASSERT_GEN_BC_OPT_EQ(expected, "const fn add(a, b) { return a + b; }; x := 1; echo add(x, 2);", YASL_OPT_INLINE);
+}
+
+static void test_inline_literal_args() {
+	unsigned char expected[] = {
+		0x23, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x32, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x01, 0x00, 0x00,
+		LLOAD_1, 0x00,
+		LLOAD_1, 0x00,
+		MUL,
+		RET,
+		NCONST,
+		RET,
+		FCONST, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		GSTORE_1, 0x00,
+		ICONST_B1, 0x09,
+		PRINT,
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+	};
+	ASSERT_GEN_BC_OPT_EQ(expected, "const fn sq(x) { return x * x; }; echo sq(3);", YASL_OPT_INLINE | YASL_OPT_CONSTANTS);
+}
+
+static void test_no_inline_variable() {
+	unsigned char expected[] = {
+		0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x32, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x01, 0x00, 0x00,
+		LLOAD_1, 0x00,
+		RET,
+		NCONST,
+		RET,
+		FCONST, 0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		GSTORE_1, 0x00,
+		GLOAD_1, 0x00,
+		INIT_CALL,
+		ICONST_1,
+		CALL,
+		PRINT,
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+	};
+	ASSERT_GEN_BC_OPT_EQ(expected, "fn f(a) { return a; }; echo f(1);", YASL_OPT_INLINE);
+}
+
+int inliningtest(void) {
+	test_inline_call();
+	test_inline_literal_args();
+	test_no_inline_variable();
+
+	return __YASL_TESTS_FAILED__;
+}
@@ -5,52 +5,61 @@ SETUP_YATS();
 
 static void test_elimination() {
 	unsigned char expected[] = {
-		0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x1C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		ICONST_1,
 		GSTORE_1, 0x00,
-		HALT
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
 	};
 	ASSERT_GEN_BC_EQ(expected, "x := 1; x; undef; true; 'YASL'; 10; 10.0;");
 }
 
 static void test_undef() {
     unsigned char expected[] = {
-            0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
             0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x1B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
             NCONST,
             PRINT,
-            HALT
+            HALT,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
     };
     ASSERT_GEN_BC_EQ(expected, "echo undef;");
 }
 
 static void test_true() {
     unsigned char expected[] = {
-            0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
             0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x1B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
             BCONST_T,
             PRINT,
-            HALT
+            HALT,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
     };
     ASSERT_GEN_BC_EQ(expected, "echo true;");
 }
 
 static void test_false() {
     unsigned char expected[] = {
-            0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
             0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x1B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
             BCONST_F,
             PRINT,
-            HALT
+            HALT,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
     };
     ASSERT_GEN_BC_EQ(expected, "echo false;");
 }
 
 static void test_small_ints() {
     unsigned char expected[]  = {
-            0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
             0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x27, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
             ICONST_M1,
             PRINT,
             ICONST_0,
@@ -65,121 +74,153 @@ static void test_small_ints() {
             PRINT,
             ICONST_5,
             PRINT,
-            HALT
+            HALT,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
     };
     ASSERT_GEN_BC_EQ(expected, "echo -1; echo 0; echo 1; echo 2; echo 3; echo 4; echo 5;");
 }
 
 static void test_bin() {
     unsigned char expected[] = {
-            0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
             0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x1B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
             ICONST_3,
             PRINT,
-            HALT
+            HALT,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
     };
     ASSERT_GEN_BC_EQ(expected, "echo 0b11;");
 }
 
 static void test_dec() {
     unsigned char expected[]  = {
-            0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
             0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-            ICONST,
-            0x0A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x1C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            ICONST_B1, 0x0A,
             PRINT,
-            HALT
+            HALT,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
     };
     ASSERT_GEN_BC_EQ(expected, "echo 10;");
 }
 
 static void test_hex() {
     unsigned char expected[] = {
-            0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
             0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-            ICONST,
-            0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x1C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            ICONST_B1, 0x10,
             PRINT,
-            HALT
+            HALT,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
     };
     ASSERT_GEN_BC_EQ(expected, "echo 0x10;");
 }
 
+static void test_wide_ints() {
+    unsigned char expected[] = {
+            0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x30, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            ICONST_B1, 0x80,
+            PRINT,
+            ICONST_B2, 0xE8, 0x03,
+            PRINT,
+            ICONST_B4, 0xA0, 0x86, 0x01, 0x00,
+            PRINT,
+            ICONST,
+            0x00, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00,
+            PRINT,
+            HALT,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+    };
+    ASSERT_GEN_BC_EQ(expected, "echo -128; echo 1000; echo 100000; echo 0x100000000;");
+}
+
 static void test_small_floats() {
 	unsigned char expected[]  = {
-		0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x1F, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		DCONST_0,
 		PRINT,
 		DCONST_1,
 		PRINT,
 		DCONST_2,
 		PRINT,
-		HALT
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
 	};
 	ASSERT_GEN_BC_EQ(expected, "echo 0.0; echo 1.0; echo 2.0;");
 }
 static void test_float() {
     unsigned char expected[] = {
-            0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
             0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x23, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
             DCONST,
             0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF8, 0x3F,
             PRINT,
-            HALT
+            HALT,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
     };
     ASSERT_GEN_BC_EQ(expected, "echo 1.5;");
 }
 
 static void test_string() {
     unsigned char expected[] = {
-            0x1C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
             0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-            0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-            'Y', 'A', 'S', 'L',
-            NEWSTR,
-            0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x1C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            NEWSTR_1, 0x00,
             PRINT,
-            HALT
+            HALT,
+            0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            'Y', 'A', 'S', 'L'
     };
     ASSERT_GEN_BC_EQ(expected, "echo 'YASL';");
 }
 
 static void test_list() {
     unsigned char expected[] = {
-            0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
             0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-            END,
+            0x28, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
             ICONST_0,
             ICONST_1,
             ICONST_2,
             ICONST_3,
             ICONST_4,
-            NEWLIST,
+            NEWLIST_N,
+            0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
             POP,
-            HALT
+            HALT,
+            0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
     };
     ASSERT_GEN_BC_EQ(expected, "[0, 1, 2, 3, 4];");
 }
 
 static void test_table() {
     unsigned char expected[] = {
-            0x27, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
             0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-            0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-            'z',  'e',  'r',  'o',
-            0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-            'o',  'n',  'e',
-            END,
+            0x29, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
             ICONST_0,
-            NEWSTR,
-            0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            NEWSTR_1, 0x00,
             ICONST_1,
-            NEWSTR,
-            0x1C, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-            NEWTABLE,
+            NEWSTR_1, 0x01,
+            NEWTABLE_N,
+            0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
             POP,
-            HALT
+            HALT,
+            0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            'z',  'e',  'r',  'o',
+            0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+            'o',  'n',  'e'
     };
     ASSERT_GEN_BC_EQ(expected, "{0:'zero', 1:'one'};");
 }
@@ -192,6 +233,7 @@ int literaltest(void) {
 	test_bin();
 	test_dec();
 	test_hex();
+	test_wide_ints();
 	test_small_floats();
 	test_float();
 	test_string();
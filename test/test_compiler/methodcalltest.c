@@ -0,0 +1,52 @@
+#include "methodcalltest.h"
+#include "yats.h"
+
+SETUP_YATS();
+
+static void test_special_method() {
+	unsigned char expected[] = {
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x28, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		NEWSTR_1, 0x00,
+		INIT_MC_SPECIAL, S_TOSTR,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		CALL,
+		PRINT,
+		HALT,
+		0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		'a'
+	};
+	ASSERT_GEN_BC_EQ(expected, "echo 'a'->tostr();");
+}
+
+static void test_method() {
+	unsigned char expected[] = {
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x3B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		ICONST_1,
+		NEWLIST_N,
+		0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		GSTORE_1, 0x00,
+		GLOAD_1, 0x00,
+		INIT_MC,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		CALL,
+		POP,
+		HALT,
+		0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		'f', 'o', 'o'
+	};
+	ASSERT_GEN_BC_EQ(expected, "x := [1]; x->foo();");
+}
+
+int methodcalltest(void) {
+	test_special_method();
+	test_method();
+
+	return __YASL_TESTS_FAILED__;
+}
@@ -0,0 +1,96 @@
+#include "peepholetest.h"
+#include "yats.h"
+#include "yasl_options.h"
+
+SETUP_YATS();
+
+static void test_while_true_break() {
+	unsigned char expected[] = {
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x29, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		ICONST_0,
+		GSTORE_1, 0x00,
+		GLOAD_1, 0x00,
+		ICONST_1,
+		ADD,
+		GSTORE_1, 0x00,
+		GLOAD_1, 0x00,
+		ICONST_B1, 0x0A,
+		GE,
+		BRF_1, 0xF3,
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+	};
+	ASSERT_GEN_BC_OPT_EQ(expected, "x := 0; while true { x += 1; if x >= 10 { break; }; };", YASL_OPT_PEEPHOLE);
+}
+
+static void test_not_branch() {
+	unsigned char expected[] = {
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x25, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		ICONST_1,
+		GSTORE_1, 0x00,
+		GLOAD_1, 0x00,
+		ICONST_1,
+		EQ,
+		BRT_1, 0x03,
+		GLOAD_1, 0x00,
+		PRINT,
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+	};
+	ASSERT_GEN_BC_OPT_EQ(expected, "x := 1; if !(x == 1) { echo x; };", YASL_OPT_PEEPHOLE);
+}
+
+static void test_and_condition() {
+	unsigned char expected[] = {
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x2E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		ICONST_1,
+		GSTORE_1, 0x00,
+		ICONST_2,
+		GSTORE_1, 0x01,
+		GLOAD_1, 0x00,
+		ICONST_0,
+		GT,
+		BRF_1, 0x09,
+		GLOAD_1, 0x01,
+		ICONST_0,
+		GT,
+		BRF_1, 0x03,
+		GLOAD_1, 0x00,
+		PRINT,
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+	};
+	ASSERT_GEN_BC_OPT_EQ(expected, "x := 1; y := 2; if x > 0 && y > 0 { echo x; };", YASL_OPT_PEEPHOLE);
+}
+
+static void test_dead_code() {
+	unsigned char expected[] = {
+		0x1D, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x29, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x00, 0x00, 0x00,
+		ICONST_1,
+		RET,
+		FCONST,
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		GSTORE_1, 0x00,
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+	};
+	ASSERT_GEN_BC_OPT_EQ(expected, "fn f() { return 1; echo 2; };", YASL_OPT_PEEPHOLE);
+}
+
+int peepholetest(void) {
+	test_while_true_break();
+	test_not_branch();
+	test_and_condition();
+	test_dead_code();
+
+	return __YASL_TESTS_FAILED__;
+}
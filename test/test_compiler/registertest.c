@@ -0,0 +1,105 @@
+#include "registertest.h"
+#include "yats.h"
+#include "yasl_options.h"
+
+SETUP_YATS();
+
+static void test_assign() {
+	unsigned char expected[] = {
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x2E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		R_MOVI, 0x00, 0x01,
+		R_MOVI, 0x01, 0x02,
+		R_MOV, 0x02, 0x00,
+		R_ADD, 0x00, 0x00, 0x01,
+		R_MUL, 0x02, 0x02, 0x00,
+		R_SUBI, 0x02, 0x02, 0x07,
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+	};
+	ASSERT_GEN_BC_OPT_EQ(expected, "x := 1; y := 2; z := x; x = x + y; z = z * x - 7;", YASL_OPT_REGISTERS);
+}
+
+static void test_fallback() {
+	unsigned char expected[] = {
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x29, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		R_MOVI, 0x00, 0x01,
+		GLOAD_1, 0x00,
+		ICONST_B2, 0xE8, 0x03,
+		ADD,
+		GSTORE_1, 0x00,
+		GLOAD_1, 0x00,
+		ICONST_2,
+		ADD,
+		PRINT,
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+	};
+	ASSERT_GEN_BC_OPT_EQ(expected, "x := 1; x = x + 1000; echo x + 2;", YASL_OPT_REGISTERS);
+}
+
+static void test_while() {
+	unsigned char expected[] = {
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x2D, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		R_MOVI, 0x00, 0x00,
+		R_BRGEI, 0x00, 0x0A,
+		0x06, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		R_ADDI, 0x00, 0x00, 0x01,
+		BR_1, 0xEF,
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+	};
+	ASSERT_GEN_BC_OPT_EQ(expected, "i := 0; while i < 10 { i += 1; };", YASL_OPT_REGISTERS);
+}
+
+static void test_if() {
+	unsigned char expected[] = {
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x2D, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		R_MOVI, 0x00, 0x01,
+		R_MOVI, 0x01, 0x02,
+		R_BRGT, 0x00, 0x01,
+		0x03, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		GLOAD_1, 0x00,
+		PRINT,
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+	};
+	ASSERT_GEN_BC_OPT_EQ(expected, "x := 1; y := 2; if x <= y { echo x; };", YASL_OPT_REGISTERS);
+}
+
+static void test_locals() {
+	unsigned char expected[] = {
+		0x24, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x30, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x02, 0x00, 0x00,
+		R_ADD, 0x00, 0x00, 0x01,
+		LLOAD_1, 0x00,
+		RET,
+		NCONST,
+		RET,
+		FCONST,
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		GSTORE_1, 0x00,
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+	};
+	ASSERT_GEN_BC_OPT_EQ(expected, "fn add(a, b) { a = a + b; return a; };", YASL_OPT_REGISTERS);
+}
+
+int registertest(void) {
+	test_assign();
+	test_fallback();
+	test_while();
+	test_if();
+	test_locals();
+
+	return __YASL_TESTS_FAILED__;
+}
@@ -0,0 +1,64 @@
+#include "superinstructiontest.h"
+#include "yats.h"
+#include "yasl_options.h"
+
+SETUP_YATS();
+
+static void test_incr() {
+	unsigned char expected[] = {
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x22, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		ICONST_0,
+		GSTORE_1, 0x00,
+		INCR_GLOBAL, 0x00, 0x01,
+		DECR_GLOBAL, 0x00, 0x02,
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+	};
+	ASSERT_GEN_BC_OPT_EQ(expected, "x := 0; x += 1; x -= 2;", YASL_OPT_SUPERINSTRUCTIONS);
+}
+
+static void test_add_vars() {
+	unsigned char expected[] = {
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x02, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x23, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		ICONST_1,
+		GSTORE_1, 0x00,
+		ICONST_2,
+		GSTORE_1, 0x01,
+		ADD_GLOBALS, 0x00, 0x01,
+		PRINT,
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+	};
+	ASSERT_GEN_BC_OPT_EQ(expected, "x := 1; y := 2; echo x + y;", YASL_OPT_SUPERINSTRUCTIONS);
+}
+
+static void test_while() {
+	unsigned char expected[] = {
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x2E, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		ICONST_0,
+		GSTORE_1, 0x00,
+		GLOAD_1, 0x00,
+		ICONST_B1, 0x0A,
+		LT_BRF,
+		0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		INCR_GLOBAL, 0x00, 0x01,
+		BR_1, 0xEE,
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+	};
+	ASSERT_GEN_BC_OPT_EQ(expected, "i := 0; while i < 10 { i += 1; };", YASL_OPT_SUPERINSTRUCTIONS);
+}
+
+int superinstructiontest(void) {
+	test_incr();
+	test_add_vars();
+	test_while();
+
+	return __YASL_TESTS_FAILED__;
+}
@@ -5,73 +5,67 @@ SETUP_YATS();
 
 static void test_while() {
 	unsigned char expected[] = {
-		0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x20, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		BCONST_T,
-		BRF_8,
-		0x0B, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		BRF_1, 0x04,
 		BCONST_T,
 		PRINT,
-		BR_8,
-		0xEB, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-		HALT
+		BR_1, 0xF9,
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
 	};
 	ASSERT_GEN_BC_EQ(expected, "while true { echo true; };");
 }
 
 static void test_continue() {
 	unsigned char expected[] = {
-		0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x31, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		ICONST_0,
 		GSTORE_1, 0x00,
 		GLOAD_1, 0x00,
-		ICONST,
-		0x0A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		ICONST_B1, 0x0A,
 		GE, NOT,
-		BRF_8,
-		0x22, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		BRF_1, 0x0D,
 		GLOAD_1, 0x00,
 		ICONST_5,
 		EQ,
-		BRF_8,
-		0x09, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-		BR_8,
-		0xD4, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		BRF_1, 0x02,
+		BR_1, 0xF0,
 		GLOAD_1, 0x00,
 		PRINT,
-		BR_8,
-		0xC8, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-		HALT
+		BR_1, 0xEB,
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
 	};
 	ASSERT_GEN_BC_EQ(expected, "i := 0; while i < 10 { if i == 5 { continue; }; echo i; };");
 }
 
 static void test_break() {
 	unsigned char expected[] = {
-		0x10, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
-		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x18, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		0x32, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
 		ICONST_0,
 		GSTORE_1, 0x00,
 		GLOAD_1, 0x00,
-		ICONST,
-		0x0A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		ICONST_B1, 0x0A,
 		GE, NOT,
-		BRF_8,
-		0x23, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		BRF_1, 0x0E,
 		GLOAD_1, 0x00,
 		ICONST_5,
 		EQ,
-		BRF_8,
-		0x0A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+		BRF_1, 0x03,
 		BCONST_F,
-		BR_8,
-		0xE0, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+		BR_1, 0xF5,
 		GLOAD_1, 0x00,
 		PRINT,
-		BR_8,
-		0xC7, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
-		HALT
+		BR_1, 0xEA,
+		HALT,
+		0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
 	};
 	ASSERT_GEN_BC_EQ(expected, "i := 0; while i < 10 { if i == 5 { break; }; echo i; };");
 }
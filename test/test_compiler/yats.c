@@ -19,19 +19,20 @@ Lexer setup_lexer(char *file_contents) {
 }
 
 
-unsigned char *setup_compiler(char *file_contents) {
+unsigned char *setup_compiler(char *file_contents, int options) {
 	FILE *fptr = fopen("dump.ysl", "w");
 	fwrite(file_contents, 1, strlen(file_contents), fptr);
 	fseek(fptr, 0, SEEK_SET);
 	fclose(fptr);
 	fptr = fopen("dump.ysl", "r");
 	struct Compiler *compiler = compiler_new(fptr);
+	compiler->options = options;
 	unsigned char *bytecode = compile(compiler);
 	FILE *f = fopen("dump.yb", "wb");
 	if (bytecode == NULL) {
 		fputc(HALT, f);
 	} else {
-		fwrite(bytecode, 1, compiler->code->count + compiler->header->count + 1, f);
+		fwrite(bytecode, 1, bytecode_size(compiler), f);
 	}
 	fclose(f);
 	compiler_cleanup(compiler);
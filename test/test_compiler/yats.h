@@ -23,9 +23,11 @@
     }\
 } while(0)
 
-#define ASSERT_GEN_BC_EQ(expected, fc) do{\
+#define ASSERT_GEN_BC_EQ(expected, fc) ASSERT_GEN_BC_OPT_EQ(expected, fc, 0)
+
+#define ASSERT_GEN_BC_OPT_EQ(expected, fc, options) do{\
     remove("dump.yb");\
-    /*unsigned char *bytecode = */setup_compiler(fc);\
+    /*unsigned char *bytecode = */setup_compiler(fc, options);\
     FILE *file = fopen("dump.yb", "rb");\
     int64_t size = getsize(file);\
     unsigned char actual[size];\
@@ -35,5 +37,5 @@
 } while(0)
 
 Lexer setup_lexer(char *file_contents);
-unsigned char *setup_compiler(char *file_contents);
+unsigned char *setup_compiler(char *file_contents, int options);
 int64_t getsize(FILE *file);
@@ -16,15 +16,21 @@ sub assert_output {
     print $fh "$string";
     close $fh;
 
-    my $output = qx/"..$debug_yasl" "..$debug_dump"/;
-    my $status = $? >> 8;
-    my $exitcode = !($output eq $exp_out && $status == $exp_stat) || 0;
-
-    if ($output ne $exp_out) {
-        print $RED . "output assert failed in $filename (line $line): $exp_out =/= $output" . $END . "\n";
-    }
-    if ($status != $exp_stat) {
-        print $RED . "exitcode assert failed in $filename (line $line): $status =/= $exp_stat" . $END . "\n";
+    # register-based bytecode (-r), and bytecode compiled without optimizations (-O0), must behave exactly like the
+    # default.
+    my $exitcode = 0;
+    foreach my $options ('', '-r', '-O0') {
+        my $output = qx/"..$debug_yasl" $options "..$debug_dump"/;
+        my $status = $? >> 8;
+
+        if ($output ne $exp_out) {
+            print $RED . "output assert failed in $filename (line $line, options '$options'): $exp_out =/= $output" . $END . "\n";
+        }
+        if ($status != $exp_stat) {
+            print $RED . "exitcode assert failed in $filename (line $line, options '$options'): $status =/= $exp_stat" . $END . "\n";
+        }
+
+        $exitcode ||= !($output eq $exp_out && $status == $exp_stat) || 0;
     }
 
     $__VM_TESTS_FAILED__ ||= $exitcode;
@@ -66,17 +72,17 @@ assert_output(qq"for i <- [x*2 for x <- [1, 2, 3, 4, 5, 6] if x % 2 == 0] {
                  }\n",
               "4\n8\n12\n", 0);
 assert_output(qq"x := { x*2:-x for x <- [1, 2, 3, 4] if x % 2 == 0}
-                 for i <- x {
-                      echo i
-                      echo x[i]
-                 }\n",
-              "4\n-2\n8\n-4\n", 0);
+                 echo len x
+                 echo x[4]
+                 echo x[8]
+                 echo x[2]\n",
+              "2\n-2\n-4\nundef\n", 0);
 assert_output(qq"x := { x*2:-x for x <- [1, 2, 3]}
-                 for i <- x {
-                      echo i
-                      echo x[i]
-                 }\n",
-              "2\n-1\n4\n-2\n6\n-3\n", 0);
+                 echo len x
+                 echo x[2]
+                 echo x[4]
+                 echo x[6]\n",
+              "3\n-1\n-2\n-3\n", 0);
 
 # Binary Operators
 assert_output("echo 2 ** 4\n", "16\n", 0);
@@ -285,7 +291,7 @@ assert_output(qq"y := []
                  echo x
                  echo y
                  x->clear()
-                 y->clear()\n", "{x: {...}, y: [[...], {...}]}\n[[...], {x: {...}, y: [...]}]\n", 0);
+                 y->clear()\n", "{y: [[...], {...}], x: {...}}\n[[...], {y: [...], x: {...}}]\n", 0);
 
 # General
 assert_output(qq"x := []
@@ -313,6 +319,13 @@ assert_output(qq"const x := 10
               "10\n20\n",
               0);
 
+assert_output(qq"for x <- [[1, 2], 'a', 1, [3], true, 'b'] \{
+                     echo x->tostr()
+                 }
+                ",
+              "[1, 2]\na\n1\n[3]\ntrue\nb\n",
+              0);
+
 # Errors
 assert_output(qq"echo 1 // 0;", $RED . "DivisionByZeroError\n" . $END, 5);
 assert_output(qq"echo 1 % 0;", $RED . "DivisionByZeroError\n" . $END, 5);
@@ -10,8 +10,35 @@
 #include "compiler/compiler.h"
 #include "interpreter/VM.h"
 #include "compiler/lexinput.h"
+#include "interpreter/collector.h"
+#include "interpreter/jit.h"
+#include "slab/slab.h"
 //#include "interpreter/YASL_object/YASL_Object.h"
 
+static void table_insert_cstring(struct Table *table, char *key, struct YASL_Object value) {
+	table_insert(table, YASL_STR(str_new_sized(strlen(key), key)), value);
+}
+
+/*
+ * collect(): runs the cycle collector, and returns a table with the number of lists and tables it freed ('objects'),
+ * the number of bytes those took up ('bytes') and the length of the pause, in milliseconds ('ms').
+ */
+static int YASL_collect(struct YASL_State *S) {
+	struct GC_Stats stats = gc_collect(&S->vm.gc);
+	struct RC_UserData *result = rcht_new(&S->vm.gc);
+	table_insert_cstring(result->data, "objects", YASL_INT((yasl_int) stats.objects));
+	table_insert_cstring(result->data, "bytes", YASL_INT((yasl_int) stats.bytes));
+	table_insert_cstring(result->data, "ms", YASL_FLOAT(stats.ms));
+	vm_push((struct VM *) S, YASL_TABLE(result));
+	return YASL_SUCCESS;
+}
+
+static void declare_builtins(struct YASL_State *S) {
+	YASL_declglobal(S, "collect");
+	YASL_pushcfunction(S, YASL_collect, 0);
+	YASL_setglobal(S, "collect");
+}
+
 struct YASL_State *YASL_newstate(char *filename) {
     struct YASL_State *S = malloc(sizeof(struct YASL_State));
 
@@ -24,10 +51,12 @@ struct YASL_State *YASL_newstate(char *filename) {
 
     struct LEXINPUT *lp = lexinput_new_file(fp);
     S->compiler = NEW_COMPILER(lp);
-    S->compiler.header->count = 16;
+    slab_retain();                     // released by compiler_cleanup, as for compiler_new
+    S->compiler.header->count = HEADER_SIZE;
 
-    vm_init((struct VM *)S, NULL, -1, 256);
-    // S->vm = vm_new(NULL, -1, 256); // TODO: decide proper number of globals
+    vm_init((struct VM *)S, NULL, -1, 0);
+    S->file.mapping = NULL;
+    declare_builtins(S);
     return S;
 }
 
@@ -37,13 +66,24 @@ struct YASL_State *YASL_newstate_bb(char *buf, int len) {
 
     struct LEXINPUT *lp = lexinput_new_bb(buf, len);
     S->compiler = NEW_COMPILER(lp);
-    S->compiler.header->count = 16;
+    slab_retain();                     // released by compiler_cleanup, as for compiler_new
+    S->compiler.header->count = HEADER_SIZE;
 
-    vm_init((struct VM *)S, NULL, -1, 256);
-    // S->vm = vm_new(NULL, -1, 256); // TODO: decide proper number of globals
+    vm_init((struct VM *)S, NULL, -1, 0);
+    S->file.mapping = NULL;
+    declare_builtins(S);
     return S;
 }
 
+struct YASL_State *YASL_newstate_bytecode(char *filename) {
+	struct YASL_State *S = YASL_newstate_bb((char *) "", 0);
+	if (bytecode_file_load(&S->file, filename)) {
+		YASL_delstate(S);
+		return NULL;
+	}
+	return S;
+}
+
 void YASL_resetstate_bb(struct YASL_State *S, char *buf, size_t len) {
 	S->compiler.status = YASL_SUCCESS;
 	S->compiler.parser.status = YASL_SUCCESS;
@@ -51,7 +91,7 @@ void YASL_resetstate_bb(struct YASL_State *S, char *buf, size_t len) {
 	S->compiler.parser.lex = NEW_LEXER(lexinput_new_bb(buf, len));
 	S->compiler.code->count = 0;
 	S->compiler.buffer->count = 0;
-	// S->compiler.header->count = 16;
+	// S->compiler.header->count = HEADER_SIZE;
 	// table_del_string_int(S->compiler.strings);
 	// S->compiler.strings = table_new();
 	if (S->vm.code)	free(S->vm.code);
@@ -61,35 +101,68 @@ void YASL_resetstate_bb(struct YASL_State *S, char *buf, size_t len) {
 
 int YASL_delstate(struct YASL_State *S) {
 	compiler_cleanup(&S->compiler);
+	if (S->file.mapping) S->vm.code = NULL;
 	vm_cleanup((struct VM *) S);
+	bytecode_file_close(&S->file);
 	free(S);
 	return YASL_SUCCESS;
 }
 
+int YASL_setoption(struct YASL_State *S, enum YASL_Option option, int enabled) {
+	if (enabled) S->compiler.options |= option;
+	else S->compiler.options &= ~option;
+	if (option & YASL_OPT_JIT) {
+		if (enabled && !S->vm.jit) {
+			S->vm.jit = jit_new();
+		} else if (!enabled) {
+			jit_del(S->vm.jit);
+			S->vm.jit = NULL;
+		}
+	}
+	return YASL_SUCCESS;
+}
+
 int YASL_execute_REPL(struct YASL_State *S) {
 	unsigned char *bc = compile_REPL(&S->compiler);
 	if (!bc) return S->compiler.status;
 
 	int64_t entry_point = *((int64_t*)bc);
-	// TODO: use this in VM.
-	// int64_t num_globals = *((int64_t*)bc+1);
+	int64_t num_globals = *((int64_t*)bc+1);
 
+	// each line can declare new globals.
+	vm_grow_globals((struct VM *) S, (size_t) num_globals);
 	S->vm.pc = entry_point;
+	// machine code compiled from earlier code is stale.
+	if (S->vm.code != bc) jit_reset(S->vm.jit);
 	S->vm.code = bc;
+	vm_load_constants((struct VM *) S);
 
 	return vm_run((struct VM *)S);  // TODO: error handling for runtime errors.
 }
 
-int YASL_execute(struct YASL_State *S) {
+int YASL_compile_to_file(struct YASL_State *S, char *filename) {
 	unsigned char *bc = compile(&S->compiler);
 	if (!bc) return S->compiler.status;
 
+	int status = bytecode_file_write(filename, bc, bytecode_size(&S->compiler), compiler_num_globals(&S->compiler));
+	free(bc);
+	return status;
+}
+
+int YASL_execute(struct YASL_State *S) {
+	// code loaded from a bytecode file is run in place.
+	unsigned char *bc = S->file.mapping ? S->file.code : compile(&S->compiler);
+	if (!bc) return S->compiler.status;
+
 	int64_t entry_point = *((int64_t *) bc);
-	// TODO: use this in VM.
-	// int64_t num_globals = *((int64_t*)bc+1);
+	int64_t num_globals = *((int64_t *) bc + 1);
 
+	vm_grow_globals((struct VM *) S, (size_t) num_globals);
 	S->vm.pc = entry_point;
+	// machine code compiled from earlier code is stale.
+	if (S->vm.code != bc) jit_reset(S->vm.jit);
 	S->vm.code = bc;
+	vm_load_constants((struct VM *) S);
 
 	return vm_run((struct VM *) S);  // TODO: error handling for runtime errors.
 }
@@ -97,9 +170,10 @@ int YASL_execute(struct YASL_State *S) {
 
 int YASL_declglobal(struct YASL_State *S, char *name) {
     int64_t index = env_decl_var(S->compiler.globals, name, strlen(name));
-    if (index > 255) {
+    if (index > MAX_VARS) {
         return YASL_TOO_MANY_VAR_ERROR;
     }
+    vm_grow_globals((struct VM *) S, (size_t) index);
     return YASL_SUCCESS;
 }
 
@@ -115,10 +189,6 @@ int YASL_setglobal(struct YASL_State *S, char *name) {
     int64_t index = env_get(S->compiler.globals, name, strlen(name));
     if (is_const(index)) return YASL_ERROR;
 
-    // int64_t num_globals = S->compiler.globals->vars->count;
-
-    // S->vm.globals = realloc(S->vm.globals, num_globals * sizeof(YASL_Object));
-
     dec_ref(S->vm.globals + index);
     S->vm.globals[index] = vm_pop((struct VM *)S);
     inc_ref(S->vm.globals + index);
@@ -174,6 +244,8 @@ int YASL_pushcfunction(struct YASL_State *S, int (*value)(struct YASL_State *),
 
 int YASL_pushobject(struct YASL_State *S, struct YASL_Object *obj) {
     if (!obj) return YASL_ERROR;
+    // lists and tables made through the API belong to the first state they are pushed onto.
+    if (YASL_ISLIST(*obj) || YASL_ISTABLE(*obj)) gc_adopt(&S->vm.gc, YASL_GETUSERDATA(*obj));
     vm_push((struct VM *)S, *obj);
     free(obj);
     return YASL_SUCCESS;
@@ -187,7 +259,7 @@ int YASL_Table_set(struct YASL_Object *table, struct YASL_Object *key, struct YA
     if (!table || !key || !value) return YASL_ERROR;
 
     // TODO: fix this to YASL_isTable(table)
-    if (table->type != Y_TABLE)
+    if (YASL_GETTYPE(*table) != Y_TABLE)
         return YASL_ERROR;
     table_insert(YASL_GETTABLE(*table), *key, *value);
 
@@ -195,11 +267,11 @@ int YASL_Table_set(struct YASL_Object *table, struct YASL_Object *key, struct YA
 }
 
 int YASL_UserData_gettag(struct YASL_Object *obj) {
-    return obj->value.uval->tag;
+    return YASL_GETUSERDATA(*obj)->tag;
 }
 
 void *YASL_UserData_getdata(struct YASL_Object *obj) {
-    return obj->value.uval->data;
+    return YASL_GETUSERDATA(*obj)->data;
 }
 
 struct YASL_Object *YASL_LiteralString(char *str) {
@@ -213,34 +285,34 @@ struct YASL_Object *YASL_CString(char *str) {
 
 
 int YASL_isundef(struct YASL_Object *obj) {
-    return obj->type != Y_UNDEF;
+    return YASL_GETTYPE(*obj) != Y_UNDEF;
 }
 
 
 int YASL_isboolean(struct YASL_Object *obj) {
-    return obj->type != Y_BOOL;
+    return YASL_GETTYPE(*obj) != Y_BOOL;
 }
 
 
 int YASL_isdouble(struct YASL_Object *obj) {
-    return obj->type != Y_FLOAT;
+    return YASL_GETTYPE(*obj) != Y_FLOAT;
 }
 
 
 int YASL_isinteger(struct YASL_Object *obj) {
-    return obj->type != Y_INT;
+    return YASL_GETTYPE(*obj) != Y_INT;
 }
 
 int YASL_isstring(struct YASL_Object *obj) {
-    return obj->type != Y_STR && obj->type != Y_STR_W;
+    return YASL_GETTYPE(*obj) != Y_STR && YASL_GETTYPE(*obj) != Y_STR_W;
 }
 
 int YASL_islist(struct YASL_Object *obj) {
-    return obj->type != Y_LIST && obj->type != Y_LIST_W;
+    return YASL_GETTYPE(*obj) != Y_LIST && YASL_GETTYPE(*obj) != Y_LIST_W;
 }
 
 int YASL_istable(struct YASL_Object *obj) {
-    return obj->type != Y_TABLE && obj->type != Y_TABLE_W;
+    return YASL_GETTYPE(*obj) != Y_TABLE && YASL_GETTYPE(*obj) != Y_TABLE_W;
 }
 
 int YASL_isfunction(struct YASL_Object *obj);
@@ -250,7 +322,7 @@ int YASL_iscfunction(struct YASL_Object *obj);
 
 
 int YASL_isuserdata(struct YASL_Object *obj, int tag) {
-    if (YASL_ISUSERDATA(*obj) && obj->value.uval->tag == tag) {
+    if (YASL_ISUSERDATA(*obj) && YASL_GETUSERDATA(*obj)->tag == tag) {
         return YASL_SUCCESS;
     }
     return YASL_ERROR;
@@ -272,10 +344,10 @@ int64_t YASL_getinteger(struct YASL_Object *obj);
 char *YASL_getcstring(struct YASL_Object *obj) {
     if (YASL_isstring(obj) != YASL_SUCCESS) return NULL;
 
-    char *tmp = malloc(yasl_string_len(obj->value.sval) + 1);
+    char *tmp = malloc(yasl_string_len(YASL_GETSTR(*obj)) + 1);
 
-    memcpy(tmp, obj->value.sval->str + obj->value.sval->start, yasl_string_len(obj->value.sval));
-    tmp[yasl_string_len(obj->value.sval)] = '\0';
+    memcpy(tmp, YASL_GETSTR(*obj)->str + YASL_GETSTR(*obj)->start, yasl_string_len(YASL_GETSTR(*obj)));
+    tmp[yasl_string_len(YASL_GETSTR(*obj))] = '\0';
 
     return tmp;
 }
@@ -288,8 +360,8 @@ char *YASL_getstring(struct YASL_Object *obj);
 
 
 void *YASL_getuserdata(struct YASL_Object *obj) {
-    if (obj->type == Y_USERDATA || obj->type == Y_USERDATA_W) {
-        return obj->value.uval->data;
+    if (YASL_GETTYPE(*obj) == Y_USERDATA || YASL_GETTYPE(*obj) == Y_USERDATA_W) {
+        return YASL_GETUSERDATA(*obj)->data;
     }
     return NULL;
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "yasl_error.h"
+#include "yasl_options.h"
 #include "inttypes.h"
 #include <stdlib.h>
 
@@ -14,6 +15,13 @@ struct YASL_Object;
 struct YASL_State *YASL_newstate(char *filename);
 struct YASL_State *YASL_newstate_bb(char *buf, int len);
 
+/**
+ * initialises a new YASL_State that runs the bytecode file at filename, as written by YASL_compile_to_file, without
+ * compiling anything. The globals the code uses must be declared in the same order as they were when it was compiled.
+ * @return the new YASL_State, or NULL if the file cannot be read or is not a valid bytecode file for this version.
+ */
+struct YASL_State *YASL_newstate_bytecode(char *filename);
+
 void YASL_resetstate_bb(struct YASL_State *S, char *buf, size_t len);
 
 /**
@@ -23,6 +31,15 @@ void YASL_resetstate_bb(struct YASL_State *S, char *buf, size_t len);
  */
 int YASL_delstate(struct YASL_State *S);
 
+/**
+ * Enables or disables a compiler option for the given YASL_State. Only affects code compiled afterwards.
+ * @param S the YASL_State whose compiler to configure.
+ * @param option the YASL_Option to set.
+ * @param enabled whether the option should be enabled.
+ * @return 0 on success, else an error code.
+ */
+int YASL_setoption(struct YASL_State *S, enum YASL_Option option, int enabled);
+
 /**
  * Execute the bytecode for the given YASL_State.
  * @param S the YASL_State to use to execute the bytecode.
@@ -31,6 +48,14 @@ int YASL_delstate(struct YASL_State *S);
 int YASL_execute(struct YASL_State *S);
 int YASL_execute_REPL(struct YASL_State *S);
 
+/**
+ * Compiles the source of the given YASL_State and writes the bytecode to a file, instead of executing it.
+ * @param S the YASL_State whose source to compile.
+ * @param filename the name of the bytecode file to write.
+ * @return 0 on success, else an error code.
+ */
+int YASL_compile_to_file(struct YASL_State *S, char *filename);
+
 /**
  * Declares a global for use in the given YASL_State.
  * @param S the YASL_State in which to declare the global.
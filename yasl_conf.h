@@ -7,3 +7,47 @@
 
 // Which integral type YASL will use.
 #define yasl_int int64_t
+
+// Whether the VM dispatches opcodes through a table of label addresses instead of a switch.
+// Only available with compilers that support labels as values (GCC and Clang).
+#ifndef YASL_COMPUTED_GOTO
+#if defined(__GNUC__)
+#define YASL_COMPUTED_GOTO 1
+#else
+#define YASL_COMPUTED_GOTO 0
+#endif
+#endif
+
+// Whether tables use the open-addressing engine in hashtable/swisstable.c (power-of-two capacity, control bytes and
+// group probing) instead of the prime-sized, double-hashing engine in hashtable/hashtable.c.
+#ifndef YASL_SWISS_TABLE
+#define YASL_SWISS_TABLE 1
+#endif
+
+// Whether YASL_Object is NaN-boxed into 8 bytes instead of a 16-byte type and union. See interpreter/YASL_Object.h.
+#ifndef YASL_NAN_BOXING
+#define YASL_NAN_BOXING 0
+#endif
+
+// Whether functions are compiled to machine code on their first call. See interpreter/jit.h. Only available on x86-64
+// Linux, and not with NaN-boxing, since the generated code depends on the layout of YASL_Object.
+#ifndef YASL_JIT
+#if defined(__x86_64__) && defined(__linux__) && !YASL_NAN_BOXING
+#define YASL_JIT 1
+#else
+#define YASL_JIT 0
+#endif
+#endif
+
+// Whether the headers of strings, lists, tables, userdata and C functions come from the size-class allocator in
+// slab/slab.c instead of straight from malloc. Turn off for sanitizer runs.
+#ifndef YASL_SLAB_ALLOC
+#define YASL_SLAB_ALLOC 1
+#endif
+
+// Storage class of variables that each thread has its own copy of.
+#if defined(_MSC_VER)
+#define YASL_THREAD_LOCAL __declspec(thread)
+#else
+#define YASL_THREAD_LOCAL __thread
+#endif
@@ -11,5 +11,6 @@ enum YASL_Error {
 	YASL_SYNTAX_ERROR,         // Syntax error during compilation.
 	YASL_TYPE_ERROR,           // Type error (at runtime).
 	YASL_DIVIDE_BY_ZERO_ERROR, // Division by zero error (at runtime).
-	YASL_TOO_MANY_VAR_ERROR    // Too many variables in current scope
+	YASL_TOO_MANY_VAR_ERROR,   // Too many variables in current scope
+	YASL_BYTECODE_ERROR        // Invalid, corrupted or incompatible bytecode file.
 };
@@ -0,0 +1,16 @@
+#pragma once
+
+/*
+ * Compiler and VM options. These are flags, and can be combined.
+ */
+
+enum YASL_Option {
+	YASL_OPT_REGISTERS         = 0x01, // Use register instructions for simple assignments and loop conditions.
+	YASL_OPT_PEEPHOLE          = 0x02, // Rewrite common instruction sequences and remove unreachable code.
+	YASL_OPT_SUPERINSTRUCTIONS = 0x04, // Use fused instructions for increments, sums of variables and comparisons.
+	YASL_OPT_JIT               = 0x08, // Compile functions to machine code, where YASL_JIT is available.
+	YASL_OPT_CONSTANTS         = 0x10, // Use the values of constants bound to literals, and drop branches they decide.
+	YASL_OPT_INLINE            = 0x20, // Inline calls to small constant functions whose body only returns an expression.
+	YASL_OPT_DEFAULT           = YASL_OPT_PEEPHOLE | YASL_OPT_SUPERINSTRUCTIONS | YASL_OPT_JIT | YASL_OPT_CONSTANTS |
+	                             YASL_OPT_INLINE  // Options that are on by default.
+};
@@ -1,10 +1,12 @@
 #pragma once
 
 #include "compiler/compiler.h"
+#include "compiler/bytecode_file.h"
 #include "interpreter/VM.h"
 
 // VM MUST BE FIRST ITEM IN YASL_State SO THAT FUNCTIONS CAN RUN PROPERLY
 struct YASL_State {
     struct VM vm;
     struct Compiler compiler;
+    struct BytecodeFile file;      // bytecode file the code was loaded from, unused if file.mapping is NULL
 };